@@ -0,0 +1,83 @@
+#ifndef BINARY_FUSE_FILTER_H
+#define BINARY_FUSE_FILTER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>  // For uint8_t, uint32_t, uint64_t
+#include <cstddef>  // For size_t
+
+#include "utils/hashing.h" // For HashUtils::mix64
+
+// Static binary fuse filter with 8-bit fingerprints (Graf & Lemire, "Binary
+// Fuse Filters: Fast and Smaller Than Xor Filters", 2022).
+//
+// Built once from a complete key set and immutable afterwards; rebuild it when
+// the set changes (e.g. whenever the rule set is recompiled). Each key maps to
+// three cells in three consecutive segments of a fingerprint array, filled so
+// that the XOR of a key's three cells equals its fingerprint. A query is one
+// hash and exactly three byte loads, with no per-hash loop.
+//
+// About 9 bits per key (1.125x keys cells for large sets, more for small ones)
+// at a false-positive rate of 1/256 (~0.4%), versus ~10 bits per key for a
+// 1%-FPR Bloom filter. Keys are 64-bit; use keyOf() to hash other data.
+class BinaryFuseFilter {
+public:
+    // Attempts with different seeds before build() gives up.
+    static constexpr int kMaxBuildAttempts = 100;
+
+    // Empty filter: contains nothing.
+    BinaryFuseFilter();
+    explicit BinaryFuseFilter(const std::vector<uint64_t>& keys);
+
+    // Replaces the contents with exactly 'keys' (duplicates are allowed).
+    // Returns false (and leaves the filter empty) if no seed produced a valid
+    // filter, which for distinct keys is vanishingly unlikely.
+    bool build(const std::vector<uint64_t>& keys);
+
+    bool possiblyContains(uint64_t key) const {
+        if (fingerprints_.empty()) {
+            return false;
+        }
+        uint64_t hash = HashUtils::mix64(key + seed_);
+        uint32_t h0, h1, h2;
+        cells(hash, h0, h1, h2);
+        return static_cast<uint8_t>(fingerprint(hash) ^ fingerprints_[h0] ^ fingerprints_[h1] ^ fingerprints_[h2]) == 0;
+    }
+    bool possiblyContains(const std::string& item) const { return possiblyContains(keyOf(item)); }
+
+    // 64-bit key for arbitrary data.
+    static uint64_t keyOf(const unsigned char* data, size_t len);
+    static uint64_t keyOf(const std::string& item);
+
+    // --- Utility ---
+    size_t size() const { return key_count_; } // Distinct keys in the filter
+    size_t getArrayLength() const { return fingerprints_.size(); }
+    size_t getMemoryUsage() const { return fingerprints_.size() * sizeof(uint8_t); }
+    double getBitsPerKey() const { return key_count_ == 0 ? 0.0 : 8.0 * fingerprints_.size() / key_count_; }
+    static double getFalsePositiveProbability() { return 1.0 / 256.0; }
+
+private:
+    std::vector<uint8_t> fingerprints_;
+    uint64_t seed_;
+    uint32_t segment_length_;
+    uint32_t segment_length_mask_;
+    uint32_t segment_count_length_; // segment_count * segment_length: range of the first cell
+    size_t key_count_;
+
+    static uint8_t fingerprint(uint64_t hash) { return static_cast<uint8_t>(hash ^ (hash >> 32)); }
+
+    // The key's three cells: one per consecutive segment, starting at a
+    // segment chosen by the hash's high bits.
+    void cells(uint64_t hash, uint32_t& h0, uint32_t& h1, uint32_t& h2) const {
+        h0 = static_cast<uint32_t>((static_cast<unsigned __int128>(hash) * segment_count_length_) >> 64);
+        h1 = h0 + segment_length_;
+        h2 = h1 + segment_length_;
+        h1 ^= static_cast<uint32_t>(hash >> 18) & segment_length_mask_;
+        h2 ^= static_cast<uint32_t>(hash) & segment_length_mask_;
+    }
+
+    void allocate(size_t key_count);
+    bool populate(const std::vector<uint64_t>& keys); // One attempt with seed_
+};
+
+#endif // BINARY_FUSE_FILTER_H
@@ -6,20 +6,34 @@
 #include <functional> // For std::hash and potentially other hash functions
 #include <cmath>      // For log, pow
 #include <cstdint>    // For uint64_t
+#include <cstddef>    // For size_t
 
 // For hashing arbitrary data, we might need a way to get bytes
 // For simplicity, operations will take const unsigned char* and size.
 // Or, we can rely on std::string and std::hash specialization.
 
+// Blocked Bloom filter: every item maps to one 64-byte (cache-line) block and
+// all k of its bits are set within that block, so a query touches a single
+// cache line instead of k scattered ones. The block is held as 8 aligned
+// uint64_t words; a query builds the item's 512-bit mask on the stack and
+// checks it against the block with a masked compare, without allocating.
+//
+// Blocking costs a little accuracy against an unblocked filter of the same
+// size (items are not spread perfectly evenly over blocks), which
+// getEffectiveFalsePositiveProbability() accounts for. Filters smaller than a
+// block use a single block of exactly 'size' bits.
 class BloomFilter {
 public:
+    static constexpr size_t kWordsPerBlock = 8;                 // 8 x 64 bits = one cache line
+    static constexpr uint64_t kBlockBits = kWordsPerBlock * 64;
+
     // Constructor:
     // num_items: Expected number of items to be inserted.
     // false_positive_prob: Desired false positive probability.
     BloomFilter(uint64_t num_items, double false_positive_prob);
 
     // Constructor allowing manual specification of size and hash functions
-    // size: Size of the bit array.
+    // size: Size of the bit array (rounded up to whole blocks for storage).
     // num_hashes: Number of hash functions to use.
     BloomFilter(uint64_t size, int num_hashes);
 
@@ -36,33 +50,78 @@ public:
     bool possiblyContains(const std::string& item) const;
     bool possiblyContains(const unsigned char* data, size_t len) const;
 
+    // --- 64-bit integer keys (packet fields, precomputed flow hashes) ---
+    // Hashed with HashUtils::mix64 rather than wyhash so the batch query can
+    // hash in SIMD lanes. Integer keys and byte-string items are separate key
+    // spaces: query a key only with the *Key / Batch functions.
+    void insertKey(uint64_t key);
+    bool possiblyContainsKey(uint64_t key) const;
+
+    // Queries n keys at once. Bit i of out_bitmap (word i / 64, bit i % 64) is
+    // set iff possiblyContainsKey(keys[i]); out_bitmap must hold (n + 63) / 64
+    // words and is overwritten. Uses AVX-512 (16 keys per step) or AVX2 (8 keys
+    // per step) when the CPU has them, hashing and gathering every key's block
+    // words in vector registers; scalar code otherwise, for the remainder, and
+    // for filters smaller than one block.
+    void possiblyContainsBatch(const uint64_t* keys, size_t n, uint64_t* out_bitmap) const;
+
     // --- Configuration & Utility ---
-    uint64_t getSize() const { return bit_array_size; }
+    uint64_t getSize() const { return bit_array_size; } // Requested size in bits
     int getNumHashFunctions() const { return num_hash_functions; }
+    uint64_t getBlockCount() const { return blocks.size(); }
+    uint64_t getStorageBits() const { return blocks.size() * block_bits; }
     double getEffectiveFalsePositiveProbability() const; // Calculates based on current state
     uint64_t getApproximateCount() const; // Estimate number of items inserted (advanced)
 
+    // Sizing and estimation helpers shared with CountingBloomFilter.
+    static void calculateOptimalParams(uint64_t num_items, double false_positive_prob, uint64_t& out_size, int& out_num_hashes);
+    // Expected FP rate of a blocked filter with 'num_items' spread over
+    // 'num_blocks' blocks of 'block_bits' positions each, k positions per item.
+    static double blockedFalsePositiveRate(uint64_t num_items, uint64_t num_blocks, uint64_t block_bits, int k);
+
+    // Probe layout shared by every blocked filter (this one,
+    // CountingBloomFilter and ConcurrentBloomFilter). The high 32 bits of a
+    // 64-bit hash pick one of num_blocks blocks with a multiply, not a modulo.
+    static uint64_t probeBlock(uint64_t hash, uint64_t num_blocks) { return ((hash >> 32) * num_blocks) >> 32; }
+    // The low 32 bits give the k in-block positions by double hashing,
+    // pos_i = a + i * b (mod block_positions); visit(pos) is called for each.
+    // The step is odd, so in a power-of-two block the positions are distinct.
+    template <typename Visit>
+    static void forEachProbePosition(uint64_t hash, int k, uint64_t block_positions, Visit&& visit) {
+        uint32_t a = static_cast<uint32_t>(hash) & 0xFFFF;
+        uint32_t b = (static_cast<uint32_t>(hash) >> 16) | 1;
+        bool power_of_two = (block_positions & (block_positions - 1)) == 0;
+        for (int i = 0; i < k; ++i) {
+            uint32_t x = a + static_cast<uint32_t>(i) * b;
+            visit(power_of_two ? (x & static_cast<uint32_t>(block_positions - 1))
+                               : static_cast<uint32_t>(x % block_positions));
+        }
+    }
 
 private:
-    uint64_t bit_array_size; // m
+    struct alignas(64) Block {
+        uint64_t words[kWordsPerBlock];
+    };
+
+    // An item's block and its k bits within that block.
+    struct Probe {
+        uint64_t block;
+        uint64_t mask[kWordsPerBlock];
+    };
+
+    uint64_t bit_array_size; // m (as requested)
     int num_hash_functions;  // k
-    std::vector<bool> bit_array;
+    uint64_t block_bits;     // Bits used per block: kBlockBits, or m for filters smaller than a block
+    std::vector<Block> blocks;
     uint64_t current_insertions; // n (actual number of items inserted)
 
-    // Helper to calculate optimal size and hash functions
-    static void calculateOptimalParams(uint64_t num_items, double false_positive_prob, uint64_t& out_size, int& out_num_hashes);
-
-    // Multiple hash functions.
-    // These will produce k hash values for a given item.
-    // Each hash value should be in the range [0, bit_array_size - 1].
-    std::vector<uint64_t> hash(const unsigned char* data, size_t len) const;
+    void allocateBlocks();
 
-    // Example internal hash functions (could use well-known non-cryptographic hashes like Murmur3, xxHash)
-    // For this skeleton, we can use combinations of std::hash or simple custom ones.
-    // It's crucial these are independent and uniformly distributed.
+    // Single 64-bit base hash (wyhash, see utils/hashing.h). The high half picks
+    // the block; the low half seeds the k in-block positions.
     uint64_t hashFunction1(const unsigned char* data, size_t len) const;
-    uint64_t hashFunction2(const unsigned char* data, size_t len) const;
-    // ... more hash functions up to num_hash_functions
+    void makeProbe(uint64_t hash, Probe& probe) const;
+    bool containsHash(uint64_t hash) const;
 };
 
 #endif // BLOOM_FILTER_H
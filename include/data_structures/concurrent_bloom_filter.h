@@ -0,0 +1,94 @@
+#ifndef CONCURRENT_BLOOM_FILTER_H
+#define CONCURRENT_BLOOM_FILTER_H
+
+#include <atomic>
+#include <memory>     // For std::unique_ptr
+#include <string>
+#include <cstdint>    // For uint64_t
+#include <cstddef>    // For size_t
+
+// Thread-safe Bloom filter for filters shared by several writer threads (e.g.
+// a "seen-flow" filter updated by every data-plane thread).
+//
+// Same blocked layout and hashing as BloomFilter, but each block word is a
+// std::atomic<uint64_t>: insert() sets an item's bits with one fetch_or per
+// word that is missing any of them, so concurrent inserts never lose bits and
+// never take a lock. Queries are plain relaxed loads. An item is visible to
+// other threads once its insert() has returned (and they observe it through
+// any synchronisation); a query racing with the insert may still miss it.
+//
+// Cardinality is tracked as the number of inserts that set at least one new
+// bit, i.e. items that were definitely new. Counts go to per-thread striped
+// counters (one cache line each) and are summed on read, so counting does not
+// make the writers contend. Like any Bloom-based count it undercounts by the
+// false-positive rate, and two threads inserting the same new item at the
+// same moment may both count it.
+class ConcurrentBloomFilter {
+public:
+    static constexpr size_t kWordsPerBlock = 8;
+    static constexpr uint64_t kBlockBits = kWordsPerBlock * 64;
+    static constexpr size_t kCounterStripes = 32;
+
+    // Sized like BloomFilter for the expected item count and false-positive
+    // probability.
+    ConcurrentBloomFilter(uint64_t num_items, double false_positive_prob);
+    // size: number of bits (rounded up to whole blocks). num_hashes: k.
+    ConcurrentBloomFilter(uint64_t size, int num_hashes);
+
+    ConcurrentBloomFilter(const ConcurrentBloomFilter&) = delete;
+    ConcurrentBloomFilter& operator=(const ConcurrentBloomFilter&) = delete;
+
+    // Returns true if the item was definitely not present before this call.
+    bool insert(const std::string& item);
+    bool insert(const unsigned char* data, size_t len);
+
+    bool possiblyContains(const std::string& item) const;
+    bool possiblyContains(const unsigned char* data, size_t len) const;
+
+    // Pre-hashed 64-bit keys, mixed as in BloomFilter::insertKey(). Same
+    // separation rule: query a key only with possiblyContainsKey().
+    bool insertKey(uint64_t key);
+    bool possiblyContainsKey(uint64_t key) const;
+
+    // Clears every bit and counter. Inserts running concurrently may survive
+    // partially (some of their bits set); callers that need a clean reset
+    // quiesce writers first.
+    void clear();
+
+    // --- Configuration & Utility ---
+    uint64_t getSize() const { return num_bits_; } // Requested number of bits
+    int getNumHashFunctions() const { return num_hash_functions_; }
+    uint64_t getBlockCount() const { return num_blocks_; }
+    uint64_t getApproximateCount() const; // Sum of the per-thread counters
+    double getEffectiveFalsePositiveProbability() const;
+
+private:
+    struct alignas(64) Block {
+        std::atomic<uint64_t> words[kWordsPerBlock];
+    };
+
+    struct alignas(64) PaddedCounter {
+        std::atomic<uint64_t> value{0};
+    };
+
+    // An item's block and its k bits within that block.
+    struct Probe {
+        uint64_t block;
+        uint64_t mask[kWordsPerBlock];
+    };
+
+    uint64_t num_bits_;
+    int num_hash_functions_;
+    uint64_t block_bits_; // Bits used per block: kBlockBits, or m for filters smaller than a block
+    uint64_t num_blocks_;
+    std::unique_ptr<Block[]> blocks_;
+    PaddedCounter counters_[kCounterStripes];
+
+    void allocateBlocks();
+    void makeProbe(uint64_t hash, Probe& probe) const;
+    bool insertHash(uint64_t hash);
+    bool containsHash(uint64_t hash) const;
+    static size_t threadStripe();
+};
+
+#endif // CONCURRENT_BLOOM_FILTER_H
@@ -3,104 +3,595 @@
 
 #include <string>
 #include <vector>
-#include <atomic>   // For std::atomic for lock-free operations
-#include <memory>   // For std::unique_ptr / std::shared_ptr if needed for RCU
+#include <atomic>       // For std::atomic
+#include <memory>       // For std::unique_ptr
+#include <mutex>        // For the writer mutex
+#include <functional>   // For std::hash
+#include <type_traits>  // For std::is_trivially_copyable, std::void_t
+#include <utility>      // For std::declval, std::swap
+#include <algorithm>    // For std::min
+#include <cstdint>      // For uint32_t, uint64_t
+#include <cstddef>      // For size_t
+#include <iostream>     // For diagnostics
 
-// Define a structure for table entries if needed, e.g., key-value pair.
-// For MAC/IP addresses, the key could be a string or a more specialized type.
-struct TableEntry {
-    std::string key;
-    int value; // Example: interface_id or similar mapping
-    std::atomic<bool> in_use; // For Robin Hood hashing or general slot status
-    // Potentially other fields for Robin Hood hashing (e.g., probe distance)
-
-    TableEntry() : key(""), value(-1), in_use(false) {} // Initialize atomic
-
-    TableEntry(std::string k, int v) : key(std::move(k)), value(v), in_use(true) {} // Initialize atomic
-
-    // Explicit Copy Constructor
-    TableEntry(const TableEntry& other) : 
-        key(other.key), 
-        value(other.value), 
-        in_use(other.in_use.load(std::memory_order_relaxed)) // Copy value of atomic
-    {}
-
-    // Explicit Copy Assignment Operator
-    TableEntry& operator=(const TableEntry& other) {
-        if (this == &other) {
-            return *this;
-        }
-        key = other.key;
-        value = other.value;
-        in_use.store(other.in_use.load(std::memory_order_relaxed), std::memory_order_relaxed); // Assign value of atomic
-        return *this;
-    }
-
-    // Move Constructor
-    TableEntry(TableEntry&& other) noexcept :
-        key(std::move(other.key)),
-        value(other.value), 
-        in_use(other.in_use.load(std::memory_order_relaxed)) 
-    {
-        // Optional: other.in_use.store(false, std::memory_order_relaxed);
+#include "utils/threading.h" // For SeqLock, RcuUtils
+#include "utils/hashing.h"   // For HashUtils::wyhash
+
+// --- Default key hashing ---
+// Strings and fixed-size binary keys (5-tuples, MAC addresses, masked tuples)
+// are hashed with wyhash directly over their bytes, so binary keys must not
+// contain padding. Other keys with a std::hash specialisation (integers) use it;
+// the tables mix weak hashes before use.
+template <typename Key, typename = void>
+struct DefaultKeyHash {
+    static_assert(std::is_trivially_copyable<Key>::value,
+                  "Keys without std::hash must be trivially copyable");
+    static_assert(std::has_unique_object_representations<Key>::value,
+                  "Binary keys must not contain padding bytes (use a packed layout)");
+
+    size_t operator()(const Key& key) const {
+        return static_cast<size_t>(HashUtils::wyhash(&key, sizeof(Key)));
     }
+};
 
-    // Move Assignment Operator
-    TableEntry& operator=(TableEntry&& other) noexcept {
-        if (this == &other) {
-            return *this;
-        }
-        key = std::move(other.key);
-        value = other.value;
-        in_use.store(other.in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
-        // Optional: other.in_use.store(false, std::memory_order_relaxed);
-        return *this;
+template <typename Key>
+struct DefaultKeyHash<Key, std::void_t<decltype(std::hash<Key>{}(std::declval<const Key&>()))>>
+    : std::hash<Key> {};
+
+template <>
+struct DefaultKeyHash<std::string, void> {
+    size_t operator()(const std::string& key) const {
+        return static_cast<size_t>(HashUtils::wyhash(key.data(), key.size()));
     }
 };
 
+// A single slot of the table. Keys and values are stored inline in one flat
+// array, so trivially-copyable keys need no per-entry heap allocation.
+template <typename Key, typename Value>
+struct TableEntry {
+    Key key{};
+    Value value{};
+    // Robin Hood probe sequence length: 0 marks an empty slot, otherwise the
+    // distance from the key's home slot plus one.
+    uint32_t probe_distance = 0;
+
+    bool isEmpty() const { return probe_distance == 0; }
+};
+
+// Open-addressing hash table for exact-match lookups (MAC/IP, 5-tuples, flows).
+// Key must be equality-comparable; Hash defaults to DefaultKeyHash<Key>.
+// The defaults keep the original string -> int mapping available as ConcurrentHashTable<>.
+//
+// Collision resolution is Robin Hood hashing: an inserted key displaces any
+// resident that sits closer to its own home slot, which keeps probe lengths
+// short and nearly uniform even at a 90% load factor. Because residents are
+// ordered by probe distance, a lookup stops as soon as it meets a slot that is
+// "richer" than the probe so far, and deletion shifts the following cluster back
+// by one instead of leaving tombstones.
+//
+// Concurrency: writers are serialised by a mutex. When Key and Value are
+// trivially copyable, readers are lock-free and validate against a SeqLock that
+// writers bump around every modification, retrying if a write raced with them.
+// Other key types (e.g. std::string) read under the writer mutex instead.
+//
+// Online resize: the slot array is published through an atomic pointer. Crossing
+// kMaxLoadFactor allocates a table twice the size and publishes it alongside the
+// old one, which is then frozen. Each subsequent write migrates a few old slots
+// (kMigrationBatch) into the new table, so no single operation pays for a full
+// rehash. Until migration finishes, readers probe the new table and then the old
+// one; migrated or overwritten old entries are marked retired rather than
+// removed, so the old table's probe chains stay intact. The drained array is
+// reclaimed after a grace period via RcuUtils::callRcu.
+template <typename Key = std::string, typename Value = int, typename Hash = DefaultKeyHash<Key>>
 class ConcurrentHashTable {
 public:
-    ConcurrentHashTable(size_t initial_size = 1024); // Default size
+    using key_type = Key;
+    using mapped_type = Value;
+    using Entry = TableEntry<Key, Value>;
+
+    // Load factor at which the table starts growing.
+    static constexpr double kMaxLoadFactor = 0.9;
+    // Old slots migrated per write while a resize is in progress.
+    static constexpr size_t kMigrationBatch = 16;
+    // lookupBatch works through its input in chunks of this many keys.
+    static constexpr size_t kLookupBatchChunk = 64;
+
+    explicit ConcurrentHashTable(size_t initial_size = 1024); // Default size
     ~ConcurrentHashTable();
 
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
     // --- Core Functionality ---
-    // Lock-free read operation
-    bool lookup(const std::string& key, int& value) const;
+    // Lock-free read operation (see class comment)
+    bool lookup(const Key& key, Value& value) const;
 
-    // Update operation (potentially using RCU)
-    void insert(const std::string& key, int value);
+    // Looks up n keys at once: all keys are hashed first, every target slot is
+    // prefetched, and only then are the probes resolved, so the cache misses of
+    // a burst overlap instead of being paid one after another. found[i] reports
+    // whether keys[i] is present; out[i] is only meaningful when it is.
+    void lookupBatch(const Key* keys, Value* out, bool* found, size_t n) const;
 
-    // Remove operation (potentially using RCU)
-    bool remove(const std::string& key);
+    // Inserts or updates. Writers are serialised by write_mutex_.
+    void insert(const Key& key, const Value& value);
 
-    // --- RCU (Read-Copy Update) specific methods (placeholders) ---
-    // These would be more complex and involve managing old versions of data
-    // or the table structure itself.
-    void performRcuUpdate(const std::string& key, int value, bool is_insert);
-    void synchronizeRcu(); // Waits for all readers to finish with old data
+    // Removes with backward-shift deletion.
+    bool remove(const Key& key);
 
-    // --- Robin Hood Hashing specific methods (placeholders) ---
-    // These would be part of the insert/remove/lookup logic.
-    size_t robinHoodProbe(const std::string& key, size_t initial_hash_index, bool& found_empty_slot);
-    void resolveRobinHoodCollision(TableEntry& new_entry, size_t& current_index);
+    // --- Bulk operations ---
+    // Apply n operations under a single acquisition of the writer mutex.
+    void insertBatch(const Key* keys, const Value* values, size_t n);
+    size_t removeBatch(const Key* keys, size_t n); // Returns the number of keys removed
+
+    // --- RCU (Read-Copy Update) specific methods ---
+    void performRcuUpdate(const Key& key, const Value& value, bool is_insert);
+    void synchronizeRcu(); // Waits for readers of replaced tables, then reclaims them
 
     // --- Utility ---
-    size_t hashFunction(const std::string& key) const;
-    void resize(size_t new_size); // For dynamic resizing
+    size_t hashFunction(const Key& key) const;
+    // Starts an online migration to new_size slots (completing any migration
+    // already in progress first). Safe to call with concurrent readers.
+    void resize(size_t new_size);
+
+    size_t size() const { return current_size.load(std::memory_order_relaxed); }
+    size_t getCapacity() const { return table_.load(std::memory_order_acquire)->capacity; }
+    double getLoadFactor() const { return static_cast<double>(size()) / getCapacity(); }
+    // Longest probe sequence currently in the table (1 = every key in its home slot).
+    size_t getMaxProbeDistance() const;
+    // True while entries are still being migrated out of a previous table.
+    bool isResizing() const { return old_table_.load(std::memory_order_acquire) != nullptr; }
 
 private:
-    std::vector<TableEntry> table;
-    std::atomic<size_t> current_size; // Number of elements in the table
-    size_t capacity; // Total capacity of the table
-
-    // For RCU, you might need pointers to different versions of the table
-    // or more sophisticated mechanisms.
-    // std::atomic<TableEntry*> rcu_table_ptr; 
-
-    // Mutex or other synchronization primitives might be needed for writers,
-    // even with RCU, depending on the RCU implementation strategy.
-    // For truly lock-free reads, writers must coordinate carefully.
-    // std::mutex write_mutex; // Example, might not be ideal for pure RCU
+    static constexpr bool kOptimisticReads =
+        std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value;
+
+    // One generation of the slot array.
+    struct SlotArray {
+        size_t capacity;
+        std::unique_ptr<Entry[]> slots; // Flat slot array, keys stored inline
+        // Allocated when this array is being drained: marks entries that have
+        // been migrated, overwritten or removed since the resize started.
+        std::unique_ptr<bool[]> retired;
+
+        explicit SlotArray(size_t cap) : capacity(cap), slots(new Entry[cap]) {}
+    };
+
+    std::atomic<SlotArray*> table_;     // Current table; all inserts go here
+    std::atomic<SlotArray*> old_table_; // Table being drained, nullptr when not resizing
+    size_t migrate_cursor_;             // Next old slot to migrate (write_mutex_ held)
+    std::atomic<size_t> current_size;   // Number of elements in the table
+    Hash hasher_;
+
+    // Writers are serialised; optimistic readers never take this lock.
+    mutable std::mutex write_mutex_;
+    SeqLock seq_lock_;
+
+    // Maps a hash onto [0, capacity). The multiply scrambles weak hashes
+    // (std::hash of integers is the identity) before the high bits are used.
+    static size_t homeSlot(size_t hash, size_t capacity) {
+        uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>((static_cast<unsigned __int128>(mixed) * capacity) >> 64);
+    }
+    static size_t nextSlot(size_t index, size_t capacity) { return index + 1 == capacity ? 0 : index + 1; }
+
+    // --- Robin Hood Hashing helpers (write_mutex_ held) ---
+    // Walks the probe sequence of 'key'. Returns the slot holding the key
+    // (found_key = true), or the slot where the key would be placed: either an
+    // empty slot (found_empty_slot = true) or a richer resident to displace.
+    size_t robinHoodProbe(const SlotArray& t, const Key& key, size_t initial_hash_index,
+                          uint32_t& probe_distance, bool& found_key, bool& found_empty_slot) const;
+    // Places new_entry at current_index, pushing displaced residents further
+    // along until one lands in an empty slot.
+    static void resolveRobinHoodCollision(SlotArray& t, Entry& new_entry, size_t current_index);
+
+    // Returns the slot holding key, or t.capacity. With skip_retired, retired
+    // entries of a draining table are stepped over but still bound the probe.
+    size_t findIndex(const SlotArray& t, const Key& key, size_t hash, bool skip_retired) const;
+    // Lookup body shared by the optimistic and locked read paths.
+    bool findEntry(const Key& key, size_t hash, Value& value) const;
+    // Prefetch + probe passes of lookupBatch over one chunk of pre-hashed keys.
+    void resolveBatch(const Key* keys, const size_t* hashes, Value* out, bool* found, size_t n) const;
+
+    void insertLocked(const Key& key, const Value& value);
+    bool removeLocked(const Key& key);
+    void resizeLocked(size_t new_capacity);
+    // Migrates up to 'budget' old slots; frees the old table once drained.
+    void migrateLocked(size_t budget);
+    // Retires key's live entry in the draining table, if any.
+    bool retireOldEntryLocked(const Key& key, size_t hash);
+    static void releaseSlotArray(SlotArray* t);
 };
 
+// ============================================================================
+// Template implementation
+// ============================================================================
+
+// --- Constructor & Destructor ---
+template <typename Key, typename Value, typename Hash>
+ConcurrentHashTable<Key, Value, Hash>::ConcurrentHashTable(size_t initial_size)
+    : old_table_(nullptr), migrate_cursor_(0), current_size(0) {
+    if (initial_size == 0) {
+        // Default to a reasonable size if 0 is passed
+        initial_size = 1024;
+    }
+    table_.store(new SlotArray(initial_size), std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Hash>
+ConcurrentHashTable<Key, Value, Hash>::~ConcurrentHashTable() {
+    delete old_table_.load(std::memory_order_relaxed);
+    delete table_.load(std::memory_order_relaxed);
+}
+
+// --- Core Functionality ---
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashTable<Key, Value, Hash>::findIndex(const SlotArray& t, const Key& key, size_t hash,
+                                                        bool skip_retired) const {
+    size_t index = homeSlot(hash, t.capacity);
+    for (uint32_t dist = 1; dist <= t.capacity; ++dist) {
+        const Entry& entry = t.slots[index];
+        // Empty slot, or a resident closer to its home than we are to ours:
+        // Robin Hood ordering guarantees the key is not further along.
+        if (entry.probe_distance < dist) {
+            return t.capacity;
+        }
+        if (entry.probe_distance == dist && !(skip_retired && t.retired[index]) && entry.key == key) {
+            return index;
+        }
+        index = nextSlot(index, t.capacity);
+    }
+    return t.capacity;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashTable<Key, Value, Hash>::findEntry(const Key& key, size_t hash, Value& value) const {
+    const SlotArray* current = table_.load(std::memory_order_acquire);
+    size_t index = findIndex(*current, key, hash, false);
+    if (index != current->capacity) {
+        value = current->slots[index].value;
+        return true;
+    }
+    // Keys not yet migrated are still live in the draining table.
+    const SlotArray* old = old_table_.load(std::memory_order_acquire);
+    if (old) {
+        index = findIndex(*old, key, hash, true);
+        if (index != old->capacity) {
+            value = old->slots[index].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashTable<Key, Value, Hash>::lookup(const Key& key, Value& value) const {
+    size_t hash = hashFunction(key);
+
+    if constexpr (kOptimisticReads) {
+        Value candidate{};
+        bool found;
+        uint64_t seq;
+        RcuUtils::rcuReadLock(); // Keeps a concurrently replaced table alive
+        do {
+            seq = seq_lock_.readBegin();
+            found = findEntry(key, hash, candidate);
+        } while (seq_lock_.readRetry(seq));
+        RcuUtils::rcuReadUnlock();
+        if (found) {
+            value = candidate;
+        }
+        return found;
+    } else {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return findEntry(key, hash, value);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::resolveBatch(const Key* keys, const size_t* hashes, Value* out,
+                                                         bool* found, size_t n) const {
+    // Pass 2: issue every prefetch before the first probe touches memory.
+    const SlotArray* current = table_.load(std::memory_order_acquire);
+    const SlotArray* old = old_table_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        __builtin_prefetch(&current->slots[homeSlot(hashes[i], current->capacity)], 0, 1);
+        if (old) {
+            __builtin_prefetch(&old->slots[homeSlot(hashes[i], old->capacity)], 0, 1);
+        }
+    }
+    // Pass 3: resolve the probes, by now mostly against cached lines.
+    for (size_t i = 0; i < n; ++i) {
+        found[i] = findEntry(keys[i], hashes[i], out[i]);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::lookupBatch(const Key* keys, Value* out, bool* found, size_t n) const {
+    size_t hashes[kLookupBatchChunk];
+    for (size_t base = 0; base < n; base += kLookupBatchChunk) {
+        size_t count = std::min(kLookupBatchChunk, n - base);
+        // Pass 1: hash every key up front so the probes below are independent.
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = hashFunction(keys[base + i]);
+        }
+
+        if constexpr (kOptimisticReads) {
+            // One SeqLock section per chunk; a racing write retries the chunk.
+            RcuUtils::rcuReadLock();
+            uint64_t seq;
+            do {
+                seq = seq_lock_.readBegin();
+                resolveBatch(keys + base, hashes, out + base, found + base, count);
+            } while (seq_lock_.readRetry(seq));
+            RcuUtils::rcuReadUnlock();
+        } else {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            resolveBatch(keys + base, hashes, out + base, found + base, count);
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::insert(const Key& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    insertLocked(key, value);
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashTable<Key, Value, Hash>::robinHoodProbe(const SlotArray& t, const Key& key,
+                                                             size_t initial_hash_index, uint32_t& probe_distance,
+                                                             bool& found_key, bool& found_empty_slot) const {
+    found_key = false;
+    found_empty_slot = false;
+    size_t index = initial_hash_index;
+    for (probe_distance = 1; probe_distance <= t.capacity; ++probe_distance) {
+        const Entry& entry = t.slots[index];
+        if (entry.isEmpty()) {
+            found_empty_slot = true;
+            return index;
+        }
+        if (entry.probe_distance < probe_distance) {
+            return index; // Richer resident: the key would be inserted here
+        }
+        if (entry.probe_distance == probe_distance && entry.key == key) {
+            found_key = true;
+            return index;
+        }
+        index = nextSlot(index, t.capacity);
+    }
+    return t.capacity; // Table full and key absent
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::resolveRobinHoodCollision(SlotArray& t, Entry& new_entry,
+                                                                      size_t current_index) {
+    for (;;) {
+        Entry& slot = t.slots[current_index];
+        if (slot.isEmpty()) {
+            slot = std::move(new_entry);
+            return;
+        }
+        if (slot.probe_distance < new_entry.probe_distance) {
+            // Take from the rich: the resident continues the probe instead.
+            std::swap(slot, new_entry);
+        }
+        ++new_entry.probe_distance;
+        current_index = nextSlot(current_index, t.capacity);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashTable<Key, Value, Hash>::retireOldEntryLocked(const Key& key, size_t hash) {
+    SlotArray* old = old_table_.load(std::memory_order_relaxed);
+    if (!old) {
+        return false;
+    }
+    size_t index = findIndex(*old, key, hash, true);
+    if (index == old->capacity) {
+        return false;
+    }
+    old->retired[index] = true;
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::insertLocked(const Key& key, const Value& value) {
+    migrateLocked(kMigrationBatch);
+
+    size_t count = current_size.load(std::memory_order_relaxed);
+    if (count + 1 > table_.load(std::memory_order_relaxed)->capacity * kMaxLoadFactor) {
+        resizeLocked(table_.load(std::memory_order_relaxed)->capacity * 2);
+    }
+
+    SlotArray* current = table_.load(std::memory_order_relaxed);
+    size_t hash = hashFunction(key);
+    uint32_t probe_distance = 0;
+    bool found_key = false;
+    bool found_empty_slot = false;
+    size_t index = robinHoodProbe(*current, key, homeSlot(hash, current->capacity), probe_distance,
+                                  found_key, found_empty_slot);
+
+    SeqLockWriteGuard seq_guard(seq_lock_);
+    if (found_key) {
+        current->slots[index].value = value; // Key already exists, update value in place
+        return;
+    }
+
+    Entry new_entry;
+    new_entry.key = key;
+    new_entry.value = value;
+    new_entry.probe_distance = probe_distance;
+    resolveRobinHoodCollision(*current, new_entry, index);
+
+    // A key still live in the draining table moves rather than being added.
+    if (!retireOldEntryLocked(key, hash)) {
+        current_size.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashTable<Key, Value, Hash>::remove(const Key& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return removeLocked(key);
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::insertBatch(const Key* keys, const Value* values, size_t n) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (size_t i = 0; i < n; ++i) {
+        insertLocked(keys[i], values[i]);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashTable<Key, Value, Hash>::removeBatch(const Key* keys, size_t n) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t removed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        removed += removeLocked(keys[i]) ? 1 : 0;
+    }
+    return removed;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashTable<Key, Value, Hash>::removeLocked(const Key& key) {
+    migrateLocked(kMigrationBatch);
+
+    SlotArray* current = table_.load(std::memory_order_relaxed);
+    size_t hash = hashFunction(key);
+    uint32_t probe_distance = 0;
+    bool found_key = false;
+    bool found_empty_slot = false;
+    size_t index = robinHoodProbe(*current, key, homeSlot(hash, current->capacity), probe_distance,
+                                  found_key, found_empty_slot);
+
+    SeqLockWriteGuard seq_guard(seq_lock_);
+    if (found_key) {
+        // Backward-shift deletion: pull the rest of the cluster back by one slot
+        // until we reach an empty slot or an entry already in its home slot.
+        size_t next = nextSlot(index, current->capacity);
+        while (current->slots[next].probe_distance > 1) {
+            current->slots[index] = std::move(current->slots[next]);
+            --current->slots[index].probe_distance;
+            index = next;
+            next = nextSlot(next, current->capacity);
+        }
+        current->slots[index] = Entry(); // Also releases any heap storage owned by the key
+    } else if (!retireOldEntryLocked(key, hash)) {
+        return false;
+    }
+    current_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// --- Online resize ---
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::migrateLocked(size_t budget) {
+    SlotArray* old = old_table_.load(std::memory_order_relaxed);
+    if (!old) {
+        return;
+    }
+    SlotArray* current = table_.load(std::memory_order_relaxed);
+
+    {
+        SeqLockWriteGuard seq_guard(seq_lock_);
+        for (; budget > 0 && migrate_cursor_ < old->capacity; --budget, ++migrate_cursor_) {
+            Entry& entry = old->slots[migrate_cursor_];
+            if (entry.isEmpty() || old->retired[migrate_cursor_]) {
+                continue;
+            }
+            // Live old keys are never present in the new table (writes retire them).
+            // The retired flag hides the moved-from key from later old-table probes.
+            Entry moved = std::move(entry);
+            moved.probe_distance = 1;
+            resolveRobinHoodCollision(*current, moved, homeSlot(hashFunction(moved.key), current->capacity));
+            old->retired[migrate_cursor_] = true;
+        }
+        if (migrate_cursor_ == old->capacity) {
+            old_table_.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    if (migrate_cursor_ == old->capacity) {
+        releaseSlotArray(old);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::releaseSlotArray(SlotArray* t) {
+    if constexpr (kOptimisticReads) {
+        // Lock-free readers may still be probing the drained array.
+        RcuUtils::callRcu([t]() { delete t; });
+    } else {
+        delete t; // Readers hold write_mutex_, so nobody can still see it.
+    }
+}
+
+// --- RCU specific methods ---
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::performRcuUpdate(const Key& key, const Value& value, bool is_insert) {
+    // Individual updates are already reader-safe (SeqLock); only table
+    // replacement needs a grace period, so this is a plain insert/remove.
+    if (is_insert) {
+        insert(key, value);
+    } else {
+        remove(key);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::synchronizeRcu() {
+    RcuUtils::synchronizeRcu();
+}
+
+// --- Utility ---
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashTable<Key, Value, Hash>::hashFunction(const Key& key) const {
+    return hasher_(key);
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashTable<Key, Value, Hash>::getMaxProbeDistance() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const SlotArray* current = table_.load(std::memory_order_relaxed);
+    size_t max_distance = 0;
+    for (size_t i = 0; i < current->capacity; ++i) {
+        if (current->slots[i].probe_distance > max_distance) {
+            max_distance = current->slots[i].probe_distance;
+        }
+    }
+    return max_distance;
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::resize(size_t new_capacity) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    resizeLocked(new_capacity);
+}
+
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashTable<Key, Value, Hash>::resizeLocked(size_t new_capacity) {
+    // Only one migration at a time: drain the previous table first.
+    migrateLocked(static_cast<size_t>(-1));
+
+    if (new_capacity < current_size.load(std::memory_order_relaxed) || new_capacity == 0) {
+        std::cerr << "Error: Resize to " << new_capacity << " cannot hold "
+                  << current_size.load(std::memory_order_relaxed) << " elements." << std::endl;
+        return;
+    }
+
+    SlotArray* current = table_.load(std::memory_order_relaxed);
+    // Allocated before the array is published as old_table_, so readers that
+    // reach it through old_table_ always see an initialised retired map.
+    current->retired.reset(new bool[current->capacity]());
+    migrate_cursor_ = 0;
+
+    SeqLockWriteGuard seq_guard(seq_lock_);
+    old_table_.store(current, std::memory_order_release);
+    table_.store(new SlotArray(new_capacity), std::memory_order_release);
+}
+
+// The string -> int table is explicitly instantiated in concurrent_hash.cpp.
+extern template class ConcurrentHashTable<std::string, int>;
+
 #endif // CONCURRENT_HASH_TABLE_H
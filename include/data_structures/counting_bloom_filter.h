@@ -0,0 +1,81 @@
+#ifndef COUNTING_BLOOM_FILTER_H
+#define COUNTING_BLOOM_FILTER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>    // For uint64_t
+#include <cstddef>    // For size_t
+
+// Counting Bloom filter with 4-bit saturating counters, supporting remove().
+//
+// Same blocked layout as BloomFilter: an item's k counters all sit in one
+// 64-byte block (8 uint64_t words of 16 nibbles = 128 counters), so every
+// operation touches a single cache line. Queries test "all k counters
+// non-zero" with a masked compare over the block's words.
+//
+// A counter that reaches 15 saturates and is never decremented again (its true
+// count is unknown), so remove() can never introduce false negatives; a
+// saturated counter only keeps that position set. With sensible sizing
+// saturation is vanishingly rare.
+//
+// Not internally synchronised; callers serialise writers against readers.
+class CountingBloomFilter {
+public:
+    static constexpr size_t kWordsPerBlock = 8;
+    static constexpr uint64_t kCountersPerWord = 16;
+    static constexpr uint64_t kCountersPerBlock = kWordsPerBlock * kCountersPerWord;
+    static constexpr uint64_t kMaxCount = 15;
+
+    // Sized like BloomFilter: m counters and k hashes for the expected item
+    // count and false-positive probability.
+    CountingBloomFilter(uint64_t num_items, double false_positive_prob);
+    // size: number of counters (rounded up to whole blocks). num_hashes: k.
+    CountingBloomFilter(uint64_t size, int num_hashes);
+
+    void insert(const std::string& item);
+    void insert(const unsigned char* data, size_t len);
+
+    // Removes one occurrence of an item previously inserted. Returns false (and
+    // changes nothing) if the item is definitely not present. Removing an item
+    // that was never inserted but is a false positive corrupts the filter, so
+    // only remove what you inserted.
+    bool remove(const std::string& item);
+    bool remove(const unsigned char* data, size_t len);
+
+    bool possiblyContains(const std::string& item) const;
+    bool possiblyContains(const unsigned char* data, size_t len) const;
+
+    // Clears every counter.
+    void clear();
+
+    // --- Configuration & Utility ---
+    uint64_t getSize() const { return num_counters_; } // Requested number of counters
+    int getNumHashFunctions() const { return num_hash_functions_; }
+    uint64_t getBlockCount() const { return blocks_.size(); }
+    uint64_t getCount() const { return current_count_; } // Insertions minus successful removals
+    uint64_t getSaturatedCounterCount() const;
+    double getEffectiveFalsePositiveProbability() const;
+
+private:
+    struct alignas(64) Block {
+        uint64_t words[kWordsPerBlock];
+    };
+
+    // An item's block, with the low bit of each of its k nibbles set.
+    struct Probe {
+        uint64_t block;
+        uint64_t mask[kWordsPerBlock];
+    };
+
+    uint64_t num_counters_;
+    int num_hash_functions_;
+    uint64_t block_counters_; // Counters used per block: kCountersPerBlock, or m if smaller
+    std::vector<Block> blocks_;
+    uint64_t current_count_;
+
+    void allocateBlocks();
+    void makeProbe(const unsigned char* data, size_t len, Probe& probe) const;
+    bool containsProbe(const Probe& probe) const;
+};
+
+#endif // COUNTING_BLOOM_FILTER_H
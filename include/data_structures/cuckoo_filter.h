@@ -0,0 +1,261 @@
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <string>
+#include <vector>
+#include <cmath>        // For std::pow
+#include <type_traits>  // For std::conditional_t, std::is_same
+#include <cstdint>      // For uint8_t, uint16_t, uint32_t, uint64_t
+#include <cstddef>      // For size_t
+
+#include "utils/hashing.h" // For HashUtils::wyhash
+
+// Cuckoo filter (Fan et al., CoNEXT 2014): an approximate set like BloomFilter
+// that also supports remove(). It stores a short fingerprint of each item in
+// one of two candidate buckets of kSlotsPerBucket slots; the second bucket is
+// derived from the first and the fingerprint alone (partial-key cuckoo
+// hashing), so fingerprints can be relocated without the original item.
+//
+// A bucket is one machine word (4 x 8-bit or 4 x 16-bit fingerprints), so a
+// query reads at most two words and compares all four lanes of each at once
+// with a SWAR zero-lane test. The false-positive rate is about
+// 2 * kSlotsPerBucket / 2^bits at full load (~3% for 8-bit, ~0.01% for 16-bit
+// fingerprints) at ~95% occupancy, which beats a Bloom filter's space per item
+// for rates below roughly 3%.
+//
+// Items to be removed must have been inserted (removing a false positive
+// deletes another item's fingerprint). Not internally synchronised.
+template <typename Fingerprint = uint16_t>
+class CuckooFilter {
+    static_assert(std::is_same<Fingerprint, uint8_t>::value || std::is_same<Fingerprint, uint16_t>::value,
+                  "Fingerprints are 8 or 16 bits");
+
+public:
+    static constexpr size_t kSlotsPerBucket = 4;
+    static constexpr unsigned kFingerprintBits = sizeof(Fingerprint) * 8;
+    // Relocations tried before an insert gives up and the filter reports full.
+    static constexpr size_t kMaxKicks = 500;
+
+    // Sized for num_items at ~95% bucket occupancy (bucket count rounded up to
+    // a power of two, so the actual capacity may be up to twice that).
+    explicit CuckooFilter(uint64_t num_items);
+
+    // Returns false if the filter is full; the item is then not added.
+    bool insert(const std::string& item);
+    bool insert(const unsigned char* data, size_t len);
+
+    // Removes one copy of an item that was inserted. Returns false if no
+    // matching fingerprint was found.
+    bool remove(const std::string& item);
+    bool remove(const unsigned char* data, size_t len);
+
+    bool possiblyContains(const std::string& item) const;
+    bool possiblyContains(const unsigned char* data, size_t len) const;
+
+    // --- Utility ---
+    size_t size() const { return count_; }
+    size_t getBucketCount() const { return buckets_.size(); }
+    size_t getCapacity() const { return buckets_.size() * kSlotsPerBucket; }
+    double getLoadFactor() const { return static_cast<double>(count_) / getCapacity(); }
+    double getEffectiveFalsePositiveProbability() const;
+
+private:
+    // One bucket = four fingerprint lanes packed into one word.
+    using Word = std::conditional_t<sizeof(Fingerprint) == 1, uint32_t, uint64_t>;
+    static constexpr Word kLaneMask = static_cast<Word>((uint64_t{1} << kFingerprintBits) - 1);
+    static constexpr Word kLowBits = static_cast<Word>(~Word{0}) / kLaneMask;  // 0x0101... / 0x0001...
+    static constexpr Word kHighBits = kLowBits << (kFingerprintBits - 1);    // 0x8080... / 0x8000...
+
+    std::vector<Word> buckets_;
+    size_t bucket_mask_;
+    size_t count_;
+    uint64_t rng_state_; // xorshift state for choosing eviction victims
+
+    // An item evicted by a failed insert; kept so nothing inserted is lost.
+    // While it is in use the filter is full.
+    struct Victim {
+        size_t bucket = 0;
+        Word fingerprint = 0;
+        bool used = false;
+    } victim_;
+
+    static Word lane(Word bucket, size_t slot) { return (bucket >> (slot * kFingerprintBits)) & kLaneMask; }
+    static void setLane(Word& bucket, size_t slot, Word fp) {
+        bucket = (bucket & ~(kLaneMask << (slot * kFingerprintBits))) | (fp << (slot * kFingerprintBits));
+    }
+    // True if any lane equals fp (exact SWAR "has zero lane" on bucket ^ fp-broadcast).
+    static bool hasFingerprint(Word bucket, Word fp) {
+        Word x = bucket ^ (fp * kLowBits);
+        return ((x - kLowBits) & ~x & kHighBits) != 0;
+    }
+
+    void locate(const unsigned char* data, size_t len, Word& fp, size_t& i1, size_t& i2) const;
+    size_t altIndex(size_t index, Word fp) const {
+        return (index ^ static_cast<size_t>(static_cast<uint64_t>(fp) * 0x5bd1e995ULL)) & bucket_mask_;
+    }
+    bool tryPlace(size_t index, Word fp);
+    // Stores fp in bucket i1 or i2, relocating residents if needed. Returns
+    // false if it had to park a fingerprint as the victim (filter now full).
+    bool place(size_t i1, size_t i2, Word fp);
+    bool tryRemove(size_t index, Word fp);
+    uint64_t nextRandom();
+};
+
+// ============================================================================
+// Template implementation
+// ============================================================================
+
+template <typename Fingerprint>
+CuckooFilter<Fingerprint>::CuckooFilter(uint64_t num_items) : count_(0), rng_state_(0x9E3779B97F4A7C15ULL) {
+    uint64_t wanted = static_cast<uint64_t>(static_cast<double>(num_items) / (kSlotsPerBucket * 0.95)) + 1;
+    size_t bucket_count = 2;
+    while (bucket_count < wanted) {
+        bucket_count <<= 1;
+    }
+    buckets_.assign(bucket_count, Word{0});
+    bucket_mask_ = bucket_count - 1;
+}
+
+template <typename Fingerprint>
+void CuckooFilter<Fingerprint>::locate(const unsigned char* data, size_t len, Word& fp, size_t& i1, size_t& i2) const {
+    uint64_t hash = HashUtils::wyhash(data, len, 0);
+    fp = static_cast<Word>(hash) & kLaneMask;
+    if (fp == 0) {
+        fp = 1; // 0 marks an empty lane
+    }
+    i1 = static_cast<size_t>(hash >> 32) & bucket_mask_;
+    i2 = altIndex(i1, fp);
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::tryPlace(size_t index, Word fp) {
+    Word& bucket = buckets_[index];
+    for (size_t slot = 0; slot < kSlotsPerBucket; ++slot) {
+        if (lane(bucket, slot) == 0) {
+            setLane(bucket, slot, fp);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::tryRemove(size_t index, Word fp) {
+    Word& bucket = buckets_[index];
+    for (size_t slot = 0; slot < kSlotsPerBucket; ++slot) {
+        if (lane(bucket, slot) == fp) {
+            setLane(bucket, slot, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Fingerprint>
+uint64_t CuckooFilter<Fingerprint>::nextRandom() {
+    rng_state_ ^= rng_state_ << 13;
+    rng_state_ ^= rng_state_ >> 7;
+    rng_state_ ^= rng_state_ << 17;
+    return rng_state_;
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::insert(const std::string& item) {
+    return insert(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::insert(const unsigned char* data, size_t len) {
+    if (victim_.used) {
+        return false; // Full: the last relocation chain is still homeless
+    }
+    Word fp;
+    size_t i1, i2;
+    locate(data, len, fp, i1, i2);
+    place(i1, i2, fp);
+    ++count_; // Stored even if a victim had to be parked
+    return true;
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::place(size_t i1, size_t i2, Word fp) {
+    if (tryPlace(i1, fp) || tryPlace(i2, fp)) {
+        return true;
+    }
+
+    // Both buckets full: evict random residents along a random walk.
+    size_t index = (nextRandom() & 1) ? i1 : i2;
+    for (size_t kick = 0; kick < kMaxKicks; ++kick) {
+        size_t slot = static_cast<size_t>(nextRandom() % kSlotsPerBucket);
+        Word evicted = lane(buckets_[index], slot);
+        setLane(buckets_[index], slot, fp);
+        fp = evicted;
+        index = altIndex(index, fp);
+        if (tryPlace(index, fp)) {
+            return true;
+        }
+    }
+    // Keep the last evicted fingerprint aside so no inserted item is lost.
+    victim_.bucket = index;
+    victim_.fingerprint = fp;
+    victim_.used = true;
+    return false;
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::remove(const std::string& item) {
+    return remove(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::remove(const unsigned char* data, size_t len) {
+    Word fp;
+    size_t i1, i2;
+    locate(data, len, fp, i1, i2);
+    if (tryRemove(i1, fp) || tryRemove(i2, fp)) {
+        --count_;
+        if (victim_.used) {
+            // A slot has opened up somewhere: try to rehome the parked victim.
+            Victim parked = victim_;
+            victim_.used = false;
+            place(parked.bucket, altIndex(parked.bucket, parked.fingerprint), parked.fingerprint);
+        }
+        return true;
+    }
+    if (victim_.used && victim_.fingerprint == fp && (victim_.bucket == i1 || victim_.bucket == i2)) {
+        victim_.used = false;
+        --count_;
+        return true;
+    }
+    return false;
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::possiblyContains(const std::string& item) const {
+    return possiblyContains(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::possiblyContains(const unsigned char* data, size_t len) const {
+    Word fp;
+    size_t i1, i2;
+    locate(data, len, fp, i1, i2);
+    if (hasFingerprint(buckets_[i1], fp) || hasFingerprint(buckets_[i2], fp)) {
+        return true;
+    }
+    return victim_.used && victim_.fingerprint == fp && (victim_.bucket == i1 || victim_.bucket == i2);
+}
+
+template <typename Fingerprint>
+double CuckooFilter<Fingerprint>::getEffectiveFalsePositiveProbability() const {
+    // A query compares against the occupied lanes of two buckets; each matches
+    // a random fingerprint with probability 1 / (2^bits - 1).
+    double occupied_lanes = 2.0 * kSlotsPerBucket * getLoadFactor();
+    return 1.0 - std::pow(1.0 - 1.0 / static_cast<double>(kLaneMask), occupied_lanes);
+}
+
+// Both fingerprint widths are instantiated once in cuckoo_filter.cpp.
+extern template class CuckooFilter<uint8_t>;
+extern template class CuckooFilter<uint16_t>;
+
+#endif // CUCKOO_FILTER_H
@@ -0,0 +1,374 @@
+#ifndef CUCKOO_HASH_TABLE_H
+#define CUCKOO_HASH_TABLE_H
+
+#include <string>
+#include <vector>
+#include <atomic>       // For std::atomic (published bucket array)
+#include <memory>       // For std::unique_ptr
+#include <mutex>        // For the writer mutex
+#include <algorithm>    // For std::find
+#include <initializer_list>
+#include <type_traits>  // For std::is_trivially_copyable
+#include <utility>      // For std::move
+#include <cstdint>      // For uint8_t, uint64_t
+#include <cstddef>      // For size_t
+
+#include "data_structures/concurrent_hash.h" // For DefaultKeyHash
+#include "utils/threading.h"                 // For SeqLock, RcuUtils
+
+// Bucketized cuckoo hash table (MemC3/libcuckoo style) for exact-match lookups.
+// Every key lives in one of two candidate buckets of kSlotsPerBucket slots, so
+// a lookup reads at most two buckets no matter how full the table is. Each slot
+// has a one-byte tag (partial hash, 0 = empty) that is checked before the key.
+//
+// Inserts that find both buckets full search breadth-first for a short chain of
+// displacements ("cuckoo path") ending in a free slot, then move the keys along
+// it back to front, so every key stays findable throughout. The table only grows
+// when no path is found within kMaxSearchNodes buckets, which for 4-way buckets
+// typically happens above 95% occupancy.
+//
+// Concurrency: writers are serialised by a mutex. Every bucket carries its own
+// version counter (a SeqLock) that writers bump around each change to it; a
+// displacement bumps both buckets involved. With trivially-copyable Key/Value,
+// readers are lock-free: they read both buckets optimistically and retry if
+// either version moved. Grown bucket arrays are reclaimed via RcuUtils::callRcu.
+template <typename Key = std::string, typename Value = int, typename Hash = DefaultKeyHash<Key>>
+class CuckooHashTable {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+
+    static constexpr size_t kSlotsPerBucket = 4;
+    // Upper bound on buckets explored when searching for a cuckoo path.
+    static constexpr size_t kMaxSearchNodes = 256;
+
+    explicit CuckooHashTable(size_t initial_size = 1024);
+    ~CuckooHashTable();
+
+    CuckooHashTable(const CuckooHashTable&) = delete;
+    CuckooHashTable& operator=(const CuckooHashTable&) = delete;
+
+    // --- Core Functionality ---
+    bool lookup(const Key& key, Value& value) const;
+    void insert(const Key& key, const Value& value);
+    bool remove(const Key& key);
+
+    // --- Utility ---
+    size_t hashFunction(const Key& key) const { return hasher_(key); }
+    size_t size() const { return current_size_.load(std::memory_order_relaxed); }
+    size_t getCapacity() const { return table_.load(std::memory_order_acquire)->bucket_count * kSlotsPerBucket; }
+    size_t getBucketCount() const { return table_.load(std::memory_order_acquire)->bucket_count; }
+    double getLoadFactor() const { return static_cast<double>(size()) / getCapacity(); }
+
+private:
+    static constexpr bool kOptimisticReads =
+        std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value;
+
+    // Tags and keys come first so a miss (or tag mismatch) never touches values.
+    struct alignas(64) Bucket {
+        SeqLock version;
+        uint8_t tags[kSlotsPerBucket] = {};
+        Key keys[kSlotsPerBucket]{};
+        Value values[kSlotsPerBucket]{};
+    };
+
+    struct BucketArray {
+        size_t bucket_count; // Power of two, >= 2
+        std::unique_ptr<Bucket[]> buckets;
+
+        explicit BucketArray(size_t count) : bucket_count(count), buckets(new Bucket[count]) {}
+    };
+
+    // Candidate buckets and tag derived from one key hash.
+    struct KeyPosition {
+        size_t primary;
+        size_t secondary;
+        uint8_t tag;
+    };
+
+    // One explored bucket in the breadth-first cuckoo path search.
+    struct SearchNode {
+        size_t bucket;
+        int parent;         // Index into the search queue, -1 for a root
+        size_t parent_slot; // Slot in the parent's bucket whose key moves here
+    };
+
+    std::atomic<BucketArray*> table_;
+    std::atomic<size_t> current_size_;
+    Hash hasher_;
+
+    mutable std::mutex write_mutex_;
+
+    static KeyPosition position(size_t hash, size_t bucket_count) {
+        uint64_t m = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+        m ^= m >> 29;
+        KeyPosition pos;
+        pos.primary = static_cast<size_t>(m) & (bucket_count - 1);
+        // Second, independent hash function over the same key hash.
+        uint64_t m2 = ((m >> 32) | (m << 32)) * 0xC2B2AE3D27D4EB4FULL;
+        pos.secondary = static_cast<size_t>(m2 >> 20) & (bucket_count - 1);
+        if (pos.secondary == pos.primary) {
+            pos.secondary ^= 1; // Always two distinct buckets
+        }
+        uint8_t tag = static_cast<uint8_t>(m >> 56);
+        pos.tag = tag ? tag : 1; // 0 marks an empty slot
+        return pos;
+    }
+
+    // Returns the slot holding key in bucket b, or kSlotsPerBucket.
+    static size_t findInBucket(const Bucket& b, const Key& key, uint8_t tag) {
+        for (size_t i = 0; i < kSlotsPerBucket; ++i) {
+            if (b.tags[i] == tag && b.keys[i] == key) {
+                return i;
+            }
+        }
+        return kSlotsPerBucket;
+    }
+    static size_t freeSlot(const Bucket& b) {
+        for (size_t i = 0; i < kSlotsPerBucket; ++i) {
+            if (b.tags[i] == 0) {
+                return i;
+            }
+        }
+        return kSlotsPerBucket;
+    }
+
+    // Places key into t, displacing residents if needed. Returns false when no
+    // cuckoo path exists within kMaxSearchNodes (write_mutex_ held).
+    bool placeLocked(BucketArray& t, const Key& key, const Value& value, const KeyPosition& pos);
+    // Breadth-first search for a path from pos's buckets to a free slot.
+    // Returns the index of the final node in 'nodes', or -1.
+    int findCuckooPath(const BucketArray& t, const KeyPosition& pos, std::vector<SearchNode>& nodes) const;
+    void growLocked();
+    static void releaseBucketArray(BucketArray* t);
+};
+
+// ============================================================================
+// Template implementation
+// ============================================================================
+
+template <typename Key, typename Value, typename Hash>
+CuckooHashTable<Key, Value, Hash>::CuckooHashTable(size_t initial_size) : current_size_(0) {
+    size_t bucket_count = 2;
+    while (bucket_count * kSlotsPerBucket < initial_size) {
+        bucket_count <<= 1;
+    }
+    table_.store(new BucketArray(bucket_count), std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Hash>
+CuckooHashTable<Key, Value, Hash>::~CuckooHashTable() {
+    delete table_.load(std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Hash>
+bool CuckooHashTable<Key, Value, Hash>::lookup(const Key& key, Value& value) const {
+    const size_t hash = hasher_(key);
+
+    if constexpr (kOptimisticReads) {
+        RcuUtils::rcuReadLock(); // Keeps a concurrently replaced bucket array alive
+        for (;;) {
+            const BucketArray* t = table_.load(std::memory_order_acquire);
+            const KeyPosition pos = position(hash, t->bucket_count);
+            const Bucket& b1 = t->buckets[pos.primary];
+            const Bucket& b2 = t->buckets[pos.secondary];
+
+            uint64_t v1 = b1.version.readBegin();
+            uint64_t v2 = b2.version.readBegin();
+            Value candidate{};
+            bool found = false;
+            size_t slot = findInBucket(b1, key, pos.tag);
+            if (slot != kSlotsPerBucket) {
+                candidate = b1.values[slot];
+                found = true;
+            } else if ((slot = findInBucket(b2, key, pos.tag)) != kSlotsPerBucket) {
+                candidate = b2.values[slot];
+                found = true;
+            }
+
+            // Retry if either bucket changed (e.g. a displacement moved the key
+            // between them) or the whole table was replaced by a grow.
+            if (b1.version.readRetry(v1) || b2.version.readRetry(v2) ||
+                table_.load(std::memory_order_acquire) != t) {
+                continue;
+            }
+            RcuUtils::rcuReadUnlock();
+            if (found) {
+                value = candidate;
+            }
+            return found;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        const BucketArray* t = table_.load(std::memory_order_relaxed);
+        const KeyPosition pos = position(hash, t->bucket_count);
+        for (size_t b : {pos.primary, pos.secondary}) {
+            size_t slot = findInBucket(t->buckets[b], key, pos.tag);
+            if (slot != kSlotsPerBucket) {
+                value = t->buckets[b].values[slot];
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void CuckooHashTable<Key, Value, Hash>::insert(const Key& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const size_t hash = hasher_(key);
+    BucketArray* t = table_.load(std::memory_order_relaxed);
+    KeyPosition pos = position(hash, t->bucket_count);
+
+    for (size_t b : {pos.primary, pos.secondary}) {
+        Bucket& bucket = t->buckets[b];
+        size_t slot = findInBucket(bucket, key, pos.tag);
+        if (slot != kSlotsPerBucket) {
+            SeqLockWriteGuard guard(bucket.version);
+            bucket.values[slot] = value; // Key already exists, update value in place
+            return;
+        }
+    }
+
+    while (!placeLocked(*t, key, value, pos)) {
+        growLocked();
+        t = table_.load(std::memory_order_relaxed);
+        pos = position(hash, t->bucket_count);
+    }
+    current_size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Hash>
+bool CuckooHashTable<Key, Value, Hash>::remove(const Key& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    BucketArray* t = table_.load(std::memory_order_relaxed);
+    const KeyPosition pos = position(hasher_(key), t->bucket_count);
+
+    for (size_t b : {pos.primary, pos.secondary}) {
+        Bucket& bucket = t->buckets[b];
+        size_t slot = findInBucket(bucket, key, pos.tag);
+        if (slot != kSlotsPerBucket) {
+            SeqLockWriteGuard guard(bucket.version);
+            bucket.tags[slot] = 0;
+            bucket.keys[slot] = Key{};     // Release resources held by the key/value (e.g. strings)
+            bucket.values[slot] = Value{};
+            current_size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Key, typename Value, typename Hash>
+int CuckooHashTable<Key, Value, Hash>::findCuckooPath(const BucketArray& t, const KeyPosition& pos,
+                                                      std::vector<SearchNode>& nodes) const {
+    nodes.clear();
+    nodes.push_back({pos.primary, -1, 0});
+    nodes.push_back({pos.secondary, -1, 0});
+    std::vector<size_t> visited = {pos.primary, pos.secondary};
+
+    for (size_t head = 0; head < nodes.size(); ++head) {
+        const SearchNode node = nodes[head];
+        const Bucket& bucket = t.buckets[node.bucket];
+        if (freeSlot(bucket) != kSlotsPerBucket) {
+            return static_cast<int>(head);
+        }
+        // Every resident could move to its other candidate bucket.
+        for (size_t slot = 0; slot < kSlotsPerBucket && nodes.size() < kMaxSearchNodes; ++slot) {
+            const KeyPosition resident = position(hasher_(bucket.keys[slot]), t.bucket_count);
+            size_t alternate = resident.primary == node.bucket ? resident.secondary : resident.primary;
+            // Visiting each bucket once keeps paths simple, so moves never collide.
+            if (std::find(visited.begin(), visited.end(), alternate) != visited.end()) {
+                continue;
+            }
+            visited.push_back(alternate);
+            nodes.push_back({alternate, static_cast<int>(head), slot});
+        }
+    }
+    return -1;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool CuckooHashTable<Key, Value, Hash>::placeLocked(BucketArray& t, const Key& key, const Value& value,
+                                                    const KeyPosition& pos) {
+    std::vector<SearchNode> nodes;
+    nodes.reserve(kMaxSearchNodes);
+    int node = findCuckooPath(t, pos, nodes);
+    if (node < 0) {
+        return false;
+    }
+
+    // Move keys back to front: each move fills a free slot and frees the slot
+    // the next move (closer to the root) needs.
+    while (nodes[node].parent >= 0) {
+        const SearchNode& to = nodes[node];
+        Bucket& dst = t.buckets[to.bucket];
+        Bucket& src = t.buckets[nodes[to.parent].bucket];
+        size_t dst_slot = freeSlot(dst);
+        {
+            // A key is briefly in both buckets; readers of either retry.
+            SeqLockWriteGuard dst_guard(dst.version);
+            SeqLockWriteGuard src_guard(src.version);
+            dst.keys[dst_slot] = std::move(src.keys[to.parent_slot]);
+            dst.values[dst_slot] = std::move(src.values[to.parent_slot]);
+            dst.tags[dst_slot] = src.tags[to.parent_slot];
+            src.tags[to.parent_slot] = 0;
+        }
+        node = to.parent;
+    }
+
+    Bucket& target = t.buckets[nodes[node].bucket];
+    size_t slot = freeSlot(target);
+    SeqLockWriteGuard guard(target.version);
+    target.keys[slot] = key;
+    target.values[slot] = value;
+    target.tags[slot] = pos.tag;
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+void CuckooHashTable<Key, Value, Hash>::growLocked() {
+    BucketArray* old_table = table_.load(std::memory_order_relaxed);
+    size_t bucket_count = old_table->bucket_count * 2;
+
+    // The new array stays private until published. In the unlikely case a
+    // rehash cannot place every key, double again.
+    for (;;) {
+        std::unique_ptr<BucketArray> fresh(new BucketArray(bucket_count));
+        bool placed_all = true;
+        for (size_t b = 0; b < old_table->bucket_count && placed_all; ++b) {
+            const Bucket& bucket = old_table->buckets[b];
+            for (size_t i = 0; i < kSlotsPerBucket; ++i) {
+                if (bucket.tags[i] == 0) {
+                    continue;
+                }
+                const KeyPosition pos = position(hasher_(bucket.keys[i]), bucket_count);
+                if (!placeLocked(*fresh, bucket.keys[i], bucket.values[i], pos)) {
+                    placed_all = false;
+                    break;
+                }
+            }
+        }
+        if (placed_all) {
+            table_.store(fresh.release(), std::memory_order_release);
+            releaseBucketArray(old_table);
+            return;
+        }
+        bucket_count *= 2;
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void CuckooHashTable<Key, Value, Hash>::releaseBucketArray(BucketArray* t) {
+    if constexpr (kOptimisticReads) {
+        // Lock-free readers may still be reading the old buckets.
+        RcuUtils::callRcu([t]() { delete t; });
+    } else {
+        delete t; // Readers hold write_mutex_, so nobody can still see it.
+    }
+}
+
+// The string -> int table is explicitly instantiated in cuckoo_hash.cpp.
+extern template class CuckooHashTable<std::string, int>;
+
+#endif // CUCKOO_HASH_TABLE_H
@@ -0,0 +1,256 @@
+#ifndef FLOW_TABLE_H
+#define FLOW_TABLE_H
+
+#include <vector>
+#include <utility>  // For std::pair
+#include <mutex>
+#include <atomic>
+#include <memory>   // For std::unique_ptr
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t, uint64_t
+#include <cstddef>  // For size_t
+
+#include "data_structures/concurrent_hash.h"
+#include "data_structures/sharded_hash.h"
+#include "utils/timer_wheel.h"
+
+// Exact 5-tuple identifying a flow. Packed to 13 bytes with no padding so it can
+// be hashed over its raw bytes (see DefaultKeyHash / HashUtils::hashFiveTuple).
+#pragma pack(push, 1)
+struct FlowKey {
+    uint32_t source_ip = 0;
+    uint32_t dest_ip = 0;
+    uint16_t source_port = 0;
+    uint16_t dest_port = 0;
+    uint8_t protocol = 0;
+
+    FlowKey() = default;
+    FlowKey(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint8_t proto)
+        : source_ip(sip), dest_ip(dip), source_port(sport), dest_port(dport), protocol(proto) {}
+
+    bool operator==(const FlowKey& other) const {
+        return source_ip == other.source_ip && dest_ip == other.dest_ip &&
+               source_port == other.source_port && dest_port == other.dest_port &&
+               protocol == other.protocol;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(FlowKey) == 13, "FlowKey must be a packed 13-byte 5-tuple");
+
+// Orders the two endpoints so both directions of a session map to one key.
+// 'reversed' is set if the endpoints were swapped.
+FlowKey canonicalFlowKey(const FlowKey& key, bool& reversed);
+
+// TCP header flag bits (as in the TCP header's flags byte).
+namespace TcpFlags {
+constexpr uint8_t FIN = 0x01;
+constexpr uint8_t SYN = 0x02;
+constexpr uint8_t RST = 0x04;
+constexpr uint8_t PSH = 0x08;
+constexpr uint8_t ACK = 0x10;
+} // namespace TcpFlags
+
+// Connection state of a packet, as seen by connection tracking (netfilter's
+// ctstate). UNTRACKED is used when conntrack is off.
+enum class ConnState : uint8_t {
+    UNTRACKED = 0,
+    NEW,         // First packets of a connection, no reply seen yet
+    ESTABLISHED, // Packets of a connection that has seen traffic both ways
+    RELATED,     // First packets of an expected connection (see expectRelated)
+    INVALID      // Packets that do not fit the connection's state
+};
+
+// Bit masks for matching sets of states (PacketFilter::conn_state_mask).
+namespace ConnStateMask {
+constexpr uint8_t NEW = 1u << 0;
+constexpr uint8_t ESTABLISHED = 1u << 1;
+constexpr uint8_t RELATED = 1u << 2;
+constexpr uint8_t INVALID = 1u << 3;
+
+inline uint8_t of(ConnState state) {
+    return state == ConnState::UNTRACKED ? 0 : static_cast<uint8_t>(1u << (static_cast<uint8_t>(state) - 1));
+}
+} // namespace ConnStateMask
+
+// Minimal TCP connection state machine, tracked per connection.
+enum class TcpState : uint8_t {
+    NONE = 0,    // Not TCP, or conntrack off
+    SYN_SENT,    // Originator sent SYN
+    SYN_RECV,    // Responder answered SYN+ACK
+    ESTABLISHED, // Handshake completed
+    FIN_WAIT,    // One side sent FIN
+    TIME_WAIT,   // Both sides sent FIN
+    CLOSED       // Reset
+};
+
+// Per-flow state. Timestamps and timeouts are in milliseconds on the caller's clock.
+struct FlowEntry {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t first_seen = 0;
+    uint64_t last_seen = 0;
+    uint64_t idle_timeout = 0; // Expire after this long without packets (0 = never)
+    uint64_t hard_timeout = 0; // Expire this long after first_seen regardless (0 = never)
+
+    // Reply-direction share of packets/bytes (conntrack mode only).
+    uint64_t reply_packets = 0;
+    uint64_t reply_bytes = 0;
+
+    // Cached classification result per direction; only valid while the cache
+    // generation matches the table's current generation (see
+    // FlowTable::invalidateCachedRules) and the packet's connection state is the
+    // one the result was computed for. Flow mode only uses the first set.
+    int cached_rule_id = -1;
+    uint32_t cache_generation = 0;
+    int cached_reply_rule_id = -1;
+    uint32_t reply_cache_generation = 0;
+    ConnState cached_state = ConnState::UNTRACKED;
+    ConnState cached_reply_state = ConnState::UNTRACKED;
+
+    // --- Connection tracking (conntrack mode only) ---
+    TcpState tcp_state = TcpState::NONE;
+    bool originator_reversed = false; // Originator's key was swapped by canonicalFlowKey
+    bool seen_reply = false;
+    bool related = false;             // Created by expectRelated()
+    uint8_t fin_seen = 0;             // Bit 0: originator sent FIN, bit 1: responder did
+
+    // Wheel tick of the timer currently responsible for this flow; timers that
+    // fire with any other tick are stale and ignored.
+    uint64_t timer_tick = 0;
+
+    // Earliest time the flow may expire, or 0 if it never does.
+    uint64_t deadline() const;
+};
+
+// Stateful flow table on top of ShardedHashTable: per-flow packet/byte
+// counters, first/last-seen timestamps, idle and hard timeouts, and a cached
+// classification result per flow.
+//
+// Aging uses a hierarchical timer wheel instead of sweeping the table: every
+// flow has one pending timer at its current deadline. Packets only update
+// last_seen; when a timer fires, the flow is removed if it really is past its
+// deadline, otherwise the timer is re-armed at the new deadline. Expiry cost is
+// therefore proportional to the number of timers firing, never to the table size.
+//
+// Conntrack mode (Config::conntrack) keys flows by canonicalFlowKey(), so both
+// directions of a session share one entry, counts the reply direction
+// separately, and runs a minimal TCP state machine that classifies each packet
+// as NEW, ESTABLISHED, RELATED or INVALID. All key arguments are then given as
+// seen on the wire; expired flows are reported under their canonical key.
+//
+// Lookups are lock-free (ConcurrentHashTable shards with trivially-copyable
+// entries). Updates to a flow are serialised by its shard's update mutex, so
+// packets of different flows mostly update in parallel; the timer wheel has
+// its own mutex (taken after a shard's, never before), which the per-packet
+// path only needs when a flow is created or its deadline moves earlier.
+// Expiry only happens in expire(), so callers decide when (and on which
+// thread) aging runs.
+class FlowTable {
+public:
+    struct Config {
+        uint64_t idle_timeout_ms = 30000;
+        uint64_t hard_timeout_ms = 0;   // 0 = no hard timeout
+        uint64_t tick_ms = 10;          // Timer wheel resolution; flows expire up to one tick late
+        size_t initial_capacity = 4096;
+        bool conntrack = false;             // Bidirectional connection tracking
+        uint64_t tcp_closing_timeout_ms = 10000; // Idle timeout once a TCP connection closes or resets
+    };
+
+    struct TrackResult {
+        ConnState state = ConnState::UNTRACKED;
+        bool created = false; // The packet created the flow
+        bool reply = false;   // The packet travels in the reply direction
+        // Cached result for the packet's direction and state, read by the same
+        // lookup that tracked it: valid iff cache_generation is the generation
+        // the caller classifies under (0 = nothing cached). -1 means no match.
+        int cached_rule_id = -1;
+        uint32_t cache_generation = 0;
+    };
+
+    using ExpiredFlow = std::pair<FlowKey, FlowEntry>;
+
+    FlowTable();
+    explicit FlowTable(const Config& config);
+
+    // Accounts one packet to its flow, creating the flow with the configured
+    // timeouts if needed. In conntrack mode also advances the connection's TCP
+    // state from tcp_flags and reports the packet's connection state; a TCP
+    // packet that cannot open a connection (no SYN) is INVALID and creates nothing.
+    TrackResult track(const FlowKey& key, uint32_t packet_bytes, uint64_t now_ms, uint8_t tcp_flags = 0);
+    // Returns true if the flow was created.
+    bool update(const FlowKey& key, uint32_t packet_bytes, uint64_t now_ms) {
+        return track(key, packet_bytes, now_ms).created;
+    }
+
+    // Conntrack mode: announces a connection expected to follow from another
+    // (e.g. an FTP data channel). Its first packets are RELATED instead of NEW.
+    // Returns false if the flow already exists or conntrack is off.
+    bool expectRelated(const FlowKey& key, uint64_t now_ms);
+
+    bool lookup(const FlowKey& key, FlowEntry& entry) const { return flows_.lookup(tableKey(key), entry); }
+    bool remove(const FlowKey& key);
+
+    // Overrides the default timeouts for an existing flow.
+    bool setTimeouts(const FlowKey& key, uint64_t idle_timeout_ms, uint64_t hard_timeout_ms);
+
+    // --- Classification cache ---
+    // A cached rule id is valid only for the generation it was computed under.
+    // Callers read getGeneration() before classifying and pass it back to
+    // setCachedRule(), so a result computed against rules that changed
+    // mid-classification is stored already stale. rule_id may be -1 (no match).
+    // The per-packet path gets the cached result from track() instead of a
+    // second getCachedRule() lookup.
+    uint32_t getGeneration() const { return generation_.load(std::memory_order_acquire); }
+    // 'state' is the packet's connection state; results are cached per direction
+    // and state, so e.g. a NEW packet never reuses an ESTABLISHED result.
+    bool getCachedRule(const FlowKey& key, int& rule_id, ConnState state = ConnState::UNTRACKED) const;
+    bool setCachedRule(const FlowKey& key, int rule_id, uint32_t generation,
+                       ConnState state = ConnState::UNTRACKED);
+    // O(1) invalidation of every cached result (call whenever rules change).
+    void invalidateCachedRules();
+
+    // Expires every flow past its deadline at now_ms. Expired flows are appended
+    // to 'expired' if given. Returns the number of flows removed.
+    size_t expire(uint64_t now_ms, std::vector<ExpiredFlow>* expired = nullptr);
+
+    size_t size() const { return flows_.size(); }
+    size_t pendingTimers() const;
+    const Config& getConfig() const { return config_; }
+
+private:
+    Config config_;
+    ShardedHashTable<FlowKey, FlowEntry> flows_;
+    TimerWheel<FlowKey> wheel_;
+    mutable std::mutex wheel_mutex_;
+    std::atomic<uint32_t> generation_;
+
+    // One update mutex per flows_ shard, on its own cache line.
+    struct alignas(64) PaddedMutex {
+        std::mutex mutex;
+    };
+    std::unique_ptr<PaddedMutex[]> update_mutexes_;
+
+    // Update mutex of the shard holding table_key (a key already passed through tableKey()).
+    std::mutex& updateMutexFor(const FlowKey& table_key) const {
+        return update_mutexes_[flows_.getShardIndex(table_key)].mutex;
+    }
+
+    uint64_t toTick(uint64_t ms) const { return (ms + config_.tick_ms - 1) / config_.tick_ms; }
+    FlowKey tableKey(const FlowKey& key) const {
+        bool reversed;
+        return config_.conntrack ? canonicalFlowKey(key, reversed) : key;
+    }
+    // Whether a packet with this key travels in the entry's reply direction.
+    bool isReply(const FlowKey& key, const FlowEntry& entry) const;
+    // Advances the connection (and TCP) state for one packet of an existing
+    // conntrack entry; returns the packet's connection state.
+    ConnState advanceConnLocked(FlowEntry& entry, bool reply, uint8_t protocol, uint8_t tcp_flags) const;
+    // Arms a timer at the flow's deadline (if it has one) and records it in
+    // entry. Caller holds the flow's update mutex; takes wheel_mutex_.
+    void armTimerLocked(const FlowKey& key, FlowEntry& entry, uint64_t now_ms);
+};
+
+// Instantiated once in flow_table.cpp.
+extern template class ConcurrentHashTable<FlowKey, FlowEntry>;
+extern template class ShardedHashTable<FlowKey, FlowEntry>;
+
+#endif // FLOW_TABLE_H
@@ -0,0 +1,121 @@
+#ifndef ROTATING_BLOOM_FILTER_H
+#define ROTATING_BLOOM_FILTER_H
+
+#include <atomic>
+#include <memory>   // For std::unique_ptr
+#include <mutex>
+#include <string>
+#include <cstdint>  // For uint64_t
+#include <cstddef>  // For size_t
+
+#include "data_structures/concurrent_bloom_filter.h"
+
+// Time-decaying, self-sizing Bloom filter for "seen recently" sets (e.g. a
+// negative cache of flows that matched no rule).
+//
+// Time is cut into slices of Config::slice_ms. Each slice's inserts go into
+// its own generation, and a ring keeps the last Config::generations of them;
+// queries OR all live generations. advance() retires the oldest generation
+// each time a slice ends, so an item is remembered for between
+// (generations - 1) and generations slices after its last insert and memory
+// stays bounded no matter how long traffic runs.
+//
+// Sizing follows the traffic instead of being fixed up front:
+//  - A new generation is sized from the distinct items the previous one
+//    actually received (ConcurrentBloomFilter::getApproximateCount()), times
+//    headroom.
+//  - If a slice receives more items than its generation was sized for, the
+//    generation grows another stage with twice the capacity and a tighter
+//    error target (scalable Bloom filter), so a burst never saturates it.
+//    Each thread checks its stage's fill every kFillCheckInterval new items,
+//    so a stage can overshoot its capacity by that many items per thread.
+//
+// Items are hashed once (wyhash) to a 64-bit key and the stages use the
+// integer-key interface, so a query costs one hash however many stages are
+// live.
+//
+// Inserts and queries may run concurrently from any number of threads
+// without locking: stages are ConcurrentBloomFilters, which set bits with
+// fetch_or, and only the thread that finds a stage full takes a mutex to add
+// the next one. advance() and clear() replace generations and must not run
+// concurrently with anything else.
+class RotatingBloomFilter {
+public:
+    struct Config {
+        size_t generations = 4;            // Live generations, including the current one
+        uint64_t slice_ms = 1000;          // Time covered by one generation
+        uint64_t initial_capacity = 10000; // Items the first generation is sized for
+        uint64_t min_capacity = 1024;
+        uint64_t max_capacity = uint64_t{1} << 24; // Per stage
+        double false_positive_prob = 0.01; // Target per generation
+        double headroom = 1.5;             // Next capacity = observed distinct items * headroom
+    };
+
+    RotatingBloomFilter();
+    explicit RotatingBloomFilter(const Config& config, uint64_t now_ms = 0);
+
+    void insert(const std::string& item) { insertKey(keyOf(item)); }
+    void insert(const unsigned char* data, size_t len) { insertKey(keyOf(data, len)); }
+    bool possiblyContains(const std::string& item) const { return possiblyContainsKey(keyOf(item)); }
+    bool possiblyContains(const unsigned char* data, size_t len) const { return possiblyContainsKey(keyOf(data, len)); }
+
+    // Pre-hashed 64-bit keys (e.g. HashUtils::hashFiveTuple of a flow).
+    void insertKey(uint64_t key);
+    bool possiblyContainsKey(uint64_t key) const;
+
+    static constexpr uint64_t kFillCheckInterval = 16;
+    static constexpr size_t kMaxStages = 32; // Per generation; the last one keeps filling after that
+
+    static uint64_t keyOf(const unsigned char* data, size_t len);
+    static uint64_t keyOf(const std::string& item);
+
+    // --- Rotation ---
+    bool isRotationDue(uint64_t now_ms) const { return now_ms >= slice_start_ms_ + config_.slice_ms; }
+    // Rotates once per slice that ended by now_ms. Returns the number of rotations.
+    size_t advance(uint64_t now_ms);
+    // Forgets everything; the current slice restarts at now_ms.
+    void clear(uint64_t now_ms);
+
+    // --- Utility ---
+    const Config& getConfig() const { return config_; }
+    uint64_t getCurrentCapacity() const;  // Items the current generation is sized for (all stages)
+    size_t getStageCount() const;         // BloomFilter stages allocated across all generations
+    uint64_t getMemoryBits() const;       // Storage bits across all stages
+    uint64_t getInsertCount() const;      // Distinct items inserted across live generations (approximate)
+    // Probability that an absent item tests positive in at least one live generation.
+    double getEffectiveFalsePositiveProbability() const;
+
+private:
+    struct Stage {
+        ConcurrentBloomFilter filter;
+        uint64_t capacity;
+
+        Stage(uint64_t stage_capacity, double false_positive_prob)
+            : filter(stage_capacity, false_positive_prob), capacity(stage_capacity) {}
+    };
+
+    // Stages [0, stage_count) are immutable once published with a release
+    // store of stage_count; only advance() and clear() free them.
+    struct Generation {
+        std::unique_ptr<Stage> stages[kMaxStages]; // Allocated on first insert
+        std::atomic<size_t> stage_count{0};
+        uint64_t planned_capacity = 0;
+
+        void reset(uint64_t capacity);
+    };
+
+    Config config_;
+    std::unique_ptr<Generation[]> ring_;
+    size_t current_;
+    uint64_t slice_start_ms_;
+    std::mutex grow_mutex_; // Serialises adding stages
+
+    uint64_t clampCapacity(double capacity) const;
+    // Distinct items a generation received, counted by its filters.
+    uint64_t observedDistinct(const Generation& generation) const;
+    // Adds a stage unless another thread already grew the generation past
+    // seen_count stages. Returns the generation's newest stage.
+    Stage* addStage(Generation& generation, size_t seen_count);
+};
+
+#endif // ROTATING_BLOOM_FILTER_H
@@ -0,0 +1,161 @@
+#ifndef RULE_PREFILTER_H
+#define RULE_PREFILTER_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>   // For std::shared_ptr
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t, uint64_t
+#include <cstddef>  // For size_t
+
+#include "data_structures/binary_fuse_filter.h"
+
+struct PacketFilter; // Defined in packet_classifier.h
+struct PacketHeader;
+
+// Immutable data-plane half of a RulePrefilter: each field's binary fuse
+// filter plus the little state mayMatch() needs, and no reference counts.
+// PacketClassifier publishes one inside every CompiledRuleSet. A field's fuse
+// filter is replaced, never modified, when its values change, so snapshots
+// share filters with the RulePrefilter that produced them instead of
+// copying them.
+class CompiledPrefilter {
+public:
+    // False if no rule can match the packet.
+    bool mayMatch(const PacketHeader& header) const;
+
+private:
+    friend class RulePrefilter;
+
+    struct PrefixField {
+        std::shared_ptr<const BinaryFuseFilter> fuse; // (length, network) keys
+        uint64_t active_lengths = 0; // Bit L set while some rule uses a /L prefix (L > 0)
+        bool wildcard = false;       // Some rule leaves the field unconstrained
+
+        bool mayMatch(uint32_t address) const;
+    };
+
+    struct PortField {
+        struct Range {
+            uint16_t low;
+            uint16_t high;
+        };
+
+        std::shared_ptr<const BinaryFuseFilter> fuse; // Individual ports of exact and narrow ranges
+        std::vector<Range> wide_ranges;
+        bool wildcard = false;
+
+        bool mayMatch(uint16_t port) const;
+    };
+
+    PrefixField source_ip_;
+    PrefixField dest_ip_;
+    PortField source_port_;
+    PortField dest_port_;
+    uint64_t protocols_[4] = {}; // Bit p set while some rule uses protocol p (0 = any protocol)
+    bool empty_ = true;          // No rules
+};
+
+// Per-field pre-filter over the values a rule set references, used to reject
+// packets that no rule can match before any rule is evaluated.
+//
+// For each field it records which concrete values enabled rules constrain it
+// to: source/destination IP prefixes (per prefix length), exact ports and
+// narrow port ranges, wide port ranges, and protocols. Membership of prefixes
+// and ports is tested in static binary fuse filters (three byte loads per
+// probe, ~9 bits per value), so the per-packet query only hashes a few
+// integers and never allocates. A field constrained by no rule (some rule
+// leaves it as "any") accepts every packet.
+//
+// The fuse filters are immutable: the reference counts are the source of
+// truth, and a field's filter is rebuilt from them whenever a rule change adds
+// or retires one of its values. Rule changes are control-plane operations, so
+// their O(values) cost buys a smaller, faster data-plane structure. Between
+// beginBatch() and endBatch() rebuilds are deferred, so a bulk load rebuilds
+// each touched field once. The data-plane state lives in a CompiledPrefilter
+// that snapshot() hands out without the reference counts.
+//
+// mayMatch() returning false is definitive: every rule constrains some field
+// to values that exclude the packet. It is conservative, not exact: a packet
+// can pass each field on behalf of a different rule and still match nothing.
+//
+// Rules are reference-counted per value, so removeRule() must be given the
+// filter exactly as it was added. Not internally synchronised; PacketClassifier
+// guards it with its specialized-structures lock.
+class RulePrefilter {
+public:
+    // Port ranges up to this many ports are expanded into the port filter;
+    // wider ones are kept in a list and checked linearly.
+    static constexpr uint32_t kMaxExpandedPortRange = 16;
+
+    void addRule(const PacketFilter& filter);
+    // Returns false if the filter was not added (nothing is changed).
+    bool removeRule(const PacketFilter& filter);
+
+    // Until the matching endBatch(), rule changes only update the reference
+    // counts; mayMatch() and snapshot() keep reflecting the rules as they were
+    // at beginBatch(). Batches nest.
+    void beginBatch() { ++batch_depth_; }
+    void endBatch();
+
+    // False if no rule can match the packet.
+    bool mayMatch(const PacketHeader& header) const { return compiled_.mayMatch(header); }
+    // Immutable copy of the data-plane state; shares the fuse filters.
+    std::shared_ptr<const CompiledPrefilter> snapshot() const {
+        return std::make_shared<const CompiledPrefilter>(compiled_);
+    }
+
+    size_t getRuleCount() const { return rule_count_; }
+    void clear();
+
+private:
+    // Reference counts of one address field's IP prefixes.
+    struct PrefixField {
+        std::unordered_map<uint64_t, uint32_t> refcounts; // (length, network) keys
+        uint32_t length_refcounts[33] = {};
+        uint32_t wildcard_rules = 0; // Rules that leave the field unconstrained
+        bool dirty = false;          // Set of keys changed since the last publish
+
+        void add(const std::string& prefix);
+        bool contains(const std::string& prefix) const;
+        void remove(const std::string& prefix); // Only after contains()
+        void clear();
+        void publish(CompiledPrefilter::PrefixField& out);
+    };
+
+    // Reference counts of one port field's ranges.
+    struct PortField {
+        struct Range {
+            uint16_t low;
+            uint16_t high;
+            uint32_t refcount;
+        };
+
+        std::unordered_map<uint16_t, uint32_t> refcounts; // Individual ports of exact and narrow ranges
+        std::vector<Range> wide_ranges;
+        uint32_t wildcard_rules = 0;
+        bool dirty = false;
+
+        void add(uint16_t low, uint16_t high);
+        bool contains(uint16_t low, uint16_t high) const;
+        void remove(uint16_t low, uint16_t high); // Only after contains()
+        void clear();
+        void publish(CompiledPrefilter::PortField& out);
+    };
+
+    PrefixField source_ip_;
+    PrefixField dest_ip_;
+    PortField source_port_;
+    PortField dest_port_;
+    uint32_t protocol_refcounts_[256] = {}; // Index 0 counts "any protocol" rules
+    size_t rule_count_ = 0;
+    int batch_depth_ = 0;
+    CompiledPrefilter compiled_;
+
+    // Whether every value of the filter is currently registered.
+    bool contains(const PacketFilter& filter) const;
+    // Brings compiled_ up to date, rebuilding the fuse filters of dirty fields.
+    void publish();
+};
+
+#endif // RULE_PREFILTER_H
@@ -0,0 +1,184 @@
+#ifndef SHARDED_HASH_TABLE_H
+#define SHARDED_HASH_TABLE_H
+
+#include <string>
+#include <vector>
+#include <memory>       // For std::unique_ptr
+#include <cstdint>      // For uint32_t, uint64_t
+#include <cstddef>      // For size_t
+
+#include "data_structures/concurrent_hash.h"
+
+// Write-scalable exact-match table: N independent ConcurrentHashTable shards,
+// each with its own writer mutex and lock-free readers. A key's shard is picked
+// from the high bits of its hash, so writers learning different flows mostly
+// hit different shards and no longer serialise on a single writer path.
+//
+// The shard selector mixes the hash with a different constant from the one the
+// shards use for slot placement; otherwise every key in a shard would share the
+// same top hash bits and crowd one region of that shard's slot array.
+template <typename Key = std::string, typename Value = int, typename Hash = DefaultKeyHash<Key>>
+class ShardedHashTable {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using Shard = ConcurrentHashTable<Key, Value, Hash>;
+
+    static constexpr size_t kDefaultShardCount = 16;
+
+    // initial_size is the total initial capacity, split evenly across shards.
+    // num_shards is rounded up to a power of two.
+    explicit ShardedHashTable(size_t initial_size = 1024, size_t num_shards = kDefaultShardCount);
+
+    ShardedHashTable(const ShardedHashTable&) = delete;
+    ShardedHashTable& operator=(const ShardedHashTable&) = delete;
+
+    // --- Core Functionality ---
+    bool lookup(const Key& key, Value& value) const { return shardFor(key).lookup(key, value); }
+    void insert(const Key& key, const Value& value) { shardFor(key).insert(key, value); }
+    bool remove(const Key& key) { return shardFor(key).remove(key); }
+
+    // --- Bulk operations ---
+    // Keys are grouped by shard first so each shard's writer mutex is taken
+    // once per batch. Within a shard, operations apply in input order.
+    void insertBatch(const Key* keys, const Value* values, size_t n);
+    size_t removeBatch(const Key* keys, size_t n); // Returns the number of keys removed
+
+    // --- Utility ---
+    size_t getShardCount() const { return shards_.size(); }
+    size_t getShardIndex(const Key& key) const {
+        uint64_t m = static_cast<uint64_t>(hasher_(key)) * 0xC2B2AE3D27D4EB4FULL;
+        m ^= m >> 31;
+        return shard_bits_ == 0 ? 0 : static_cast<size_t>(m >> (64 - shard_bits_));
+    }
+    const Shard& getShard(size_t index) const { return shards_[index]->table; }
+
+    size_t size() const;
+    size_t getCapacity() const;
+    double getLoadFactor() const { return static_cast<double>(size()) / getCapacity(); }
+
+private:
+    // Each shard on its own cache lines so writers on neighbouring shards do
+    // not false-share mutexes or counters.
+    struct alignas(64) PaddedShard {
+        explicit PaddedShard(size_t capacity) : table(capacity) {}
+        Shard table;
+    };
+
+    std::vector<std::unique_ptr<PaddedShard>> shards_;
+    unsigned shard_bits_;
+    Hash hasher_;
+
+    Shard& shardFor(const Key& key) { return shards_[getShardIndex(key)]->table; }
+    const Shard& shardFor(const Key& key) const { return shards_[getShardIndex(key)]->table; }
+
+    // Stable counting sort of key indices by shard: order[offsets[s]..offsets[s+1])
+    // are the indices of keys belonging to shard s.
+    void groupByShard(const Key* keys, size_t n, std::vector<uint32_t>& order,
+                      std::vector<size_t>& offsets) const;
+};
+
+// ============================================================================
+// Template implementation
+// ============================================================================
+
+template <typename Key, typename Value, typename Hash>
+ShardedHashTable<Key, Value, Hash>::ShardedHashTable(size_t initial_size, size_t num_shards) : shard_bits_(0) {
+    while ((size_t{1} << shard_bits_) < num_shards) {
+        ++shard_bits_;
+    }
+    size_t shard_count = size_t{1} << shard_bits_;
+    size_t per_shard = initial_size / shard_count;
+    if (per_shard < 16) {
+        per_shard = 16; // Keep shards large enough to amortise growth
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.emplace_back(new PaddedShard(per_shard));
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ShardedHashTable<Key, Value, Hash>::groupByShard(const Key* keys, size_t n, std::vector<uint32_t>& order,
+                                                      std::vector<size_t>& offsets) const {
+    std::vector<uint32_t> shard_of(n);
+    offsets.assign(shards_.size() + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        shard_of[i] = static_cast<uint32_t>(getShardIndex(keys[i]));
+        ++offsets[shard_of[i] + 1];
+    }
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+    order.resize(n);
+    std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        order[cursor[shard_of[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void ShardedHashTable<Key, Value, Hash>::insertBatch(const Key* keys, const Value* values, size_t n) {
+    std::vector<uint32_t> order;
+    std::vector<size_t> offsets;
+    groupByShard(keys, n, order, offsets);
+
+    std::vector<Key> shard_keys;
+    std::vector<Value> shard_values;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+        shard_keys.clear();
+        shard_values.clear();
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+            shard_keys.push_back(keys[order[i]]);
+            shard_values.push_back(values[order[i]]);
+        }
+        shards_[s]->table.insertBatch(shard_keys.data(), shard_values.data(), shard_keys.size());
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ShardedHashTable<Key, Value, Hash>::removeBatch(const Key* keys, size_t n) {
+    std::vector<uint32_t> order;
+    std::vector<size_t> offsets;
+    groupByShard(keys, n, order, offsets);
+
+    size_t removed = 0;
+    std::vector<Key> shard_keys;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (offsets[s] == offsets[s + 1]) {
+            continue;
+        }
+        shard_keys.clear();
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i) {
+            shard_keys.push_back(keys[order[i]]);
+        }
+        removed += shards_[s]->table.removeBatch(shard_keys.data(), shard_keys.size());
+    }
+    return removed;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ShardedHashTable<Key, Value, Hash>::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->table.size();
+    }
+    return total;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t ShardedHashTable<Key, Value, Hash>::getCapacity() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->table.getCapacity();
+    }
+    return total;
+}
+
+// The string -> int table is explicitly instantiated in sharded_hash.cpp.
+extern template class ShardedHashTable<std::string, int>;
+
+#endif // SHARDED_HASH_TABLE_H
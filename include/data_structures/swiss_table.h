@@ -0,0 +1,332 @@
+#ifndef SWISS_TABLE_H
+#define SWISS_TABLE_H
+
+#include <string>
+#include <atomic>       // For std::atomic (published storage pointer)
+#include <memory>       // For std::unique_ptr
+#include <mutex>        // For the writer mutex
+#include <cstdint>      // For int8_t, uint32_t, uint64_t
+#include <cstddef>      // For size_t
+#include <cstring>      // For std::memset
+#include <type_traits>  // For std::is_trivially_copyable
+
+#if defined(__SSE2__)
+#include <emmintrin.h>  // SSE2 group probing
+#endif
+
+#include "data_structures/concurrent_hash.h" // For DefaultKeyHash
+#include "utils/threading.h"                 // For SeqLock, RcuUtils
+
+// --- Swiss-table style control bytes ---
+// Every slot has one control byte. Full slots hold 7 bits of the key's hash
+// (a "tag", 0..127); the special values below have the top bit set, so a
+// single sign-bit test separates "full" from "empty or deleted".
+namespace SwissControl {
+constexpr int8_t kEmpty = static_cast<int8_t>(0x80);
+constexpr int8_t kDeleted = static_cast<int8_t>(0xFE);
+constexpr size_t kGroupWidth = 16;
+
+// Bit i of the result is set when ctrl[i] matches. Group loads are aligned.
+#if defined(__SSE2__)
+inline uint32_t matchTag(const int8_t* ctrl, int8_t tag) {
+    __m128i group = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+}
+inline uint32_t matchEmpty(const int8_t* ctrl) {
+    return matchTag(ctrl, kEmpty);
+}
+inline uint32_t matchEmptyOrDeleted(const int8_t* ctrl) {
+    // movemask collects the sign bits, which are set exactly for kEmpty/kDeleted.
+    __m128i group = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(_mm_movemask_epi8(group));
+}
+#else
+inline uint32_t matchTag(const int8_t* ctrl, int8_t tag) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+        mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+    }
+    return mask;
+}
+inline uint32_t matchEmpty(const int8_t* ctrl) {
+    return matchTag(ctrl, kEmpty);
+}
+inline uint32_t matchEmptyOrDeleted(const int8_t* ctrl) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+        mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+    }
+    return mask;
+}
+#endif
+} // namespace SwissControl
+
+// Exact-match hash table with a Swiss-table layout: slots are arranged in
+// groups of 16, each group with 16 control bytes stored contiguously. A lookup
+// compares the key's 7-bit tag against a whole group with one SSE2 compare and
+// only touches key memory for slots whose tag matches, so a miss usually costs
+// one control-byte cache line and no key comparisons at all.
+//
+// Offers the same lookup/insert/remove API as ConcurrentHashTable. Writers are
+// serialised by a mutex; with trivially-copyable Key/Value, readers are
+// lock-free and validate against a SeqLock. Grown storage is published through
+// an atomic pointer and the previous arrays are reclaimed via RcuUtils::callRcu.
+template <typename Key = std::string, typename Value = int, typename Hash = DefaultKeyHash<Key>>
+class SwissHashTable {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+
+    // Grow once full + deleted slots exceed 7/8 of capacity.
+    static constexpr double kMaxLoadFactor = 0.875;
+
+    explicit SwissHashTable(size_t initial_size = 1024);
+    ~SwissHashTable();
+
+    SwissHashTable(const SwissHashTable&) = delete;
+    SwissHashTable& operator=(const SwissHashTable&) = delete;
+
+    // --- Core Functionality ---
+    bool lookup(const Key& key, Value& value) const;
+    void insert(const Key& key, const Value& value);
+    bool remove(const Key& key);
+
+    // --- Utility ---
+    size_t hashFunction(const Key& key) const { return hasher_(key); }
+    size_t size() const { return current_size_.load(std::memory_order_relaxed); }
+    size_t getCapacity() const { return storage_.load(std::memory_order_acquire)->capacity; }
+    double getLoadFactor() const { return static_cast<double>(size()) / getCapacity(); }
+
+private:
+    static constexpr bool kOptimisticReads =
+        std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value;
+
+    struct alignas(16) ControlGroup {
+        int8_t ctrl[SwissControl::kGroupWidth];
+    };
+
+    struct Slot {
+        Key key{};
+        Value value{};
+    };
+
+    struct Storage {
+        size_t capacity;   // Power of two, multiple of kGroupWidth
+        size_t group_mask; // Number of groups - 1
+        size_t deleted;    // Tombstones currently in the table
+        std::unique_ptr<ControlGroup[]> groups;
+        std::unique_ptr<Slot[]> slots;
+
+        explicit Storage(size_t cap)
+            : capacity(cap), group_mask(cap / SwissControl::kGroupWidth - 1), deleted(0),
+              groups(new ControlGroup[cap / SwissControl::kGroupWidth]), slots(new Slot[cap]) {
+            std::memset(groups.get(), static_cast<unsigned char>(SwissControl::kEmpty),
+                        sizeof(ControlGroup) * (cap / SwissControl::kGroupWidth));
+        }
+    };
+
+    std::atomic<Storage*> storage_;
+    std::atomic<size_t> current_size_;
+    Hash hasher_;
+
+    mutable std::mutex write_mutex_;
+    SeqLock seq_lock_;
+
+    // Spreads weak hashes (e.g. std::hash<int> is the identity) over all 64 bits.
+    static uint64_t mix(size_t hash) {
+        uint64_t m = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+        return m ^ (m >> 29);
+    }
+    static int8_t tagOf(uint64_t mixed) { return static_cast<int8_t>(mixed >> 57); } // Top 7 bits
+    static size_t groupOf(uint64_t mixed, const Storage& s) { return static_cast<size_t>(mixed) & s.group_mask; }
+
+    // Returns the slot index holding key, or s.capacity if absent.
+    size_t findSlot(const Storage& s, const Key& key, uint64_t mixed) const;
+    // First empty-or-deleted slot on key's probe sequence.
+    size_t findInsertSlot(const Storage& s, uint64_t mixed) const;
+    void rehashLocked(size_t new_capacity);
+    static void releaseStorage(Storage* s);
+};
+
+// ============================================================================
+// Template implementation
+// ============================================================================
+
+template <typename Key, typename Value, typename Hash>
+SwissHashTable<Key, Value, Hash>::SwissHashTable(size_t initial_size) : current_size_(0) {
+    size_t capacity = SwissControl::kGroupWidth;
+    while (capacity < initial_size) {
+        capacity <<= 1;
+    }
+    storage_.store(new Storage(capacity), std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Hash>
+SwissHashTable<Key, Value, Hash>::~SwissHashTable() {
+    delete storage_.load(std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t SwissHashTable<Key, Value, Hash>::findSlot(const Storage& s, const Key& key, uint64_t mixed) const {
+    const int8_t tag = tagOf(mixed);
+    size_t group = groupOf(mixed, s);
+    // Triangular probing over groups visits every group exactly once for a power-of-two count.
+    for (size_t step = 0; step <= s.group_mask; ++step) {
+        const int8_t* ctrl = s.groups[group].ctrl;
+        uint32_t candidates = SwissControl::matchTag(ctrl, tag);
+        while (candidates) {
+            size_t slot = group * SwissControl::kGroupWidth + static_cast<size_t>(__builtin_ctz(candidates));
+            if (s.slots[slot].key == key) {
+                return slot;
+            }
+            candidates &= candidates - 1;
+        }
+        if (SwissControl::matchEmpty(ctrl)) {
+            return s.capacity; // Probe sequences never continue past a group with an empty slot
+        }
+        group = (group + step + 1) & s.group_mask;
+    }
+    return s.capacity;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t SwissHashTable<Key, Value, Hash>::findInsertSlot(const Storage& s, uint64_t mixed) const {
+    size_t group = groupOf(mixed, s);
+    for (size_t step = 0; step <= s.group_mask; ++step) {
+        uint32_t free_slots = SwissControl::matchEmptyOrDeleted(s.groups[group].ctrl);
+        if (free_slots) {
+            return group * SwissControl::kGroupWidth + static_cast<size_t>(__builtin_ctz(free_slots));
+        }
+        group = (group + step + 1) & s.group_mask;
+    }
+    return s.capacity;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool SwissHashTable<Key, Value, Hash>::lookup(const Key& key, Value& value) const {
+    const uint64_t mixed = mix(hasher_(key));
+
+    if constexpr (kOptimisticReads) {
+        Value candidate{};
+        bool found;
+        uint64_t seq;
+        RcuUtils::rcuReadLock(); // Keeps a concurrently replaced Storage alive
+        do {
+            seq = seq_lock_.readBegin();
+            const Storage* s = storage_.load(std::memory_order_acquire);
+            size_t slot = findSlot(*s, key, mixed);
+            found = slot != s->capacity;
+            if (found) {
+                candidate = s->slots[slot].value;
+            }
+        } while (seq_lock_.readRetry(seq));
+        RcuUtils::rcuReadUnlock();
+        if (found) {
+            value = candidate;
+        }
+        return found;
+    } else {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        const Storage* s = storage_.load(std::memory_order_relaxed);
+        size_t slot = findSlot(*s, key, mixed);
+        if (slot == s->capacity) {
+            return false;
+        }
+        value = s->slots[slot].value;
+        return true;
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+void SwissHashTable<Key, Value, Hash>::insert(const Key& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const uint64_t mixed = mix(hasher_(key));
+    Storage* s = storage_.load(std::memory_order_relaxed);
+
+    size_t existing = findSlot(*s, key, mixed);
+    if (existing != s->capacity) {
+        SeqLockWriteGuard seq_guard(seq_lock_);
+        s->slots[existing].value = value;
+        return;
+    }
+
+    size_t used = current_size_.load(std::memory_order_relaxed) + s->deleted;
+    if (used + 1 > s->capacity * kMaxLoadFactor) {
+        // Mostly tombstones: rehash in place to reclaim them; otherwise grow.
+        size_t live = current_size_.load(std::memory_order_relaxed);
+        rehashLocked(live + 1 <= s->capacity * kMaxLoadFactor / 2 ? s->capacity : s->capacity * 2);
+        s = storage_.load(std::memory_order_relaxed);
+    }
+
+    size_t slot = findInsertSlot(*s, mixed);
+    SeqLockWriteGuard seq_guard(seq_lock_);
+    int8_t& ctrl = s->groups[slot / SwissControl::kGroupWidth].ctrl[slot % SwissControl::kGroupWidth];
+    if (ctrl == SwissControl::kDeleted) {
+        --s->deleted;
+    }
+    s->slots[slot].key = key;
+    s->slots[slot].value = value;
+    ctrl = tagOf(mixed);
+    current_size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Hash>
+bool SwissHashTable<Key, Value, Hash>::remove(const Key& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Storage* s = storage_.load(std::memory_order_relaxed);
+    size_t slot = findSlot(*s, key, mix(hasher_(key)));
+    if (slot == s->capacity) {
+        return false;
+    }
+
+    SeqLockWriteGuard seq_guard(seq_lock_);
+    int8_t* ctrl = s->groups[slot / SwissControl::kGroupWidth].ctrl;
+    // A group that still has an empty slot has never been full, so no probe
+    // sequence continues past it and the slot can go straight back to empty.
+    if (SwissControl::matchEmpty(ctrl)) {
+        ctrl[slot % SwissControl::kGroupWidth] = SwissControl::kEmpty;
+    } else {
+        ctrl[slot % SwissControl::kGroupWidth] = SwissControl::kDeleted;
+        ++s->deleted;
+    }
+    s->slots[slot] = Slot{}; // Release resources held by the key/value (e.g. strings)
+    current_size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+void SwissHashTable<Key, Value, Hash>::rehashLocked(size_t new_capacity) {
+    Storage* old_storage = storage_.load(std::memory_order_relaxed);
+    Storage* new_storage = new Storage(new_capacity);
+
+    for (size_t i = 0; i < old_storage->capacity; ++i) {
+        if (old_storage->groups[i / SwissControl::kGroupWidth].ctrl[i % SwissControl::kGroupWidth] < 0) {
+            continue; // Empty or deleted
+        }
+        const uint64_t mixed = mix(hasher_(old_storage->slots[i].key));
+        size_t slot = findInsertSlot(*new_storage, mixed);
+        new_storage->slots[slot] = old_storage->slots[i];
+        new_storage->groups[slot / SwissControl::kGroupWidth].ctrl[slot % SwissControl::kGroupWidth] = tagOf(mixed);
+    }
+
+    {
+        SeqLockWriteGuard seq_guard(seq_lock_);
+        storage_.store(new_storage, std::memory_order_release);
+    }
+    releaseStorage(old_storage);
+}
+
+template <typename Key, typename Value, typename Hash>
+void SwissHashTable<Key, Value, Hash>::releaseStorage(Storage* s) {
+    if constexpr (kOptimisticReads) {
+        // Lock-free readers may still be probing the old arrays.
+        RcuUtils::callRcu([s]() { delete s; });
+    } else {
+        delete s; // Readers hold write_mutex_, so nobody can still see it.
+    }
+}
+
+// The string -> int table is explicitly instantiated in swiss_table.cpp.
+extern template class SwissHashTable<std::string, int>;
+
+#endif // SWISS_TABLE_H
@@ -6,18 +6,25 @@
 #include <cstdint> // For uint32_t, uint16_t etc.
 #include <map>
 #include <memory> // For std::shared_ptr, std::unique_ptr
+#include <atomic>
+#include <unordered_map>
 
 // Include Phase 1 Data Structures
 #include "data_structures/compressed_trie.h"
 #include "data_structures/concurrent_hash.h"
 #include "data_structures/interval_tree.h"
 #include "data_structures/bloom_filter.h"
+#include "data_structures/counting_bloom_filter.h"
+#include "data_structures/flow_table.h"
+#include "data_structures/rule_prefilter.h"
+#include "data_structures/rotating_bloom_filter.h"
 
 // Include Phase 1 Utilities
 #include "utils/memory_pool.h"
 #include "utils/logging.h"
-#include "utils/threading.h" // For ReadWriteLock
+#include "utils/threading.h" // For ReadWriteLock, BigReaderLock, WorkStealingThreadPool
 #include "utils/rule_manager.h" // For RuleManager
+#include "utils/ip_utils.h"     // For PacketFilter's prefix checks
 
 // --- Core Data Structures from docs/requirement_design.md ---
 
@@ -28,14 +35,18 @@ struct PacketHeader {
     uint16_t source_port;
     uint16_t dest_port;
     uint8_t protocol; // e.g., TCP, UDP, ICMP
+    uint32_t packet_length; // Bytes on the wire; only used for per-flow byte counters
+    uint8_t tcp_flags;      // TcpFlags bits for TCP packets; drives connection tracking
     // Potentially other fields like MAC addresses, VLAN tags, etc.
     // For simplicity, keeping it IP/port focused for now.
     // std::string source_mac;
     // std::string dest_mac;
 
     // Constructor (example)
-    PacketHeader(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint8_t proto)
-        : source_ip(sip), dest_ip(dip), source_port(sport), dest_port(dport), protocol(proto) {}
+    PacketHeader(uint32_t sip, uint32_t dip, uint16_t sport, uint16_t dport, uint8_t proto, uint32_t length = 0,
+                 uint8_t flags = 0)
+        : source_ip(sip), dest_ip(dip), source_port(sport), dest_port(dport), protocol(proto), packet_length(length),
+          tcp_flags(flags) {}
     
     // For hashing or using as key in maps if needed (though classification uses individual fields)
     std::string toString() const; // For logging or debugging
@@ -54,13 +65,31 @@ struct PacketFilter {
     // For exact protocol match
     uint8_t protocol = 0; // 0 means any protocol
 
+    // Connection-state match (ConnStateMask bits, e.g. ESTABLISHED | RELATED).
+    // 0 means any state. A non-zero mask only matches packets classified with
+    // connection tracking enabled.
+    uint8_t conn_state_mask = 0;
+
     // Default constructor for "any" filter
     PacketFilter() = default;
 
-    // Basic matching logic. More advanced prefix/range matching will be handled
-    // by specialized data structures in PacketClassifier.
-    // This method provides a straightforward filter check.
+    // False if either IP prefix is non-empty but not a valid "a.b.c.d[/len]".
+    // RuleManager rejects such rules rather than let a typo match every address.
+    bool hasValidPrefixes() const;
+
+    // Straightforward check of every field against the packet. PacketClassifier
+    // uses it as the final validation after its pre-filters.
     inline bool matches(const PacketHeader& header) const {
+        return matches(header, ConnState::UNTRACKED);
+    }
+
+    // As above, for a packet whose connection state is known.
+    inline bool matches(const PacketHeader& header, ConnState state) const {
+        // Connection state check
+        if (conn_state_mask != 0 && (conn_state_mask & ConnStateMask::of(state)) == 0) {
+            return false;
+        }
+
         // Protocol check
         if (protocol != 0 && protocol != header.protocol) {
             return false;
@@ -80,34 +109,55 @@ struct PacketFilter {
             }
         }
 
-        // IP Address checks - Simplified for this direct match function.
-        // Trie-based prefix matching is the primary mechanism in PacketClassifier.
-        // This direct check might be useful for rules that specify exact IPs without prefixes,
-        // or if used in a context before Trie lookup.
-        // If prefixes are present, this basic check should ideally not be the sole validator.
-        // For now, if a prefix is set, we assume the Trie will handle it, so this function might
-        // return true here, or we could implement a very basic exact match if no prefix "/" is found.
-
-        // Example: Simple exact IP match if no prefix is indicated by typical means (e.g. no "/" in string)
-        // This is highly simplified. Proper IP parsing and comparison are needed.
-        if (!source_ip_prefix.empty()) {
-            // If source_ip_prefix is something like "1.2.3.4" (exact) and header.source_ip needs conversion
-            // This part is complex to implement correctly here without proper IP parsing utilities.
-            // For skeleton: Assume if source_ip_prefix is set, it's handled by Trie.
-            // So, for PacketFilter::matches, we don't return false based on IP if prefixes are involved.
-            // If it were an exact IP, we would compare.
-            // For now, we'll skip IP matching here and assume specialized structures do it.
+        // IP prefix checks. An empty prefix means any address (rules with
+        // unparseable prefixes are rejected when added, see hasValidPrefixes()).
+        if (!source_ip_prefix.empty() && !IpUtils::matchesPrefixText(source_ip_prefix, header.source_ip)) {
+            return false;
         }
-        if (!dest_ip_prefix.empty()) {
-            // Similarly, assume Trie handles this.
+        if (!dest_ip_prefix.empty() && !IpUtils::matchesPrefixText(dest_ip_prefix, header.dest_ip)) {
+            return false;
         }
 
-        return true; // If all checks passed or were deferred to specialized structures
+        return true; // All checks passed
     }
 
     std::string toString() const; // For logging or debugging
 };
 
+// A PacketFilter with its IP prefixes parsed into network/mask pairs, as
+// stored in CompiledRuleSet so that classify() never parses prefix text. An
+// empty prefix compiles to mask 0, which every address matches.
+struct CompiledFilter {
+    uint32_t source_network = 0, source_mask = 0;
+    uint32_t dest_network = 0, dest_mask = 0;
+    uint16_t source_port_low = 0, source_port_high = 0;
+    uint16_t dest_port_low = 0, dest_port_high = 0;
+    uint8_t protocol = 0;
+    uint8_t conn_state_mask = 0;
+
+    CompiledFilter() = default;
+    explicit CompiledFilter(const PacketFilter& filter);
+
+    // Same semantics as PacketFilter::matches().
+    inline bool matches(const PacketHeader& header, ConnState state) const {
+        if (conn_state_mask != 0 && (conn_state_mask & ConnStateMask::of(state)) == 0) {
+            return false;
+        }
+        if (protocol != 0 && protocol != header.protocol) {
+            return false;
+        }
+        if ((source_port_low != 0 || source_port_high != 0) &&
+            (header.source_port < source_port_low || header.source_port > source_port_high)) {
+            return false;
+        }
+        if ((dest_port_low != 0 || dest_port_high != 0) &&
+            (header.dest_port < dest_port_low || header.dest_port > dest_port_high)) {
+            return false;
+        }
+        return (header.source_ip & source_mask) == source_network && (header.dest_ip & dest_mask) == dest_network;
+    }
+};
+
 // Actions to be taken if a packet matches a rule
 struct ActionList {
     enum class ActionType {
@@ -154,6 +204,44 @@ struct ClassificationResult {
     std::string toString() const; // For logging or debugging
 };
 
+// Per-rule match counters. classify() bumps them without taking any lock;
+// every CompiledRuleSet containing the rule shares the same instance, so
+// counts carry over when the rule set is recompiled.
+struct RuleCounters {
+    std::atomic<uint64_t> match_count{0};
+    std::atomic<uint64_t> last_match_time{0}; // Seconds since the epoch
+};
+
+// Immutable snapshot of everything classify() reads: the enabled rules in
+// priority order and the data-plane half of a pre-filter built from exactly
+// those rules.
+// PacketClassifier compiles a new one after every rule change and publishes
+// it with one atomic pointer swap. Readers load it inside an RCU read-side
+// section and the replaced snapshot is reclaimed via RcuUtils::callRcu, so a
+// rule deleted mid-classification stays valid until the reader is done.
+struct CompiledRuleSet {
+    // Compiled once per rule change and copied into each snapshot; the
+    // actions and counters are shared between snapshots.
+    struct Entry {
+        int rule_id;
+        int priority;
+        CompiledFilter filter;
+        std::shared_ptr<const ActionList> actions;
+        std::shared_ptr<RuleCounters> counters;
+    };
+
+    std::vector<Entry> rules;                     // Enabled rules, highest priority first
+    std::unordered_map<int, size_t> index_by_id;  // rule_id -> position in rules
+    std::shared_ptr<const CompiledPrefilter> prefilter; // Null when the optimisation is disabled
+    uint64_t version = 0;                         // Incremented on every publish
+
+    // Enabled rule with this ID, or nullptr (deleted or disabled).
+    const Entry* findRule(int rule_id) const {
+        auto it = index_by_id.find(rule_id);
+        return it == index_by_id.end() ? nullptr : &rules[it->second];
+    }
+};
+
 // --- PacketClassifier Class ---
 class PacketClassifier {
 public:
@@ -163,6 +251,9 @@ public:
     // --- Rule Management API ---
     // Returns true on success, false on failure (e.g., rule_id exists, invalid rule)
     bool addRule(const ClassificationRule& rule);
+    // Bulk load: adds every rule that addRule() would accept, publishing one
+    // new rule set at the end. Returns the number of rules added.
+    size_t addRules(const std::vector<ClassificationRule>& rules);
     bool deleteRule(int rule_id);
     bool modifyRule(int rule_id, const ClassificationRule& new_rule_content); // Can modify filter, actions, priority, enabled status
 
@@ -170,6 +261,46 @@ public:
     ClassificationResult classify(const PacketHeader& header);
     std::vector<ClassificationResult> classifyBatch(const std::vector<PacketHeader>& headers);
 
+    // Opt-in: classifyBatch() splits batches of at least kParallelBatchThreshold
+    // packets across a work-stealing pool of num_threads workers (0 means
+    // hardware_concurrency). Results keep the input order. Not synchronised
+    // with classifyBatch(); enable before classifying packets.
+    static constexpr size_t kParallelBatchThreshold = 256;
+    void enableParallelBatch(size_t num_threads = 0);
+    bool isParallelBatchEnabled() const { return batch_pool_ != nullptr; }
+
+    // --- Flow Cache API ---
+    // Opt-in stateful flow table: classify() then tracks each 5-tuple's
+    // packet/byte counters and caches the matched rule per flow, so later
+    // packets of a flow skip rule evaluation until the rule set changes.
+    // With config.conntrack set, both directions of a session share one entry
+    // and each packet's connection state is matched against
+    // PacketFilter::conn_state_mask. Flows age out only when expireFlows() is called.
+    void enableFlowCache(const FlowTable::Config& config = FlowTable::Config());
+    bool isFlowCacheEnabled() const { return flow_table_ != nullptr; }
+    const FlowTable* getFlowTable() const { return flow_table_.get(); }
+    size_t expireFlows(uint64_t now_ms, std::vector<FlowTable::ExpiredFlow>* expired = nullptr);
+    size_t expireFlows(); // Uses the same steady clock as classify()
+    static uint64_t flowClockMs();
+
+    // --- Miss Cache API ---
+    // Opt-in negative cache of flows that recently matched no rule: a
+    // time-decaying, self-sizing Bloom filter keyed by 5-tuple, so repeat
+    // misses (e.g. scan traffic) skip classification for a few slices. Bloom
+    // false positives make a matching packet report no match, at roughly
+    // config.false_positive_prob per generation. Cleared on every rule change.
+    // Not used while the flow cache is enabled, which caches misses exactly.
+    void enableMissCache(const RotatingBloomFilter::Config& config = RotatingBloomFilter::Config());
+    bool isMissCacheEnabled() const { return miss_cache_ != nullptr; }
+    const RotatingBloomFilter* getMissCache() const { return miss_cache_.get(); }
+
+    // Per-field rule pre-filter (null when the Bloom filter optimisation is disabled).
+    const RulePrefilter* getRulePrefilter() const { return rule_prefilter_.get(); }
+
+    // Version of the currently published CompiledRuleSet; changes on every
+    // successful rule add, delete or modify.
+    uint64_t getRuleSetVersion() const;
+
     // --- Statistics API ---
     std::map<int, uint64_t> getStatistics() const; // Returns map of rule_id to match_count
     uint64_t getRuleStatistics(int rule_id) const;
@@ -191,14 +322,15 @@ private:
     std::unique_ptr<CompressedTrie> dest_ip_trie_;      // For destination IP prefix matching
     
     // For exact matches (e.g., full IP, MAC, or specific protocol if not handled by other means)
-    // std::unique_ptr<ConcurrentHashTable> exact_match_table_; // Example if needed
+    // std::unique_ptr<ConcurrentHashTable<>> exact_match_table_; // Example if needed
 
     // For range matches (e.g., port numbers)
     std::unique_ptr<IntervalTree> source_port_tree_;    // For source port range matching
     std::unique_ptr<IntervalTree> dest_port_tree_;      // For destination port range matching
 
-    // Optional: Bloom filter for fast rejection of non-matching packets
-    std::unique_ptr<BloomFilter> bloom_filter_;
+    // Optional: per-field pre-filters over the values enabled rules
+    // reference, so packets no rule can match skip rule evaluation entirely.
+    std::unique_ptr<RulePrefilter> rule_prefilter_;
     bool use_bloom_filter_;
 
     // For managing memory for rule objects or other internal structures if not using standard containers directly
@@ -207,18 +339,64 @@ private:
     // Rule manager instance
     std::unique_ptr<RuleManager> rule_manager_;
 
+    // Per-flow state and rule cache (null unless enableFlowCache() was called)
+    std::unique_ptr<FlowTable> flow_table_;
+
+    // Recent-miss cache (null unless enableMissCache() was called). Queries
+    // and inserts are lock-free and take miss_cache_lock_ for reading;
+    // rotation and clearing take it for writing. It is a BigReaderLock so
+    // that concurrent classify() calls do not all hit one lock word. A miss is only cached if no rule change
+    // happened while it was computed (miss_cache_generation_ unchanged).
+    std::unique_ptr<RotatingBloomFilter> miss_cache_;
+    BigReaderLock miss_cache_lock_;
+    std::atomic<uint64_t> miss_cache_generation_{0};
+
+    // Workers for parallel classifyBatch() (null unless enableParallelBatch() was called)
+    std::unique_ptr<RcuUtils::WorkStealingThreadPool> batch_pool_;
+
+    // Snapshot classify() reads (never null). Replaced only under
+    // specialized_structures_lock_; see CompiledRuleSet.
+    std::atomic<const CompiledRuleSet*> rule_set_;
+
+    // Match counters of every rule in RuleManager, keyed by rule ID.
+    // Guarded by specialized_structures_lock_; the counters themselves are atomic.
+    std::unordered_map<int, std::shared_ptr<RuleCounters>> rule_counters_;
+
+    // Compiled form of every rule in RuleManager, enabled or not, keyed by
+    // rule ID. publishRuleSet() copies the enabled ones into each snapshot.
+    // Guarded by specialized_structures_lock_.
+    std::unordered_map<int, CompiledRuleSet::Entry> compiled_rules_;
+
     // Logger instance
     Logger& logger_;
     
-    // Lock for protecting specialized data structures (Tries, IntervalTrees) 
-    // during updates by PacketClassifier itself. RuleManager has its own internal lock.
-    ReadWriteLock specialized_structures_lock_;
+    // Serialises rule changes: RuleManager updates, the specialized data
+    // structures (Tries, IntervalTrees, pre-filter) and publishing the next
+    // CompiledRuleSet. classify() never takes it. Mutable for the statistics getters.
+    mutable ReadWriteLock specialized_structures_lock_;
 
     // --- Private Helper Methods ---
     // These methods will now operate on rule data obtained from the RuleManager.
-    // They are responsible for updating the Tries, IntervalTrees, BloomFilter based on rule changes.
+    // They are responsible for updating the Tries, IntervalTrees, rule pre-filter based on rule changes.
     bool updateSpecializedStructuresForRule(const ClassificationRule& rule); // Called on add or modify
-    bool removeRuleFromSpecializedStructures(int rule_id); // Called on delete
+    bool removeRuleFromSpecializedStructures(const ClassificationRule& rule); // Called on delete, and on modify with the old rule
+    void compileRule(const ClassificationRule& rule); // Refreshes compiled_rules_; caller holds specialized_structures_lock_
+    void publishRuleSet(); // Compiles and swaps in a new CompiledRuleSet; caller holds specialized_structures_lock_
+    void invalidateFlowCache(); // Called after any rule change is published; also clears the miss cache
+    // Flow and miss cache generations, read by classify() before it loads the snapshot.
+    struct CacheGenerations {
+        uint32_t flow = 0;
+        uint64_t miss = 0;
+    };
+    ClassificationResult classifySnapshot(const CompiledRuleSet& rules, const PacketHeader& header,
+                                          const CacheGenerations& generations);
+    ClassificationResult classifyWithMissCache(const CompiledRuleSet& rules, const PacketHeader& header,
+                                               uint64_t generation);
+    ClassificationResult classifyUncached(const CompiledRuleSet& rules, const PacketHeader& header,
+                                          ConnState state = ConnState::UNTRACKED);
+    bool rejectedByPrefilter(const CompiledRuleSet& rules, const PacketHeader& header) const;
+    ClassificationResult matchRules(const CompiledRuleSet& rules, const PacketHeader& header, ConnState state);
+    ClassificationResult recordMatch(const CompiledRuleSet::Entry& rule);
 
     // Helper to convert string IP prefix to a format usable by CompressedTrie (e.g., bit string or uint/mask)
     // These are placeholders for actual IP parsing logic.
@@ -0,0 +1,154 @@
+#ifndef HASHING_UTILS_H
+#define HASHING_UTILS_H
+
+#include <cstdint>  // For uint8_t, uint32_t, uint64_t
+#include <cstddef>  // For size_t
+#include <cstring>  // For std::memcpy
+#include <vector>
+
+// --- Packet-key hashing ---
+// Fast non-cryptographic hashes for exact-match tables, Bloom filters and flow
+// caches. Nothing here allocates or copies the key.
+//
+//  - wyhash:   general-purpose 64-bit hash; inline so that fixed-size keys
+//              (5-tuples, MACs) compile down to a handful of multiplies.
+//  - crc32c:   Castagnoli CRC, using the SSE4.2 crc32 instruction when the CPU
+//              has it (checked once at runtime) and a table otherwise.
+//  - Toeplitz: the RSS hash NICs use to spread flows over queues, so software
+//              can predict or reproduce hardware queue selection.
+//  - murmur3:  MurmurHash3_x86_32. Its 32-bit lane arithmetic vectorises, so the
+//              batch versions hash 8 fixed-size keys per AVX2 step.
+namespace HashUtils {
+
+// Byte sizes of the fixed-format keys used by the classifier.
+constexpr size_t kFiveTupleKeySize = 13; // src ip, dst ip, src port, dst port, protocol
+constexpr size_t kMacKeySize = 6;
+
+namespace detail {
+inline uint64_t load64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+inline uint64_t load32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+inline uint64_t load3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+inline void mum(uint64_t& a, uint64_t& b) {
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+}
+inline uint64_t mix(uint64_t a, uint64_t b) { mum(a, b); return a ^ b; }
+
+constexpr uint64_t kWySecret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                   0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+} // namespace detail
+
+// wyhash (final version 4 algorithm with the default secret).
+inline uint64_t wyhash(const void* data, size_t len, uint64_t seed = 0) {
+    using namespace detail;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= mix(seed ^ kWySecret[0], kWySecret[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (load32(p) << 32) | load32(p + ((len >> 3) << 2));
+            b = (load32(p + len - 4) << 32) | load32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = load3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mix(load64(p) ^ kWySecret[1], load64(p + 8) ^ seed);
+                see1 = mix(load64(p + 16) ^ kWySecret[2], load64(p + 24) ^ see1);
+                see2 = mix(load64(p + 32) ^ kWySecret[3], load64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mix(load64(p) ^ kWySecret[1], load64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = load64(p + i - 16);
+        b = load64(p + i - 8);
+    }
+    a ^= kWySecret[1];
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ kWySecret[0] ^ len, b ^ kWySecret[1]);
+}
+
+// Fixed-size keys: identical to wyhash(key, size, seed), with the length known
+// at compile time so all branches fold away.
+inline uint64_t hashFiveTuple(const void* key, uint64_t seed = 0) { return wyhash(key, kFiveTupleKeySize, seed); }
+inline uint64_t hashMac(const void* key, uint64_t seed = 0) { return wyhash(key, kMacKeySize, seed); }
+
+// --- Integer keys ---
+// MurmurHash3's 64-bit finaliser: a bijective mix of one 64-bit key. Only
+// shifts, XORs and 64-bit multiplies, so SIMD code can compute it lane-wise
+// (see BloomFilter::possiblyContainsBatch).
+constexpr uint64_t kMix64C1 = 0xff51afd7ed558ccdULL;
+constexpr uint64_t kMix64C2 = 0xc4ceb9fe1a85ec53ULL;
+
+inline uint64_t mix64(uint64_t key) {
+    key ^= key >> 33;
+    key *= kMix64C1;
+    key ^= key >> 33;
+    key *= kMix64C2;
+    key ^= key >> 33;
+    return key;
+}
+
+// --- CRC32C ---
+// Standard CRC-32C (crc32c("123456789") == 0xE3069283). Passing a previous
+// result as 'crc' continues the checksum over concatenated data.
+uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0);
+uint32_t crc32cSoftware(const void* data, size_t len, uint32_t crc = 0);
+bool hasHardwareCrc32c();
+
+// --- Toeplitz (RSS) ---
+// The 40-byte default RSS key from the Microsoft RSS specification.
+extern const uint8_t kDefaultRssKey[40];
+
+// Bit-serial reference implementation. Input must be at most key_len - 4 bytes.
+uint32_t toeplitz(const uint8_t* data, size_t len, const uint8_t* key = kDefaultRssKey, size_t key_len = 40);
+
+// Table-driven Toeplitz: one 256-entry table per input byte position, so a hash
+// is one lookup and XOR per byte.
+class ToeplitzHasher {
+public:
+    explicit ToeplitzHasher(const uint8_t* key = kDefaultRssKey, size_t key_len = 40);
+
+    uint32_t hash(const uint8_t* data, size_t len) const;
+    // RSS input for TCP/UDP over IPv4: addresses and ports in network byte
+    // order. Arguments are in host byte order.
+    uint32_t hashIPv4Tuple(uint32_t source_ip, uint32_t dest_ip, uint16_t source_port, uint16_t dest_port) const;
+    uint32_t hashIPv4(uint32_t source_ip, uint32_t dest_ip) const;
+
+    size_t getMaxInputLength() const { return max_input_len_; }
+
+private:
+    size_t max_input_len_;
+    std::vector<uint32_t> table_; // [byte position * 256 + byte value]
+};
+
+// --- MurmurHash3_x86_32 ---
+uint32_t murmur3(const void* data, size_t len, uint32_t seed = 0);
+
+// Batch hashing of n contiguous fixed-size keys (13-byte 5-tuples / 6-byte
+// MACs). out[i] == murmur3(key i, size, seed). Uses AVX2 eight keys at a time
+// when available, scalar code otherwise and for the remainder.
+void murmur3FiveTupleBatch(const void* keys, size_t n, uint32_t* out, uint32_t seed = 0);
+void murmur3MacBatch(const void* keys, size_t n, uint32_t* out, uint32_t seed = 0);
+bool hasAvx2();
+bool hasAvx512(); // AVX-512F and AVX-512DQ (64-bit lane multiplies)
+
+} // namespace HashUtils
+
+#endif // HASHING_UTILS_H
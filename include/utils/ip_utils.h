@@ -0,0 +1,36 @@
+#ifndef IP_UTILS_H
+#define IP_UTILS_H
+
+#include <string>
+#include <cstdint> // For uint8_t, uint32_t
+
+// --- IPv4 address and prefix helpers ---
+// Addresses are uint32_t in host byte order, as in PacketHeader
+// ("192.168.1.1" == 0xC0A80101).
+namespace IpUtils {
+
+// Parses a dotted-quad address. Rejects anything else (no whitespace,
+// no octal/hex forms, exactly four octets 0-255).
+bool parseIPv4Address(const std::string& text, uint32_t& address);
+
+// Parses "a.b.c.d/len" or a bare "a.b.c.d" (= /32). The returned network has
+// its host bits cleared, so "10.1.2.3/8" yields 10.0.0.0/8.
+bool parseIPv4Prefix(const std::string& text, uint32_t& network, uint8_t& length);
+
+std::string formatIPv4(uint32_t address);
+
+inline uint32_t prefixMask(uint8_t length) {
+    return length == 0 ? 0 : (length >= 32 ? 0xFFFFFFFFu : ~((uint32_t{1} << (32 - length)) - 1));
+}
+
+inline bool prefixContains(uint32_t network, uint8_t length, uint32_t address) {
+    return (address & prefixMask(length)) == network;
+}
+
+// True if 'address' falls inside the prefix written in 'prefix_text'.
+// An empty or unparseable prefix places no restriction (returns true).
+bool matchesPrefixText(const std::string& prefix_text, uint32_t address);
+
+} // namespace IpUtils
+
+#endif // IP_UTILS_H
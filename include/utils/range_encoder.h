@@ -0,0 +1,112 @@
+#ifndef RANGE_ENCODER_H
+#define RANGE_ENCODER_H
+
+#include <vector>
+#include <string>
+#include <cstdint> // For uint16_t, uint32_t
+#include <cstddef> // For size_t
+#include <utility> // For std::pair
+
+struct PacketFilter; // Forward declaration from packet_classifier.h
+
+// --- Range Encoding for Prefix/Ternary Engines ---
+// Engines that only understand prefixes (tries, tuple space) or value/mask
+// pairs (TCAM-style ternary tables) cannot express an arbitrary port range
+// such as [1024, 65535] directly. This layer rewrites a 16-bit range into a
+// set of ternary entries whose union is exactly that range.
+//
+// Two encodings are supported:
+//   - PREFIX: classic range-to-prefix expansion over the binary port value.
+//             Worst case is 2W-2 = 30 entries for a 16-bit field.
+//   - SRGE:   Short Range Gray Encoding. The lookup key is the binary-reflected
+//             Gray code of the port. Because the two halves of any aligned block
+//             are mirror images under Gray coding, a block and its reflection
+//             collapse into a single entry with one extra don't-care bit.
+//             Worst case is 2W-4 entries, and never worse than PREFIX.
+//
+// A packet's port must be converted with encodeKey() using the same encoding
+// before being matched against the entries.
+
+enum class PortEncoding {
+    PREFIX, // Key is the raw port, entries are prefixes
+    SRGE    // Key is gray(port), entries are general ternary masks
+};
+
+// A single ternary match entry over a 16-bit field.
+// A key matches when (key & mask) == value. value is always pre-masked.
+struct TernaryPortEntry {
+    uint16_t value = 0;
+    uint16_t mask = 0; // 0 is a full wildcard
+
+    TernaryPortEntry() = default;
+    TernaryPortEntry(uint16_t v, uint16_t m) : value(static_cast<uint16_t>(v & m)), mask(m) {}
+
+    inline bool matches(uint16_t encoded_key) const {
+        return (encoded_key & mask) == value;
+    }
+
+    // True if the cared bits form a contiguous run starting at the MSB.
+    bool isPrefix() const;
+    // Length of the prefix if isPrefix(), -1 otherwise.
+    int prefixLength() const;
+
+    bool operator==(const TernaryPortEntry& other) const {
+        return value == other.value && mask == other.mask;
+    }
+
+    // MSB-first string of '0', '1' and '*' (e.g. "000001**********").
+    std::string toString() const;
+};
+
+// Result of encoding both port fields of a PacketFilter.
+// An empty entry list means the field can never match (e.g. low > high).
+struct EncodedPortFilter {
+    PortEncoding encoding = PortEncoding::PREFIX;
+    std::vector<TernaryPortEntry> source_ports;
+    std::vector<TernaryPortEntry> dest_ports;
+
+    // Number of (source, dest) entry combinations a ternary/tuple engine has to
+    // install for this rule. 1 means no expansion.
+    size_t expansionFactor() const { return source_ports.size() * dest_ports.size(); }
+
+    // Reference matcher over raw (unencoded) ports, mainly for validation.
+    bool matches(uint16_t source_port, uint16_t dest_port) const;
+};
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(PortEncoding encoding = PortEncoding::SRGE);
+
+    PortEncoding getEncoding() const { return encoding_; }
+
+    // Encodes [low, high] using this encoder's encoding.
+    std::vector<TernaryPortEntry> encodeRange(uint16_t low, uint16_t high) const;
+
+    // Encodes the source/destination port ranges of a filter.
+    // A filter range of 0-0 is treated as "any" (single wildcard entry),
+    // matching PacketFilter::matches() semantics.
+    EncodedPortFilter encode(const PacketFilter& filter) const;
+
+    // Converts a packet's port into the key domain of the given encoding.
+    static inline uint16_t encodeKey(uint16_t port, PortEncoding encoding) {
+        return encoding == PortEncoding::SRGE ? toGray(port) : port;
+    }
+    static inline uint16_t toGray(uint16_t v) { return static_cast<uint16_t>(v ^ (v >> 1)); }
+
+    // --- Individual encodings ---
+    // Minimal prefix cover of [low, high] over binary keys.
+    static std::vector<TernaryPortEntry> rangeToPrefixes(uint16_t low, uint16_t high);
+    // SRGE cover of [low, high] over Gray-coded keys.
+    static std::vector<TernaryPortEntry> rangeToSrge(uint16_t low, uint16_t high);
+
+private:
+    PortEncoding encoding_;
+
+    // Helpers operate on uint32_t so that 65535 + 1 does not wrap.
+    static void appendPrefixBlocks(uint32_t low, uint32_t high,
+                                   std::vector<std::pair<uint32_t, uint32_t>>& blocks);
+    static void srgeRecursive(uint32_t low, uint32_t high, std::vector<TernaryPortEntry>& out);
+    static TernaryPortEntry grayBlockEntry(uint32_t block_start, uint32_t block_size, uint32_t extra_wildcard_mask);
+};
+
+#endif // RANGE_ENCODER_H
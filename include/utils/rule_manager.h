@@ -20,6 +20,9 @@ public:
 
     // Rule Management API
     bool addRule(const ClassificationRule& rule);
+    // Adds each rule addRule() would accept and rebuilds the priority order
+    // once. Returns the IDs that were added, in input order.
+    std::vector<int> addRules(const std::vector<ClassificationRule>& rules);
     bool deleteRule(int rule_id); // Changed from uint32_t to int to match ClassificationRule::rule_id
     bool modifyRule(int rule_id, const ClassificationRule& new_rule_data);
 
@@ -29,7 +32,9 @@ public:
     const ClassificationRule* getRule(int rule_id) const; 
     
     // Returns a list of const pointers to rules, sorted by priority.
-    // The list itself is a copy of pointers, providing a snapshot.
+    // Only the list is a copy: the pointers (like getRule()'s) dangle once a
+    // writer deletes the rule, so callers must exclude concurrent changes.
+    // PacketClassifier copies them into a CompiledRuleSet under its own lock.
     std::vector<const ClassificationRule*> getRulesByPriority() const;
 
     // Statistics Management (to be called by PacketClassifier or other relevant modules)
@@ -57,6 +62,7 @@ private:
     // Rebuilds rules_by_priority_cache_ from rules_by_id_
     void rebuildPriorityCache();
     bool detectConflict_nolock(const ClassificationRule& rule) const;
+    bool addRule_nolock(const ClassificationRule& rule); // Does not rebuild the priority cache
 
     mutable ReadWriteLock rw_lock_; // Protects rules_by_id_ and rules_by_priority_cache_
     Logger& logger_;
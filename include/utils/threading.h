@@ -7,6 +7,11 @@
 #include <thread> // For std::this_thread::yield, std::thread::hardware_concurrency
 #include <vector>
 #include <functional> // For std::function
+#include <future>     // For WorkStealingThreadPool::submit
+#include <cstdint>    // For uint64_t
+#include <memory>     // For std::unique_ptr
+
+#include "utils/memory_pool.h" // For HazardPointerDomain::retireToPool
 
 // --- Basic Read-Write Lock ---
 // This is a classic RW lock implementation.
@@ -67,96 +72,467 @@ private:
 };
 
 
+// --- Big-Reader Lock ---
+// Reader-biased lock for read-mostly data on hot paths (brlock). Readers
+// count themselves in one of several cache-line-padded slots, picked per
+// thread, so concurrent readers on different cores never write a shared
+// line. A writer raises a flag and waits for every slot to drain, so writes
+// cost O(slots) and are serialised by a mutex. Writers are preferred: new
+// readers back off while one is waiting. Neither side is recursive.
+class BigReaderLock {
+public:
+    static constexpr size_t kMaxReaderSlots = 64;
+
+    // 0 means one slot per hardware thread (rounded up to a power of two,
+    // at most kMaxReaderSlots). Threads beyond that share slots.
+    explicit BigReaderLock(size_t reader_slots = 0);
+
+    void readLock() {
+        ReaderSlot& slot = slots_[threadSlotIndex() & slot_mask_];
+        while (true) {
+            slot.readers.fetch_add(1, std::memory_order_seq_cst);
+            // Pairs with writeLock(): either the writer sees our count, or we see its flag.
+            if (!writer_.load(std::memory_order_seq_cst)) {
+                return;
+            }
+            slot.readers.fetch_sub(1, std::memory_order_release);
+            while (writer_.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void readUnlock() {
+        slots_[threadSlotIndex() & slot_mask_].readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void writeLock();
+    void writeUnlock();
+
+    size_t getReaderSlotCount() const { return slot_mask_ + 1; }
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> readers{0};
+    };
+
+    // Stable per-thread index, handed out round-robin so the first
+    // hardware_concurrency threads get distinct slots.
+    static size_t threadSlotIndex() {
+        static std::atomic<size_t> next_index{0};
+        static thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    std::unique_ptr<ReaderSlot[]> slots_;
+    size_t slot_mask_;
+    std::atomic<bool> writer_;
+    std::mutex writer_mutex_;
+};
+
+class BigReaderReadGuard {
+public:
+    explicit BigReaderReadGuard(BigReaderLock& lock) : lock_(lock) {
+        lock_.readLock();
+    }
+    ~BigReaderReadGuard() {
+        lock_.readUnlock();
+    }
+    BigReaderReadGuard(const BigReaderReadGuard&) = delete;
+    BigReaderReadGuard& operator=(const BigReaderReadGuard&) = delete;
+private:
+    BigReaderLock& lock_;
+};
+
+class BigReaderWriteGuard {
+public:
+    explicit BigReaderWriteGuard(BigReaderLock& lock) : lock_(lock) {
+        lock_.writeLock();
+    }
+    ~BigReaderWriteGuard() {
+        lock_.writeUnlock();
+    }
+    BigReaderWriteGuard(const BigReaderWriteGuard&) = delete;
+    BigReaderWriteGuard& operator=(const BigReaderWriteGuard&) = delete;
+private:
+    BigReaderLock& lock_;
+};
+
+
+// --- Sequence Lock ---
+// For small, frequently read data with a single (externally serialised) writer.
+// The writer makes the sequence odd while it modifies the data and even again
+// afterwards. Readers never write shared memory: they copy what they need and
+// retry if the sequence changed in the meantime, so data read inside the
+// section may be torn and must only be trusted once readRetry() returns false.
+// Only suitable for trivially-copyable data.
+class SeqLock {
+public:
+    SeqLock() : sequence_(0) {}
+
+    uint64_t readBegin() const {
+        uint64_t seq = sequence_.load(std::memory_order_acquire);
+        while (seq & 1) { // Writer in progress
+            std::this_thread::yield();
+            seq = sequence_.load(std::memory_order_acquire);
+        }
+        return seq;
+    }
+
+    bool readRetry(uint64_t start_sequence) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence_.load(std::memory_order_relaxed) != start_sequence;
+    }
+
+    void writeBegin() {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void writeEnd() {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint64_t getSequence() const { return sequence_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint64_t> sequence_;
+};
+
+// RAII wrapper for the write side of a SeqLock
+class SeqLockWriteGuard {
+public:
+    explicit SeqLockWriteGuard(SeqLock& seq_lock) : lock_(seq_lock) {
+        lock_.writeBegin();
+    }
+    ~SeqLockWriteGuard() {
+        lock_.writeEnd();
+    }
+    SeqLockWriteGuard(const SeqLockWriteGuard&) = delete;
+    SeqLockWriteGuard& operator=(const SeqLockWriteGuard&) = delete;
+private:
+    SeqLock& lock_;
+};
+
+
 // --- RCU (Read-Copy-Update) Utilities ---
-// This is a simplified RCU mechanism skeleton.
-// A full RCU implementation is highly complex and system-dependent.
-// This version will focus on the core concepts:
-// - Readers operate without locks on shared data.
-// - Writers create copies, modify them, then publish.
-// - Grace periods ensure old data is reclaimed safely.
-
-// Global RCU epoch (simplified)
-// In a real system, this would be more sophisticated, possibly per-CPU.
+// Epoch-based userspace RCU:
+// - Readers bracket accesses with rcuReadLock()/rcuReadUnlock(). The outermost
+//   lock publishes the global epoch in the thread's own cache-line-sized slot;
+//   the unlock clears it (0 = quiescent). Sections nest and never block.
+// - Writers publish a new version (e.g. atomic pointer swap), then either wait
+//   with synchronizeRcu() or defer freeing the old version with callRcu().
+// - synchronizeRcu() advances the global epoch and waits only for registered
+//   readers whose slot still shows an older epoch, i.e. that entered their
+//   section before the swap.
+// - callRcu() callbacks are reclaimed in batches by a background thread: one
+//   grace period covers every callback queued before it started.
+//
+// Threads register on their first rcuReadLock() and unregister at thread exit.
+// synchronizeRcu() and processRcuCallbacks() must not be called inside a
+// read-side section or from an RCU callback (the grace period would wait for
+// the caller itself).
+//
+// QSBR flavour, for poll-mode run-to-completion threads: after
+// rcuQsbrRegisterThread() the thread's whole run between two
+// rcuQuiescentState() calls counts as one read-side section, and
+// rcuReadLock()/rcuReadUnlock() become no-ops on that thread (no stores, no
+// fences). The thread reports a quiescent state once per loop iteration, at a
+// point where it holds no RCU-protected references, and brackets anything
+// that may block with rcuThreadOffline()/rcuThreadOnline() so it does not
+// stall grace periods. Both flavours share one grace period and callRcu().
 namespace RcuUtils {
 
-// Represents a "quiescent state" counter for a thread.
-// Each thread participating in RCU should increment its counter
-// when it's in a "read-side critical section" (accessing RCU-protected data).
-// This is a very simplified model. More robust RCU uses thread registration,
-// per-CPU variables, and more complex epoch tracking.
-extern thread_local uint64_t rcu_thread_epoch;
-extern std::atomic<uint64_t> rcu_global_epoch;
+// One reader's published epoch, padded so readers never share a cache line.
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{0}; // Epoch seen on entry; 0 while quiescent
+};
+
+extern std::atomic<uint64_t> rcu_global_epoch;   // Starts at 1; advanced by each grace period
+extern thread_local ReaderSlot* rcu_reader_slot; // Null until the thread registers
+extern thread_local unsigned rcu_read_nesting;
+extern thread_local bool rcu_qsbr_thread;        // Set by rcuQsbrRegisterThread()
+
+// Registers the calling thread as a reader (idempotent) and returns its slot.
+// Called implicitly by the first rcuReadLock(); it briefly takes the registry
+// lock, so a thread's first read-side section can wait out a grace period.
+ReaderSlot* registerReaderThread();
+// Removes the calling thread's slot. Done automatically at thread exit; only
+// needed for threads that outlive their use of RCU. Not inside a section.
+void unregisterReaderThread();
+size_t getRegisteredReaderCount();
+
+// Switches the calling thread to QSBR and puts it online. Not inside a
+// read-side section.
+void rcuQsbrRegisterThread();
+// Back to epoch-based read-side sections (the thread is left quiescent).
+void rcuQsbrUnregisterThread();
+
+// QSBR: the thread holds no RCU-protected references at this point. One
+// plain store; grace periods started before it no longer wait for the thread.
+inline void rcuQuiescentState() {
+    rcu_reader_slot->epoch.store(rcu_global_epoch.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// QSBR: extended quiescent state, e.g. around a blocking wait. No RCU reads
+// until rcuThreadOnline().
+inline void rcuThreadOffline() {
+    rcu_reader_slot->epoch.store(0, std::memory_order_release);
+}
+
+inline void rcuThreadOnline() {
+    rcuQuiescentState();
+    // Coming back from 0 a grace period may already have skipped us: order
+    // the store before our next reads, as rcuReadLock() does.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
 
 // Call this when a thread enters an RCU read-side critical section.
 inline void rcuReadLock() {
-    // In this simplified model, we can just note the current global epoch.
-    // A real implementation might increment a per-thread counter or mark active.
-    rcu_thread_epoch = rcu_global_epoch.load(std::memory_order_acquire);
+    if (rcu_qsbr_thread) {
+        return; // Covered until the thread's next quiescent state
+    }
+    if (rcu_read_nesting++ == 0) {
+        ReaderSlot* slot = rcu_reader_slot;
+        if (slot == nullptr) {
+            slot = registerReaderThread();
+        }
+        slot->epoch.store(rcu_global_epoch.load(std::memory_order_acquire), std::memory_order_release);
+        // Order the slot store before the section's loads of protected
+        // pointers; pairs with the fence in synchronizeRcu().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
 }
 
 // Call this when a thread exits an RCU read-side critical section.
 inline void rcuReadUnlock() {
-    // Mark thread as quiescent for the rcu_thread_epoch it was on.
-    // In a real system, this signals that the thread is no longer using data from that epoch.
-    // For this skeleton, this is mostly a conceptual marker.
+    if (rcu_qsbr_thread) {
+        return;
+    }
+    if (--rcu_read_nesting == 0) {
+        rcu_reader_slot->epoch.store(0, std::memory_order_release);
+    }
 }
 
-// Initiates a grace period.
-// After this returns, all threads that were in an RCU read-side critical section
-// *before* this call are guaranteed to have completed it.
-// Any new RCU read-side critical sections will see data from the new epoch.
-void synchronizeRcu(bool force_full_wait = false);
+// Waits for a grace period: when it returns, every read-side section that was
+// in progress when it was called has ended. Callbacks queued with callRcu()
+// before the call are run as well.
+void synchronizeRcu();
 
-// For writers: A function to call after data has been "published" (e.g., atomic pointer swap)
-// and before old data can be reclaimed. This function ensures all prior readers are done.
+// For writers: defers callback (usually a delete) until after a grace period.
+// Never blocks; the background reclaimer batches callbacks into one grace period.
 //
 // Usage:
-//   auto old_data = shared_ptr_to_data.load();
-//   auto new_data = make_new_data_based_on(old_data);
-//   shared_ptr_to_data.store(new_data); // Publish
-//   synchronizeRcu(); // Wait for grace period
-//   reclaim(old_data); // Now safe to free/recycle old_data
-
-// Helper for managing "call RCU" callbacks (deferred reclamation)
-// This is a common pattern where functions (usually for deallocation) are
-// deferred until after a grace period.
+//   Data* old_data = shared_data.exchange(new_data); // Publish
+//   RcuUtils::callRcu([old_data]() { delete old_data; });
 void callRcu(std::function<void()> callback);
 
-// Processes the pending RCU callbacks.
-// This might be called by a dedicated RCU thread or periodically.
+// Waits for a grace period and runs every callback queued so far, including
+// any batch the background reclaimer is already processing. For tests and
+// shutdown paths that need reclamation to have happened.
 void processRcuCallbacks();
 
-// --- Thread Pool (Simple) ---
-// A very basic thread pool for offloading tasks, could be used for RCU callback processing
-// or other background work. Not directly part of RCU but often used with it.
-class SimpleThreadPool {
+// --- Work-Stealing Thread Pool ---
+// Each worker owns a Chase-Lev deque (Chase & Lev 2005, with the C11
+// orderings of Le et al. 2013): the owner pushes and pops at the bottom
+// without locking, idle workers steal from the top of a randomly chosen
+// victim. Tasks submitted from outside the pool go through one injection
+// queue; tasks submitted by a running task go to its worker's own deque, so
+// recursive work (parallelFor's range splitting) never touches a shared lock.
+// Idle workers sleep on a condition variable that submitters only signal when
+// someone is asleep.
+//
+// stop() runs every task already queued (including tasks those tasks spawn),
+// then joins the workers. Later submissions from outside the pool are
+// dropped: enqueue() is a no-op and submit()'s future reports broken_promise.
+class WorkStealingThreadPool {
 public:
-    SimpleThreadPool(size_t num_threads = 0); // 0 means hardware_concurrency
-    ~SimpleThreadPool();
+    using Task = std::function<void()>;
+
+    explicit WorkStealingThreadPool(size_t num_threads = 0); // 0 means hardware_concurrency
+    ~WorkStealingThreadPool();
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
 
     template<class F>
     void enqueue(F&& f) {
-        if (stop_.load(std::memory_order_relaxed)) {
-            // Or throw: throw std::runtime_error("enqueue on stopped ThreadPool");
-            return;
-        }
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            tasks_.emplace_back(std::forward<F>(f));
-        }
-        condition_.notify_one();
+        schedule(new Task(std::forward<F>(f)));
     }
 
+    // Runs f on the pool; the future carries its result or exception.
+    template<class F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using Result = decltype(f());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = task->get_future();
+        schedule(new Task([task]() { (*task)(); }));
+        return result;
+    }
+
+    // Calls body(i) for every i in [begin, end) and returns when all calls
+    // are done. The range is split recursively down to `grain` indices (0
+    // picks a grain giving about 8 chunks per worker) and the halves are
+    // stolen by idle workers. The calling thread works too, so this may be
+    // called from inside a task. The first exception thrown by body is
+    // rethrown here after the remaining indices finished.
+    void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body, size_t grain = 0);
+
     void stop();
 
+    size_t getThreadCount() const { return workers_.size(); }
+    // Index of the calling worker in this pool, or -1 outside it.
+    int currentWorkerIndex() const;
+
 private:
+    // Single-owner, multi-thief deque of Task pointers. Grown arrays are
+    // kept until the deque is destroyed, since a thief may still read one.
+    class WorkDeque {
+    public:
+        WorkDeque();
+        ~WorkDeque();
+        void push(Task* task); // Owner only
+        Task* pop();           // Owner only
+        Task* steal();         // Any thread; null if empty or it lost a race
+
+    private:
+        struct Array {
+            explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), slots(new std::atomic<Task*>[cap]) {}
+            int64_t capacity;
+            int64_t mask;
+            std::unique_ptr<std::atomic<Task*>[]> slots;
+            Task* get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+            void put(int64_t i, Task* task) { slots[i & mask].store(task, std::memory_order_relaxed); }
+        };
+
+        alignas(64) std::atomic<int64_t> top_;
+        alignas(64) std::atomic<int64_t> bottom_;
+        std::atomic<Array*> array_;
+        std::vector<std::unique_ptr<Array>> arrays_; // Current and every outgrown array
+    };
+
+    void schedule(Task* task);
+    Task* findTask(int worker_index, uint64_t& rng_state);
+    bool runOneTask(); // Runs a queued task on the calling thread if there is one
+    void runTask(Task* task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkDeque>> deques_;
     std::vector<std::thread> workers_;
-    std::vector<std::function<void()>> tasks_; // Using vector as a simple queue
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    std::atomic<bool> stop_; // Changed to atomic
+
+    std::mutex injection_mutex_;
+    std::vector<Task*> injection_queue_; // FIFO via injection_head_
+    size_t injection_head_ = 0;
+
+    std::atomic<int64_t> queued_;   // Submitted but not yet taken; counted before the push
+    std::atomic<int> sleepers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<bool> stop_;
 };
 
+// The previous single-queue pool; existing users get the work-stealing one.
+using SimpleThreadPool = WorkStealingThreadPool;
+
 } // namespace RcuUtils
 
+
+// --- Hazard Pointers ---
+// Per-object reclamation (Michael, 2004) for lock-free structures whose nodes
+// churn too fast to wait for an RCU grace period. A reader publishes the node
+// it is about to dereference in one of its thread's hazard slots; a writer
+// that has unlinked a node retire()s it, and the node is reclaimed by a later
+// scan() once no slot holds it. A thread's retired list is scanned when it
+// reaches max(kMinScanThreshold, 2 x total hazard slots), so each scan frees
+// at least half of it and retirement costs amortised O(log slots) per node.
+//
+// Each thread gets a record of kSlotsPerThread slots per domain on first use;
+// the record is released (and its leftover retired nodes handed to the next
+// scanning thread) at thread exit. Reclaim functions therefore run on
+// whichever thread scans: a MemoryPool passed to retireToPool() must only be
+// used by threads that retire into it, or be otherwise synchronised.
+class HazardPointerDomain {
+public:
+    static constexpr size_t kSlotsPerThread = 4;
+    static constexpr size_t kMinScanThreshold = 64;
+    using ReclaimFn = void (*)(void* object, void* context);
+
+    HazardPointerDomain();
+    // Reclaims every retired node. No thread may still hold a hazard.
+    ~HazardPointerDomain();
+    HazardPointerDomain(const HazardPointerDomain&) = delete;
+    HazardPointerDomain& operator=(const HazardPointerDomain&) = delete;
+
+    // Domain for structures that do not need their own.
+    static HazardPointerDomain& defaultDomain();
+
+    // Loads source and publishes the pointer in hazard slot `index` of the
+    // calling thread, retrying until it is stable. The returned node (which
+    // may be null) stays valid until the slot is cleared or reused.
+    template <typename T>
+    T* protect(size_t index, const std::atomic<T*>& source) {
+        std::atomic<void*>& slot = hazardSlot(index);
+        T* ptr = source.load(std::memory_order_relaxed);
+        while (true) {
+            slot.store(ptr, std::memory_order_seq_cst);
+            T* current = source.load(std::memory_order_seq_cst); // Pairs with the fence in scan()
+            if (current == ptr) {
+                return ptr;
+            }
+            ptr = current;
+        }
+    }
+    void clear(size_t index) { hazardSlot(index).store(nullptr, std::memory_order_release); }
+    void clearAll();
+
+    // Hands over an unlinked node; reclaim(object, context) runs once no
+    // hazard slot holds it. May scan.
+    void retire(void* object, ReclaimFn reclaim, void* context = nullptr);
+    template <typename T>
+    void retire(T* object) {
+        retire(object, [](void* p, void*) { delete static_cast<T*>(p); });
+    }
+    // Node constructed in pool memory: destroyed, then returned to the pool
+    // instead of the heap, so churned nodes are reused without allocation.
+    template <typename T>
+    void retireToPool(T* object, TypedMemoryPool<T>& pool) {
+        retire(object, [](void* p, void* ctx) {
+            static_cast<T*>(p)->~T();
+            static_cast<TypedMemoryPool<T>*>(ctx)->deallocateTyped(static_cast<T*>(p));
+        }, &pool);
+    }
+    // Raw pool memory (trivially destructible contents).
+    void retireToPool(void* object, MemoryPool& pool) {
+        retire(object, [](void* p, void* ctx) { static_cast<MemoryPool*>(ctx)->deallocate(p); }, &pool);
+    }
+
+    // Reclaims the calling thread's retired nodes that no slot protects, plus
+    // any left by exited threads. Returns how many were reclaimed.
+    size_t scan();
+
+    // Retired but not yet reclaimed, across all threads (approximate while
+    // other threads retire concurrently).
+    size_t getRetiredCount() const;
+    size_t getThreadRecordCount() const;
+
+    struct ThreadRecord; // Defined in threading.cpp
+    struct RetiredNode {
+        void* object;
+        ReclaimFn reclaim;
+        void* context;
+    };
+
+private:
+    std::atomic<void*>& hazardSlot(size_t index);
+    ThreadRecord* localRecord();
+    void releaseRecord(ThreadRecord* record);
+    friend struct HazardRecordCache;
+
+    uint64_t id_;                              // Never reused; thread-local caches key on it
+    std::atomic<ThreadRecord*> records_;       // Lock-free push-only list
+    std::atomic<size_t> record_count_;
+    std::atomic<size_t> retired_count_;
+    mutable std::mutex orphan_mutex_;
+    std::vector<RetiredNode> orphans_;         // Left by exited threads
+};
+
 #endif // THREADING_UTILS_H
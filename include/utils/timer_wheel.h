@@ -0,0 +1,118 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <cstdint>  // For uint64_t
+#include <cstddef>  // For size_t
+#include <utility>  // For std::move
+
+// --- Hierarchical Timer Wheel ---
+// O(1) scheduling and expiry of many timers (e.g. flow idle/hard timeouts)
+// without ever scanning the set of pending timers.
+//
+// Time is measured in caller-defined ticks. Level 0 has one slot per tick;
+// each higher level has slots kSlotsPerLevel times coarser. A timer is placed
+// on the lowest level whose slot span reaches its expiry, and is cascaded down
+// a level each time the wheel reaches its slot, so it fires at its exact tick.
+// With 4 levels of 256 slots the wheel covers 2^32 ticks; later expiries are
+// clamped to that horizon.
+//
+// Timers cannot be cancelled. Owners that need to cancel or postpone a timer
+// check on expiry whether it is still wanted (lazy rescheduling), which is much
+// cheaper than rescheduling on every packet. Not thread-safe; callers serialise.
+template <typename Payload>
+class TimerWheel {
+public:
+    static constexpr unsigned kLevels = 4;
+    static constexpr unsigned kSlotBits = 8;
+    static constexpr size_t kSlotsPerLevel = size_t{1} << kSlotBits;
+
+    struct Timer {
+        Payload payload;
+        uint64_t expiry_tick;
+    };
+
+    explicit TimerWheel(uint64_t start_tick = 0) : current_tick_(start_tick), pending_(0) {}
+
+    // Schedules 'payload' to fire at expiry_tick (past ticks fire on the next advance).
+    // Returns the tick the timer was actually scheduled for, after clamping.
+    uint64_t schedule(const Payload& payload, uint64_t expiry_tick) {
+        uint64_t horizon = current_tick_ + (uint64_t{1} << (kSlotBits * kLevels)) - 1;
+        if (expiry_tick > horizon) {
+            expiry_tick = horizon;
+        }
+        if (expiry_tick <= current_tick_) {
+            expiry_tick = current_tick_ + 1;
+        }
+        place(Timer{payload, expiry_tick});
+        ++pending_;
+        return expiry_tick;
+    }
+
+    // Advances the wheel to now_tick, appending every timer due by then to 'expired'.
+    void advance(uint64_t now_tick, std::vector<Timer>& expired) {
+        while (current_tick_ < now_tick) {
+            if (pending_ == 0) {
+                current_tick_ = now_tick; // Nothing to fire: skip ahead
+                return;
+            }
+            tick(expired);
+        }
+    }
+
+    uint64_t getCurrentTick() const { return current_tick_; }
+    size_t pending() const { return pending_; }
+
+private:
+    uint64_t current_tick_;
+    size_t pending_;
+    std::vector<Timer> slots_[kLevels][kSlotsPerLevel];
+
+    static size_t slotIndex(uint64_t tick, unsigned level) {
+        return static_cast<size_t>(tick >> (kSlotBits * level)) & (kSlotsPerLevel - 1);
+    }
+
+    // Lowest level at which expiry and the current tick share all higher
+    // digits. The timer's digit at that level is then strictly ahead of the
+    // wheel's, so the slot is reached (and cascaded) before the timer is due.
+    void place(Timer timer) {
+        unsigned level = 0;
+        while (level + 1 < kLevels &&
+               (timer.expiry_tick >> (kSlotBits * (level + 1))) != (current_tick_ >> (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        slots_[level][slotIndex(timer.expiry_tick, level)].push_back(std::move(timer));
+    }
+
+    void tick(std::vector<Timer>& expired) {
+        ++current_tick_;
+
+        // Cascade from the highest level whose slot boundary was just crossed
+        // down to level 1, so timers can fall through several levels at once.
+        unsigned top = 0;
+        while (top + 1 < kLevels && (current_tick_ & ((uint64_t{1} << (kSlotBits * (top + 1))) - 1)) == 0) {
+            ++top;
+        }
+        for (unsigned level = top; level >= 1; --level) {
+            std::vector<Timer> cascading;
+            cascading.swap(slots_[level][slotIndex(current_tick_, level)]);
+            for (Timer& timer : cascading) {
+                if (timer.expiry_tick <= current_tick_) {
+                    expired.push_back(std::move(timer));
+                    --pending_;
+                } else {
+                    place(std::move(timer));
+                }
+            }
+        }
+
+        std::vector<Timer>& due = slots_[0][slotIndex(current_tick_, 0)];
+        for (Timer& timer : due) {
+            expired.push_back(std::move(timer));
+        }
+        pending_ -= due.size();
+        due.clear(); // Keeps capacity for the next rotation
+    }
+};
+
+#endif // TIMER_WHEEL_H
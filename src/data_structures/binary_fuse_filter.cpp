@@ -0,0 +1,161 @@
+#include "data_structures/binary_fuse_filter.h"
+#include <algorithm>       // For std::sort, std::unique, std::max, std::min
+#include <cmath>           // For std::log, std::floor, std::round
+
+namespace {
+
+constexpr uint32_t kArity = 3;
+constexpr uint32_t kMaxSegmentLength = 262144;
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint32_t mod3(uint32_t x) {
+    return x > 2 ? x - 3 : x;
+}
+
+} // anonymous namespace
+
+BinaryFuseFilter::BinaryFuseFilter()
+    : seed_(0), segment_length_(0), segment_length_mask_(0), segment_count_length_(0), key_count_(0) {}
+
+BinaryFuseFilter::BinaryFuseFilter(const std::vector<uint64_t>& keys) : BinaryFuseFilter() {
+    build(keys);
+}
+
+uint64_t BinaryFuseFilter::keyOf(const unsigned char* data, size_t len) {
+    return HashUtils::wyhash(data, len, 0);
+}
+
+uint64_t BinaryFuseFilter::keyOf(const std::string& item) {
+    return keyOf(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+// Segment length and array size from the paper's reference parameters for
+// arity 3: smaller sets need proportionally more slack to peel reliably.
+void BinaryFuseFilter::allocate(size_t key_count) {
+    double n = static_cast<double>(key_count);
+    segment_length_ = key_count == 0 ? 4 : uint32_t{1} << static_cast<int>(std::floor(std::log(n) / std::log(3.33) + 2.25));
+    segment_length_ = std::min(segment_length_, kMaxSegmentLength);
+    segment_length_mask_ = segment_length_ - 1;
+
+    double size_factor = key_count <= 1 ? 0.0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(n));
+    uint64_t capacity = key_count <= 1 ? 0 : static_cast<uint64_t>(std::round(n * size_factor));
+    uint64_t segments = (capacity + segment_length_ - 1) / segment_length_;
+    uint32_t segment_count = segments > kArity - 1 ? static_cast<uint32_t>(segments - (kArity - 1)) : 1;
+
+    segment_count_length_ = segment_count * segment_length_;
+    fingerprints_.assign(static_cast<size_t>(segment_count + kArity - 1) * segment_length_, 0);
+}
+
+bool BinaryFuseFilter::build(const std::vector<uint64_t>& keys) {
+    std::vector<uint64_t> unique_keys(keys);
+    std::sort(unique_keys.begin(), unique_keys.end());
+    unique_keys.erase(std::unique(unique_keys.begin(), unique_keys.end()), unique_keys.end());
+
+    key_count_ = unique_keys.size();
+    if (unique_keys.empty()) {
+        fingerprints_.clear();
+        return true;
+    }
+    allocate(unique_keys.size());
+
+    uint64_t rng_state = 0x726b2b9d438b9d4dULL; // Fixed, so builds are reproducible
+    for (int attempt = 0; attempt < kMaxBuildAttempts; ++attempt) {
+        seed_ = splitmix64(rng_state);
+        if (populate(unique_keys)) {
+            return true;
+        }
+    }
+    fingerprints_.clear();
+    key_count_ = 0;
+    return false;
+}
+
+// One construction attempt with the current seed: hypergraph peeling. Every
+// cell counts the keys mapped to it and XORs their hashes; cells holding a
+// single key are peeled off (the key is pushed on a stack and removed from its
+// other two cells) until no key remains. Fingerprints are then assigned in
+// reverse peel order, each key's free cell being set so its three cells XOR
+// to its fingerprint.
+bool BinaryFuseFilter::populate(const std::vector<uint64_t>& keys) {
+    const size_t array_length = fingerprints_.size();
+    // Per cell: key count in the high 6 bits, XOR of the keys' hash indices
+    // (0, 1 or 2) in the low 2 bits, which identifies the last key's index.
+    std::vector<uint8_t> t2count(array_length, 0);
+    std::vector<uint64_t> t2hash(array_length, 0);
+
+    for (uint64_t key : keys) {
+        uint64_t hash = HashUtils::mix64(key + seed_);
+        uint32_t h[kArity];
+        cells(hash, h[0], h[1], h[2]);
+        for (uint32_t i = 0; i < kArity; ++i) {
+            t2count[h[i]] += 4;
+            t2count[h[i]] ^= static_cast<uint8_t>(i);
+            t2hash[h[i]] ^= hash;
+            if (t2count[h[i]] < 4) {
+                return false; // Over 63 keys in one cell: counter wrapped
+            }
+        }
+    }
+
+    std::vector<uint32_t> alone;
+    alone.reserve(array_length);
+    for (size_t i = 0; i < array_length; ++i) {
+        if ((t2count[i] >> 2) == 1) {
+            alone.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    std::vector<uint64_t> stack_hash;
+    std::vector<uint8_t> stack_found;
+    stack_hash.reserve(keys.size());
+    stack_found.reserve(keys.size());
+    while (!alone.empty()) {
+        uint32_t index = alone.back();
+        alone.pop_back();
+        if ((t2count[index] >> 2) != 1) {
+            continue; // Already peeled through another cell
+        }
+        uint64_t hash = t2hash[index];
+        uint32_t h[kArity + 2];
+        cells(hash, h[0], h[1], h[2]);
+        h[3] = h[0];
+        h[4] = h[1];
+        uint8_t found = t2count[index] & 3;
+        stack_hash.push_back(hash);
+        stack_found.push_back(found);
+
+        t2count[index] -= 4;
+        t2hash[index] ^= hash;
+        for (uint32_t step = 1; step < kArity; ++step) {
+            uint32_t other = h[found + step];
+            t2count[other] -= 4;
+            t2count[other] ^= static_cast<uint8_t>(mod3(found + step));
+            t2hash[other] ^= hash;
+            if ((t2count[other] >> 2) == 1) {
+                alone.push_back(other);
+            }
+        }
+    }
+    if (stack_hash.size() != keys.size()) {
+        return false; // The hypergraph has a core that cannot be peeled
+    }
+
+    std::fill(fingerprints_.begin(), fingerprints_.end(), 0);
+    for (size_t i = stack_hash.size(); i-- > 0;) {
+        uint64_t hash = stack_hash[i];
+        uint32_t h[kArity + 2];
+        cells(hash, h[0], h[1], h[2]);
+        h[3] = h[0];
+        h[4] = h[1];
+        uint8_t found = stack_found[i];
+        fingerprints_[h[found]] =
+            static_cast<uint8_t>(fingerprint(hash) ^ fingerprints_[h[found + 1]] ^ fingerprints_[h[found + 2]]);
+    }
+    return true;
+}
@@ -1,7 +1,13 @@
 #include "data_structures/bloom_filter.h"
+#include "utils/hashing.h"
 #include <iostream> // For placeholder output
 #include <limits>   // For std::numeric_limits
 
+#if defined(__x86_64__)
+#include <immintrin.h> // AVX2 / AVX-512 gathers for possiblyContainsBatch
+#define BLOOM_FILTER_X86_64 1
+#endif
+
 // --- Helper for Optimal Parameters ---
 void BloomFilter::calculateOptimalParams(uint64_t num_items, double false_positive_prob, uint64_t& out_size, int& out_num_hashes) {
     if (num_items == 0 || false_positive_prob <= 0.0 || false_positive_prob >= 1.0) {
@@ -33,28 +39,17 @@ void BloomFilter::calculateOptimalParams(uint64_t num_items, double false_positi
 }
 
 // --- Constructors ---
-BloomFilter::BloomFilter(uint64_t num_items, double false_positive_prob) : current_insertions(0) {
+BloomFilter::BloomFilter(uint64_t num_items, double false_positive_prob) : block_bits(kBlockBits), current_insertions(0) {
     calculateOptimalParams(num_items, false_positive_prob, this->bit_array_size, this->num_hash_functions);
     if (this->bit_array_size == 0) { // Ensure bit_array is not size 0
         std::cerr << "Warning: Calculated bit_array_size is 0. Defaulting to 1024." << std::endl;
         this->bit_array_size = 1024;
     }
-    try {
-        bit_array.resize(this->bit_array_size, false);
-    } catch (const std::bad_alloc& e) {
-        std::cerr << "Error: Failed to allocate bit_array of size " << this->bit_array_size << ". " << e.what() << std::endl;
-        // Fallback or rethrow
-        this->bit_array_size = 0;
-        this->num_hash_functions = 0;
-        throw; // Rethrow or handle more gracefully
-    }
-    std::cout << "BloomFilter initialized. Optimal size: " << this->bit_array_size
-              << ", Optimal hash functions: " << this->num_hash_functions
-              << " for " << num_items << " items and FP prob: " << false_positive_prob << std::endl;
+    allocateBlocks();
 }
 
 BloomFilter::BloomFilter(uint64_t size, int num_hashes)
-    : bit_array_size(size), num_hash_functions(num_hashes), current_insertions(0) {
+    : bit_array_size(size), num_hash_functions(num_hashes), block_bits(kBlockBits), current_insertions(0) {
     if (size == 0) {
         std::cerr << "Warning: BloomFilter size cannot be 0. Defaulting to 1024." << std::endl;
         this->bit_array_size = 1024;
@@ -63,83 +58,46 @@ BloomFilter::BloomFilter(uint64_t size, int num_hashes)
         std::cerr << "Warning: BloomFilter num_hash_functions must be positive. Defaulting to 3." << std::endl;
         this->num_hash_functions = 3;
     }
-     try {
-        bit_array.resize(this->bit_array_size, false);
+    allocateBlocks();
+}
+
+// Filters are created and dropped on the data path (RotatingBloomFilter
+// stages), so construction and destruction stay silent; only bad
+// parameters are reported.
+BloomFilter::~BloomFilter() = default;
+
+void BloomFilter::allocateBlocks() {
+    block_bits = bit_array_size < kBlockBits ? bit_array_size : kBlockBits;
+    uint64_t num_blocks = (bit_array_size + kBlockBits - 1) / kBlockBits;
+    try {
+        blocks.assign(num_blocks, Block{});
     } catch (const std::bad_alloc& e) {
-        std::cerr << "Error: Failed to allocate bit_array of size " << this->bit_array_size << ". " << e.what() << std::endl;
+        std::cerr << "Error: Failed to allocate " << num_blocks << " Bloom filter blocks. " << e.what() << std::endl;
         this->bit_array_size = 0; // Indicate failure
         this->num_hash_functions = 0;
         throw;
     }
-    std::cout << "BloomFilter initialized with size: " << this->bit_array_size
-              << " and hash functions: " << this->num_hash_functions << std::endl;
-}
-
-BloomFilter::~BloomFilter() {
-    std::cout << "BloomFilter destroyed." << std::endl;
 }
 
 // --- Hashing ---
-// These are placeholder hash functions. Real implementations should use good quality,
-// independent hash functions like MurmurHash3, xxHash, or FNV.
-// For simplicity, we'll use combinations/variations of std::hash.
-
+// The base hash runs directly over the item bytes; no temporary copies.
 uint64_t BloomFilter::hashFunction1(const unsigned char* data, size_t len) const {
-    // Simple hash: sum of chars (very bad, just for placeholder)
-    // In practice, use a robust hash like std::hash for string or a custom one.
-    std::string s(reinterpret_cast<const char*>(data), len);
-    return std::hash<std::string>{}(s);
+    return HashUtils::wyhash(data, len, 0);
 }
 
-uint64_t BloomFilter::hashFunction2(const unsigned char* data, size_t len) const {
-    // Another simple hash (equally bad, just for placeholder)
-    // Ensure this is different from hashFunction1.
-    uint64_t hash_val = 5381; // DJB2 seed
-    for (size_t i = 0; i < len; ++i) {
-        hash_val = ((hash_val << 5) + hash_val) + data[i]; // hash * 33 + c
+void BloomFilter::makeProbe(uint64_t hash, Probe& probe) const {
+    probe.block = probeBlock(hash, blocks.size());
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        probe.mask[w] = 0;
     }
-    return hash_val;
-}
-
-// General hash generation (produces k hash values)
-std::vector<uint64_t> BloomFilter::hash(const unsigned char* data, size_t len) const {
-    std::vector<uint64_t> hashes;
-    hashes.reserve(num_hash_functions);
-
-    if (num_hash_functions == 0 || bit_array_size == 0) return hashes;
-
-    // For a skeleton, let's assume we have at least two base hash functions
-    // and derive others if k > 2.
-    // This is a common technique: h_i(x) = (h1(x) + i * h2(x)) mod m
-    // It's better than just using one hash and slicing bits, but still not as good as k truly independent hashes.
-    uint64_t h1 = hashFunction1(data, len);
-    uint64_t h2 = (num_hash_functions > 1) ? hashFunction2(data, len) : 0; // h2 only needed if k > 1
-
-    for (int i = 0; i < num_hash_functions; ++i) {
-        if (i == 0) {
-            hashes.push_back(h1 % bit_array_size);
-        } else if (i == 1 && num_hash_functions > 1) {
-             hashes.push_back(h2 % bit_array_size);
-        }
-        else { // For i >= 2 (or i >= 1 if only one base hash was used e.g. h2 was 0)
-            // Kirsch-Mitzenmacher optimization or simple linear combination
-            // (h1 + i * h2) can lead to poor distribution if h2 is 0 or small.
-            // Ensure h2 is non-zero and reasonably large if used this way.
-            // If h2 could be 0 (e.g. if num_hash_functions was 1 and we are in the i=0 case of a loop for k),
-            // then h1 + i*h2 would just be h1.
-            // A better approach if only two base hashes h1, h2 are available:
-            // hash_i = (h1 + i * (h2 + i)) % bit_array_size; // Ensure h2+i is not 0
-            uint64_t combined_hash = (h1 + static_cast<uint64_t>(i) * (h2 + static_cast<uint64_t>(i) + 1)) % bit_array_size;
-            hashes.push_back(combined_hash);
-        }
-    }
-    return hashes;
+    forEachProbePosition(hash, num_hash_functions, block_bits,
+                         [&](uint32_t pos) { probe.mask[pos >> 6] |= uint64_t{1} << (pos & 63); });
 }
 
 
 // --- Core Public Methods ---
 void BloomFilter::insert(const std::string& item) {
-    insert(reinterpret_cast<const unsigned char*>(item.c_str()), item.length());
+    insert(reinterpret_cast<const unsigned char*>(item.data()), item.length());
 }
 
 void BloomFilter::insert(const unsigned char* data, size_t len) {
@@ -147,16 +105,17 @@ void BloomFilter::insert(const unsigned char* data, size_t len) {
         std::cerr << "Error: Bloom filter not properly initialized (size 0). Cannot insert." << std::endl;
         return;
     }
-    std::cout << "Inserting data of length " << len << "." << std::endl;
-    std::vector<uint64_t> hash_values = hash(data, len);
-    for (uint64_t h_val : hash_values) {
-        bit_array[h_val] = true;
+    Probe probe;
+    makeProbe(hashFunction1(data, len), probe);
+    Block& block = blocks[probe.block];
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        block.words[w] |= probe.mask[w];
     }
     current_insertions++;
 }
 
 bool BloomFilter::possiblyContains(const std::string& item) const {
-    return possiblyContains(reinterpret_cast<const unsigned char*>(item.c_str()), item.length());
+    return possiblyContains(reinterpret_cast<const unsigned char*>(item.data()), item.length());
 }
 
 bool BloomFilter::possiblyContains(const unsigned char* data, size_t len) const {
@@ -164,40 +123,239 @@ bool BloomFilter::possiblyContains(const unsigned char* data, size_t len) const
         std::cerr << "Warning: Bloom filter not properly initialized (size 0). Returning false." << std::endl;
         return false; // Or throw error
     }
-    std::cout << "Checking data of length " << len << "." << std::endl;
-    std::vector<uint64_t> hash_values = hash(data, len);
-    for (uint64_t h_val : hash_values) {
-        if (!bit_array[h_val]) {
-            return false; // Definitely not present
+    return containsHash(hashFunction1(data, len));
+}
+
+bool BloomFilter::containsHash(uint64_t hash) const {
+    Probe probe;
+    makeProbe(hash, probe);
+    const Block& block = blocks[probe.block];
+    // Masked compare over the whole cache line: any mask bit missing from the
+    // block means the item is definitely not present.
+    uint64_t missing = 0;
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        missing |= probe.mask[w] & ~block.words[w];
+    }
+    return missing == 0; // Possibly present
+}
+
+void BloomFilter::insertKey(uint64_t key) {
+    if (bit_array_size == 0) {
+        std::cerr << "Error: Bloom filter not properly initialized (size 0). Cannot insert." << std::endl;
+        return;
+    }
+    Probe probe;
+    makeProbe(HashUtils::mix64(key), probe);
+    Block& block = blocks[probe.block];
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        block.words[w] |= probe.mask[w];
+    }
+    current_insertions++;
+}
+
+bool BloomFilter::possiblyContainsKey(uint64_t key) const {
+    if (bit_array_size == 0) {
+        return false;
+    }
+    return containsHash(HashUtils::mix64(key));
+}
+
+// --- Batch queries ---
+// The vector paths compute exactly what makeProbe() does (probeBlock() and
+// forEachProbePosition(); keep them in step), one key per 64-bit lane: mix64,
+// block = ((h >> 32) * blocks) >> 32, then the k in-block positions a + i * b. Instead of building a mask, each position's block word
+// is gathered and its bit tested; lanes whose bits are all set stay possibly
+// present. They require full 512-bit blocks (pos = x & 511) and fewer than
+// 2^32 blocks (32x32-bit block multiply).
+namespace {
+
+#ifdef BLOOM_FILTER_X86_64
+// Low 64 bits of a * c per lane, from 32x32->64 partial products (AVX2 has no
+// 64-bit multiply).
+__attribute__((target("avx2")))
+inline __m256i mullo64x4(__m256i a, uint64_t c) {
+    const __m256i c_lo = _mm256_set1_epi64x(static_cast<long long>(c & 0xFFFFFFFFu));
+    const __m256i c_hi = _mm256_set1_epi64x(static_cast<long long>(c >> 32));
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), c_lo), _mm256_mul_epu32(a, c_hi));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, c_lo), _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2")))
+inline __m256i mix64x4(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+    h = mullo64x4(h, HashUtils::kMix64C1);
+    h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+    h = mullo64x4(h, HashUtils::kMix64C2);
+    return _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+}
+
+// Four keys; returns their presence bits in bits 0-3.
+__attribute__((target("avx2")))
+inline uint64_t probeKeysx4(const uint64_t* keys, const long long* words, uint64_t num_blocks, int k) {
+    __m256i h = mix64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys)));
+    __m256i block = _mm256_srli_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(h, 32), _mm256_set1_epi64x(static_cast<long long>(num_blocks))), 32);
+    __m256i word_base = _mm256_slli_epi64(block, 3); // 8 words per block
+    __m256i x = _mm256_and_si256(h, _mm256_set1_epi64x(0xFFFF));
+    __m256i step = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi64(h, 16), _mm256_set1_epi64x(0xFFFF)),
+                                   _mm256_set1_epi64x(1));
+    const __m256i pos_mask = _mm256_set1_epi64x(511);
+    const __m256i bit_mask = _mm256_set1_epi64x(63);
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i present = one;
+    for (int i = 0; i < k; ++i) {
+        __m256i pos = _mm256_and_si256(x, pos_mask);
+        __m256i index = _mm256_add_epi64(word_base, _mm256_srli_epi64(pos, 6));
+        __m256i word = _mm256_i64gather_epi64(words, index, 8);
+        present = _mm256_and_si256(present, _mm256_srlv_epi64(word, _mm256_and_si256(pos, bit_mask)));
+        if (_mm256_testz_si256(present, one)) {
+            return 0; // All four definitely absent
+        }
+        x = _mm256_add_epi64(x, step);
+    }
+    return static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(present, 63))));
+}
+
+// GCC 12's avx512fintrin.h builds _mm512_srli_epi64 from an undefined
+// vector, which -Wmaybe-uninitialized reports at every inlined call.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+__attribute__((target("avx512f,avx512dq")))
+inline __m512i mix64x8(__m512i h) {
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(static_cast<long long>(HashUtils::kMix64C1)));
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(static_cast<long long>(HashUtils::kMix64C2)));
+    return _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+}
+
+// Eight keys; returns their presence bits in bits 0-7.
+__attribute__((target("avx512f,avx512dq")))
+inline uint64_t probeKeysx8(const uint64_t* keys, const long long* words, uint64_t num_blocks, int k) {
+    __m512i h = mix64x8(_mm512_loadu_si512(keys));
+    __m512i block = _mm512_srli_epi64(
+        _mm512_mul_epu32(_mm512_srli_epi64(h, 32), _mm512_set1_epi64(static_cast<long long>(num_blocks))), 32);
+    __m512i word_base = _mm512_slli_epi64(block, 3);
+    __m512i x = _mm512_and_si512(h, _mm512_set1_epi64(0xFFFF));
+    __m512i step = _mm512_or_si512(_mm512_and_si512(_mm512_srli_epi64(h, 16), _mm512_set1_epi64(0xFFFF)),
+                                   _mm512_set1_epi64(1));
+    const __m512i pos_mask = _mm512_set1_epi64(511);
+    const __m512i bit_mask = _mm512_set1_epi64(63);
+    const __m512i one = _mm512_set1_epi64(1);
+    __mmask8 present = 0xFF;
+    for (int i = 0; i < k && present != 0; ++i) {
+        __m512i pos = _mm512_and_si512(x, pos_mask);
+        __m512i index = _mm512_add_epi64(word_base, _mm512_srli_epi64(pos, 6));
+        // Only lanes still possibly present are gathered.
+        __m512i word = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), present, index, words, 8);
+        present = _mm512_mask_test_epi64_mask(present, _mm512_srlv_epi64(word, _mm512_and_si512(pos, bit_mask)), one);
+        x = _mm512_add_epi64(x, step);
+    }
+    return present;
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+__attribute__((target("avx2")))
+size_t batchAvx2(const uint64_t* keys, size_t n, uint64_t* out_bitmap, const long long* words, uint64_t num_blocks,
+                 int k) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { // Two independent vectors in flight
+        uint64_t bits = probeKeysx4(keys + i, words, num_blocks, k) |
+                        (probeKeysx4(keys + i + 4, words, num_blocks, k) << 4);
+        out_bitmap[i / 64] |= bits << (i % 64);
+    }
+    return i;
+}
+
+__attribute__((target("avx512f,avx512dq")))
+size_t batchAvx512(const uint64_t* keys, size_t n, uint64_t* out_bitmap, const long long* words, uint64_t num_blocks,
+                   int k) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint64_t bits = probeKeysx8(keys + i, words, num_blocks, k) |
+                        (probeKeysx8(keys + i + 8, words, num_blocks, k) << 8);
+        out_bitmap[i / 64] |= bits << (i % 64);
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+void BloomFilter::possiblyContainsBatch(const uint64_t* keys, size_t n, uint64_t* out_bitmap) const {
+    for (size_t w = 0; w < (n + 63) / 64; ++w) {
+        out_bitmap[w] = 0;
+    }
+    if (bit_array_size == 0) {
+        return;
+    }
+    size_t i = 0;
+#ifdef BLOOM_FILTER_X86_64
+    if (block_bits == kBlockBits && blocks.size() <= 0xFFFFFFFFu) {
+        const long long* words = reinterpret_cast<const long long*>(blocks.data());
+        if (HashUtils::hasAvx512()) {
+            i = batchAvx512(keys, n, out_bitmap, words, blocks.size(), num_hash_functions);
+        } else if (HashUtils::hasAvx2()) {
+            i = batchAvx2(keys, n, out_bitmap, words, blocks.size(), num_hash_functions);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (containsHash(HashUtils::mix64(keys[i]))) {
+            out_bitmap[i / 64] |= uint64_t{1} << (i % 64);
         }
     }
-    return true; // Possibly present
 }
 
 // --- Utility Methods ---
 double BloomFilter::getEffectiveFalsePositiveProbability() const {
-    if (bit_array_size == 0) return 1.0; // Max FP if not initialized
-    // p_effective = (1 - (1 - 1/m)^(kn))^k
-    // More common approximation: (1 - e^(-kn/m))^k
-    double kn_div_m = static_cast<double>(num_hash_functions * current_insertions) / bit_array_size;
-    double prob_one_bit_still_zero = std::exp(-kn_div_m);
-    double prob_all_bits_set = std::pow(1.0 - prob_one_bit_still_zero, num_hash_functions);
-    return prob_all_bits_set;
+    if (bit_array_size == 0 || blocks.empty()) return 1.0; // Max FP if not initialized
+    return blockedFalsePositiveRate(current_insertions, blocks.size(), block_bits, num_hash_functions);
+}
+
+double BloomFilter::blockedFalsePositiveRate(uint64_t num_items, uint64_t num_blocks, uint64_t block_bits, int k) {
+    if (num_blocks == 0 || block_bits == 0) return 1.0;
+    // Within one block of b bits holding j items, the FP rate is the standard
+    // (1 - e^(-kj/b))^k. The number of items per block is ~Poisson(n / blocks),
+    // so average over that distribution; it is what makes blocked filters
+    // slightly worse than unblocked ones.
+    double lambda = static_cast<double>(num_items) / num_blocks;
+    double kd = static_cast<double>(k);
+    double b = static_cast<double>(block_bits);
+    if (lambda > 500.0) {
+        // e^-lambda underflows; at this load per-block variance no longer matters.
+        return std::pow(1.0 - std::exp(-kd * lambda / b), kd);
+    }
+    uint64_t limit = static_cast<uint64_t>(lambda + 10.0 * std::sqrt(lambda) + 20.0);
+    double poisson = std::exp(-lambda); // P(j = 0)
+    double fp = 0.0;
+    for (uint64_t j = 0; j <= limit; ++j) {
+        if (j > 0) {
+            poisson *= lambda / static_cast<double>(j);
+        }
+        fp += poisson * std::pow(1.0 - std::exp(-kd * static_cast<double>(j) / b), kd);
+    }
+    return fp > 1.0 ? 1.0 : fp;
 }
 
 // This is a very rough estimate for a standard Bloom filter.
 // More advanced Bloom filter variants (like counting Bloom filters) can do this properly.
 uint64_t BloomFilter::getApproximateCount() const {
     if (bit_array_size == 0 || num_hash_functions == 0) return 0;
-    long double count_set_bits = 0;
-    for (bool bit : bit_array) {
-        if (bit) {
-            count_set_bits++;
+    uint64_t count_set_bits = 0;
+    for (const Block& block : blocks) {
+        for (size_t w = 0; w < kWordsPerBlock; ++w) {
+            count_set_bits += static_cast<uint64_t>(__builtin_popcountll(block.words[w]));
         }
     }
+    uint64_t storage_bits = getStorageBits();
     // n* = - (m/k) * ln(1 - X/m)
     // where X is the number of set bits.
-    if (count_set_bits == bit_array_size) {
+    if (count_set_bits == storage_bits) {
          // If all bits are set, estimation is very unreliable, could be very high.
          // Return a value indicating it's full or use max_uint if that's the convention.
          std::cout << "Warning: Bloom filter is saturated. Count estimation is highly unreliable." << std::endl;
@@ -205,8 +363,8 @@ uint64_t BloomFilter::getApproximateCount() const {
     }
     if (count_set_bits == 0) return 0;
 
-    double estimate = - (static_cast<double>(bit_array_size) / num_hash_functions) *
-                      std::log(1.0 - (count_set_bits / static_cast<double>(bit_array_size)));
+    double estimate = - (static_cast<double>(storage_bits) / num_hash_functions) *
+                      std::log(1.0 - (static_cast<double>(count_set_bits) / storage_bits));
     
     if (estimate < 0) return current_insertions; // Should not happen with valid inputs to log
     return static_cast<uint64_t>(std::round(estimate));
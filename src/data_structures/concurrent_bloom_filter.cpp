@@ -0,0 +1,130 @@
+#include "data_structures/concurrent_bloom_filter.h"
+#include "data_structures/bloom_filter.h" // For the shared sizing and probe helpers
+#include "utils/hashing.h"
+#include <iostream> // For diagnostics
+
+ConcurrentBloomFilter::ConcurrentBloomFilter(uint64_t num_items, double false_positive_prob)
+    : num_bits_(0), num_hash_functions_(0), block_bits_(kBlockBits), num_blocks_(0) {
+    BloomFilter::calculateOptimalParams(num_items, false_positive_prob, num_bits_, num_hash_functions_);
+    allocateBlocks();
+}
+
+ConcurrentBloomFilter::ConcurrentBloomFilter(uint64_t size, int num_hashes)
+    : num_bits_(size), num_hash_functions_(num_hashes), block_bits_(kBlockBits), num_blocks_(0) {
+    if (size == 0) {
+        std::cerr << "Warning: ConcurrentBloomFilter size cannot be 0. Defaulting to 1024." << std::endl;
+        num_bits_ = 1024;
+    }
+    if (num_hashes <= 0) {
+        std::cerr << "Warning: ConcurrentBloomFilter num_hash_functions must be positive. Defaulting to 3." << std::endl;
+        num_hash_functions_ = 3;
+    }
+    allocateBlocks();
+}
+
+void ConcurrentBloomFilter::allocateBlocks() {
+    if (num_bits_ == 0) {
+        num_bits_ = 1024;
+    }
+    block_bits_ = num_bits_ < kBlockBits ? num_bits_ : kBlockBits;
+    num_blocks_ = (num_bits_ + kBlockBits - 1) / kBlockBits;
+    blocks_.reset(new Block[num_blocks_]()); // Value-initialised: all words zero
+}
+
+size_t ConcurrentBloomFilter::threadStripe() {
+    // Threads take stripes round-robin on first use, so up to kCounterStripes
+    // threads each get a counter line to themselves.
+    static std::atomic<size_t> next_stripe{0};
+    thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % kCounterStripes;
+    return stripe;
+}
+
+void ConcurrentBloomFilter::makeProbe(uint64_t hash, Probe& probe) const {
+    probe.block = BloomFilter::probeBlock(hash, num_blocks_);
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        probe.mask[w] = 0;
+    }
+    BloomFilter::forEachProbePosition(hash, num_hash_functions_, block_bits_,
+                                      [&](uint32_t pos) { probe.mask[pos >> 6] |= uint64_t{1} << (pos & 63); });
+}
+
+bool ConcurrentBloomFilter::insert(const std::string& item) {
+    return insert(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+bool ConcurrentBloomFilter::insert(const unsigned char* data, size_t len) {
+    return insertHash(HashUtils::wyhash(data, len, 0));
+}
+
+bool ConcurrentBloomFilter::insertKey(uint64_t key) {
+    return insertHash(HashUtils::mix64(key));
+}
+
+bool ConcurrentBloomFilter::insertHash(uint64_t hash) {
+    Probe probe;
+    makeProbe(hash, probe);
+    Block& block = blocks_[probe.block];
+    bool added = false;
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        uint64_t mask = probe.mask[w];
+        // Read first: re-inserting a known item (the common case for a seen
+        // filter) then never writes, so the line stays shared between cores.
+        if (mask == 0 || (block.words[w].load(std::memory_order_relaxed) & mask) == mask) {
+            continue;
+        }
+        uint64_t previous = block.words[w].fetch_or(mask, std::memory_order_relaxed);
+        added |= (previous & mask) != mask;
+    }
+    if (added) {
+        counters_[threadStripe()].value.fetch_add(1, std::memory_order_relaxed);
+    }
+    return added;
+}
+
+bool ConcurrentBloomFilter::possiblyContains(const std::string& item) const {
+    return possiblyContains(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+bool ConcurrentBloomFilter::possiblyContains(const unsigned char* data, size_t len) const {
+    return containsHash(HashUtils::wyhash(data, len, 0));
+}
+
+bool ConcurrentBloomFilter::possiblyContainsKey(uint64_t key) const {
+    return containsHash(HashUtils::mix64(key));
+}
+
+bool ConcurrentBloomFilter::containsHash(uint64_t hash) const {
+    Probe probe;
+    makeProbe(hash, probe);
+    const Block& block = blocks_[probe.block];
+    uint64_t missing = 0;
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        if (probe.mask[w] != 0) {
+            missing |= probe.mask[w] & ~block.words[w].load(std::memory_order_relaxed);
+        }
+    }
+    return missing == 0;
+}
+
+void ConcurrentBloomFilter::clear() {
+    for (uint64_t i = 0; i < num_blocks_; ++i) {
+        for (size_t w = 0; w < kWordsPerBlock; ++w) {
+            blocks_[i].words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+    for (PaddedCounter& counter : counters_) {
+        counter.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t ConcurrentBloomFilter::getApproximateCount() const {
+    uint64_t total = 0;
+    for (const PaddedCounter& counter : counters_) {
+        total += counter.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double ConcurrentBloomFilter::getEffectiveFalsePositiveProbability() const {
+    return BloomFilter::blockedFalsePositiveRate(getApproximateCount(), num_blocks_, block_bits_, num_hash_functions_);
+}
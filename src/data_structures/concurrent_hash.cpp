@@ -1,247 +1,6 @@
 #include "data_structures/concurrent_hash.h"
-#include <iostream>     // For placeholder output
-#include <functional>   // For std::hash
-#include <stdexcept>    // For std::runtime_error (e.g., in resize if needed)
 
-// --- Constructor & Destructor ---
-ConcurrentHashTable::ConcurrentHashTable(size_t initial_size) : capacity(initial_size), current_size(0) {
-    if (initial_size == 0) {
-        // Default to a reasonable size if 0 is passed, or throw error
-        capacity = 1024;
-    }
-    table.resize(capacity);
-    // Initialize table entries if necessary (e.g. set 'in_use' to false)
-    for (size_t i = 0; i < capacity; ++i) {
-        table[i].in_use.store(false, std::memory_order_relaxed);
-    }
-    std::cout << "ConcurrentHashTable initialized with capacity: " << capacity << std::endl;
-}
-
-ConcurrentHashTable::~ConcurrentHashTable() {
-    std::cout << "ConcurrentHashTable destroyed." << std::endl;
-    // RCU cleanup might be needed here if pointers to old versions are managed
-}
-
-// --- Core Functionality ---
-bool ConcurrentHashTable::lookup(const std::string& key, int& value) const {
-    std::cout << "Lookup for key: " << key << std::endl;
-    // Placeholder for lock-free read.
-    // This would involve careful memory ordering and handling of concurrent modifications.
-    // For Robin Hood, probing sequence is important.
-    size_t initial_index = hashFunction(key) % capacity;
-    size_t current_index = initial_index;
-    size_t probe_distance = 0;
-
-    // Lock-free read means no locks taken here.
-    // We rely on atomic operations and careful state management in TableEntry.
-    do {
-        // Memory order for reading 'in_use' and 'key' should be at least acquire
-        // to synchronize with potential releases during insertion/deletion.
-        if (table[current_index].in_use.load(std::memory_order_acquire)) {
-            if (table[current_index].key == key) { // Assuming key comparison is safe
-                value = table[current_index].value; // Assuming value read is safe
-                std::cout << "Key found: " << key << " with value: " << value << std::endl;
-                return true;
-            }
-            // Robin Hood: check probe distance of the element at current_index
-            // If current element's probe distance is less than our probe_distance,
-            // key cannot be in the table.
-        } else {
-             // Found an empty slot, key is not here if it's not a tombstone scenario
-        }
-
-        // Basic linear probing for now; Robin Hood would be more complex
-        probe_distance++;
-        current_index = (initial_index + probe_distance) % capacity;
-
-        if (probe_distance >= capacity) { // Avoid infinite loop if table is full and key not found
-            break;
-        }
-    } while (current_index != initial_index); // Traversed the whole table or relevant part
-
-    std::cout << "Key not found: " << key << std::endl;
-    return false;
-}
-
-void ConcurrentHashTable::insert(const std::string& key, int value) {
-    std::cout << "Insert key: " << key << " with value: " << value << std::endl;
-    // Placeholder for RCU update and Robin Hood Hashing.
-    // This is a complex operation:
-    // 1. May require table resize if load factor is high.
-    // 2. Robin Hood: find slot, potentially displacing other elements.
-    // 3. RCU: if table structure changes (e.g. resize) or if entries are replaced,
-    //    old versions need to be handled carefully.
-    // A simple non-concurrent, non-Robin Hood version for now:
-    
-    // For RCU, writes are typically synchronized (e.g., with a lock or by a single writer thread)
-    // or use more complex atomic operations like compare-and-swap on pointers to versions.
-    // std::lock_guard<std::mutex> lock(write_mutex); // Example if using a mutex for writers
-
-    if (current_size.load(std::memory_order_relaxed) >= capacity * 0.75) { // Example load factor
-        // resize(capacity * 2); // Resize needs to be RCU-safe if implemented
-        std::cout << "Warning: Table approaching capacity. Resize not yet implemented for RCU." << std::endl;
-    }
-
-    size_t initial_index = hashFunction(key) % capacity;
-    size_t current_index = initial_index;
-    size_t probe_distance = 0;
-    TableEntry new_entry(key, value);
-
-    do {
-        // For insertion, we'd use compare_exchange_strong on 'in_use' or a similar atomic mechanism
-        // to claim a slot. This is highly simplified.
-        bool expected_in_use = false;
-        if (table[current_index].in_use.compare_exchange_strong(expected_in_use, true, std::memory_order_acq_rel)) {
-            // Successfully claimed an empty slot
-            table[current_index].key = key;
-            table[current_index].value = value;
-            // table[current_index].probe_distance = probe_distance; // for Robin Hood
-            current_size.fetch_add(1, std::memory_order_relaxed);
-            std::cout << "Key inserted: " << key << " at index " << current_index << std::endl;
-            return;
-        } else {
-            // Slot is in use. Robin Hood logic would go here to potentially swap
-            // if the new_entry has a smaller probe distance than the existing one.
-            // For simplicity, we just do linear probing.
-            if (table[current_index].key == key) {
-                 // Key already exists, update value (or handle as error/no-op)
-                table[current_index].value = value; // This needs to be atomic or RCU-safe
-                std::cout << "Key already exists: " << key << ". Value updated." << std::endl;
-                return;
-            }
-        }
-        
-        probe_distance++;
-        current_index = (initial_index + probe_distance) % capacity;
-
-        if (probe_distance >= capacity) {
-            std::cerr << "Error: Table is full. Cannot insert key: " << key << std::endl;
-            // Potentially trigger resize or throw error
-            return;
-        }
-    } while (true); // Simplified loop, Robin Hood would have different termination
-
-    // Actual Robin Hood and RCU logic is significantly more complex.
-}
-
-bool ConcurrentHashTable::remove(const std::string& key) {
-    std::cout << "Remove key: " << key << std::endl;
-    // Placeholder for RCU update.
-    // Removal in open addressing can be tricky (e.g., using tombstones).
-    // RCU makes it more complex as readers might still see the old data.
-    // A simple non-concurrent version for now:
-    // std::lock_guard<std::mutex> lock(write_mutex); // Example
-
-    size_t initial_index = hashFunction(key) % capacity;
-    size_t current_index = initial_index;
-    size_t probe_distance = 0;
-
-    do {
-        if (table[current_index].in_use.load(std::memory_order_acquire)) {
-            if (table[current_index].key == key) {
-                // Mark as not in use (or use a tombstone).
-                // This operation must be RCU-safe.
-                // For now, just making it 'not in_use'.
-                table[current_index].in_use.store(false, std::memory_order_release);
-                // table[current_index].key = ""; // Clear key (optional)
-                current_size.fetch_sub(1, std::memory_order_relaxed);
-                std::cout << "Key removed: " << key << std::endl;
-                // Robin Hood: May need to shift subsequent elements back (backward shift deletion).
-                return true;
-            }
-        } else {
-            // Found an empty slot before finding the key.
-            if (true /* not a tombstone or table[current_index] is genuinely empty */) {
-                 std::cout << "Key not found for removal (empty slot encountered): " << key << std::endl;
-                 return false;
-            }
-        }
-
-        probe_distance++;
-        current_index = (initial_index + probe_distance) % capacity;
-        if (probe_distance >= capacity) break; // Avoid infinite loop
-
-    } while (current_index != initial_index); // Should be more robust for probing limit
-
-    std::cout << "Key not found for removal: " << key << std::endl;
-    return false;
-}
-
-// --- RCU specific method placeholders ---
-void ConcurrentHashTable::performRcuUpdate(const std::string& key, int value, bool is_insert) {
-    std::cout << "RCU Update for key: " << key << (is_insert ? " (insert)" : " (remove/update)") << std::endl;
-    // This would involve creating a copy of parts of the table or the entry,
-    // making changes, then atomically swapping pointers, and finally scheduling
-    // the old data for reclamation after a grace period.
-    // For now, it can call insert/remove directly but this isn't true RCU.
-    if (is_insert) {
-        insert(key, value);
-    } else {
-        // This simplified call doesn't distinguish update vs remove for RCU
-        remove(key); 
-    }
-    synchronizeRcu(); // Placeholder for actual RCU synchronization
-}
-
-void ConcurrentHashTable::synchronizeRcu() {
-    std::cout << "RCU Grace period synchronization (placeholder)." << std::endl;
-    // In a real RCU system, this is a critical step.
-    // It ensures that all threads that were reading data at the time of an update
-    // have finished their read operations before the old data is reclaimed.
-    // Common implementations involve epoch tracking or quiescent state detection.
-}
-
-// --- Robin Hood Hashing specific method placeholders ---
-size_t ConcurrentHashTable::robinHoodProbe(const std::string& key, size_t initial_hash_index, bool& found_empty_slot) {
-    std::cout << "Robin Hood probing for key: " << key << " from index: " << initial_hash_index << std::endl;
-    found_empty_slot = false;
-    // Actual Robin Hood probing logic would go here.
-    // It involves checking the probe distance of existing elements
-    // and potentially swapping if the current element to insert has a shorter probe distance.
-    return initial_hash_index; // Placeholder
-}
-
-void ConcurrentHashTable::resolveRobinHoodCollision(TableEntry& new_entry, size_t& current_index) {
-    std::cout << "Resolving Robin Hood collision for entry: " << new_entry.key << " at index: " << current_index << std::endl;
-    // This function would be called during insertion if an element needs to be displaced.
-    // The displaced element would then need to be re-inserted.
-}
-
-// --- Utility ---
-size_t ConcurrentHashTable::hashFunction(const std::string& key) const {
-    // Using std::hash as a basic hash function.
-    // For MAC/IP addresses, more specialized hash functions might be better.
-    return std::hash<std::string>{}(key);
-}
-
-void ConcurrentHashTable::resize(size_t new_capacity) {
-    std::cout << "Resizing table from " << capacity << " to " << new_capacity << std::endl;
-    if (new_capacity <= capacity) {
-        // Potentially log error or handle shrink scenario if supported
-        // For now, only growing is implicitly handled by this placeholder
-        std::cout << "Resize to smaller or same capacity not fully supported by this placeholder." << std::endl;
-        // return; // Or throw
-    }
-
-    // RCU-safe resize is very complex:
-    // 1. Allocate new_table.
-    // 2. Rehash all existing elements from 'table' to 'new_table'.
-    //    - This rehashing must be done carefully if other operations are concurrent.
-    // 3. Atomically update the table pointer (e.g., rcu_table_ptr.store(new_table_raw_ptr)).
-    // 4. After a grace period (synchronize_rcu), delete the old table.
-
-    // Non-concurrent resize placeholder:
-    std::vector<TableEntry> old_table = std::move(table);
-    size_t old_capacity = capacity;
-
-    capacity = new_capacity;
-    table.assign(new_capacity, TableEntry()); // Assigns default-constructed (empty) TableEntry
-    current_size.store(0, std::memory_order_relaxed); // Reset current size before re-inserting
-
-    for (size_t i = 0; i < old_table.size(); ++i) {
-        if (old_table[i].in_use.load(std::memory_order_relaxed)) { // Use relaxed, as this is "stop-the-world"
-            insert(old_table[i].key, old_table[i].value); // Re-insert into the new table
-        }
-    }
-    std::cout << "Table resized. New capacity: " << capacity << ", current elements: " << current_size.load(std::memory_order_relaxed) << std::endl;
-}
+// ConcurrentHashTable is a header-only template. The default string -> int
+// instantiation is compiled once here so that translation units using
+// ConcurrentHashTable<> do not each re-instantiate it.
+template class ConcurrentHashTable<std::string, int>;
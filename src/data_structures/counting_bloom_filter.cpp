@@ -0,0 +1,142 @@
+#include "data_structures/counting_bloom_filter.h"
+#include "data_structures/bloom_filter.h" // For the shared sizing and probe helpers
+#include "utils/hashing.h"
+#include <iostream> // For diagnostics
+
+namespace {
+// Low bit of every nibble.
+constexpr uint64_t kNibbleLowBits = 0x1111111111111111ULL;
+
+// Low bit of each non-zero nibble of 'word'.
+inline uint64_t nonZeroNibbles(uint64_t word) {
+    return (word | (word >> 1) | (word >> 2) | (word >> 3)) & kNibbleLowBits;
+}
+} // namespace
+
+CountingBloomFilter::CountingBloomFilter(uint64_t num_items, double false_positive_prob)
+    : num_counters_(0), num_hash_functions_(0), block_counters_(kCountersPerBlock), current_count_(0) {
+    BloomFilter::calculateOptimalParams(num_items, false_positive_prob, num_counters_, num_hash_functions_);
+    allocateBlocks();
+}
+
+CountingBloomFilter::CountingBloomFilter(uint64_t size, int num_hashes)
+    : num_counters_(size), num_hash_functions_(num_hashes), block_counters_(kCountersPerBlock), current_count_(0) {
+    if (size == 0) {
+        std::cerr << "Warning: CountingBloomFilter size cannot be 0. Defaulting to 1024." << std::endl;
+        num_counters_ = 1024;
+    }
+    if (num_hashes <= 0) {
+        std::cerr << "Warning: CountingBloomFilter num_hash_functions must be positive. Defaulting to 3." << std::endl;
+        num_hash_functions_ = 3;
+    }
+    allocateBlocks();
+}
+
+void CountingBloomFilter::allocateBlocks() {
+    if (num_counters_ == 0) {
+        num_counters_ = 1024;
+    }
+    block_counters_ = num_counters_ < kCountersPerBlock ? num_counters_ : kCountersPerBlock;
+    blocks_.assign((num_counters_ + kCountersPerBlock - 1) / kCountersPerBlock, Block{});
+}
+
+void CountingBloomFilter::makeProbe(const unsigned char* data, size_t len, Probe& probe) const {
+    uint64_t hash = HashUtils::wyhash(data, len, 0);
+    probe.block = BloomFilter::probeBlock(hash, blocks_.size());
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        probe.mask[w] = 0;
+    }
+    // Positions are counters (nibbles) here rather than bits.
+    BloomFilter::forEachProbePosition(hash, num_hash_functions_, block_counters_, [&](uint32_t pos) {
+        probe.mask[pos / kCountersPerWord] |= uint64_t{1} << (4 * (pos % kCountersPerWord));
+    });
+}
+
+bool CountingBloomFilter::containsProbe(const Probe& probe) const {
+    const Block& block = blocks_[probe.block];
+    uint64_t missing = 0;
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        missing |= probe.mask[w] & ~nonZeroNibbles(block.words[w]);
+    }
+    return missing == 0;
+}
+
+void CountingBloomFilter::insert(const std::string& item) {
+    insert(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+void CountingBloomFilter::insert(const unsigned char* data, size_t len) {
+    Probe probe;
+    makeProbe(data, len, probe);
+    Block& block = blocks_[probe.block];
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        uint64_t bits = probe.mask[w];
+        while (bits != 0) {
+            unsigned shift = static_cast<unsigned>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            if (((block.words[w] >> shift) & 0xF) < kMaxCount) {
+                block.words[w] += uint64_t{1} << shift;
+            }
+        }
+    }
+    ++current_count_;
+}
+
+bool CountingBloomFilter::remove(const std::string& item) {
+    return remove(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+bool CountingBloomFilter::remove(const unsigned char* data, size_t len) {
+    Probe probe;
+    makeProbe(data, len, probe);
+    if (!containsProbe(probe)) {
+        return false;
+    }
+    Block& block = blocks_[probe.block];
+    for (size_t w = 0; w < kWordsPerBlock; ++w) {
+        uint64_t bits = probe.mask[w];
+        while (bits != 0) {
+            unsigned shift = static_cast<unsigned>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            if (((block.words[w] >> shift) & 0xF) < kMaxCount) { // Saturated counters stay put
+                block.words[w] -= uint64_t{1} << shift;
+            }
+        }
+    }
+    if (current_count_ > 0) {
+        --current_count_;
+    }
+    return true;
+}
+
+bool CountingBloomFilter::possiblyContains(const std::string& item) const {
+    return possiblyContains(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+bool CountingBloomFilter::possiblyContains(const unsigned char* data, size_t len) const {
+    Probe probe;
+    makeProbe(data, len, probe);
+    return containsProbe(probe);
+}
+
+void CountingBloomFilter::clear() {
+    blocks_.assign(blocks_.size(), Block{});
+    current_count_ = 0;
+}
+
+uint64_t CountingBloomFilter::getSaturatedCounterCount() const {
+    uint64_t saturated = 0;
+    for (const Block& block : blocks_) {
+        for (size_t w = 0; w < kWordsPerBlock; ++w) {
+            uint64_t word = block.words[w];
+            // A nibble is 15 iff all four of its bits are set.
+            uint64_t full = word & (word >> 1) & (word >> 2) & (word >> 3) & kNibbleLowBits;
+            saturated += static_cast<uint64_t>(__builtin_popcountll(full));
+        }
+    }
+    return saturated;
+}
+
+double CountingBloomFilter::getEffectiveFalsePositiveProbability() const {
+    return BloomFilter::blockedFalsePositiveRate(current_count_, blocks_.size(), block_counters_, num_hash_functions_);
+}
@@ -0,0 +1,6 @@
+#include "data_structures/cuckoo_filter.h"
+
+// CuckooFilter is a header-only template; both fingerprint widths are
+// compiled once here.
+template class CuckooFilter<uint8_t>;
+template class CuckooFilter<uint16_t>;
@@ -0,0 +1,5 @@
+#include "data_structures/cuckoo_hash.h"
+
+// CuckooHashTable is a header-only template. The default string -> int
+// instantiation is compiled once here, matching ConcurrentHashTable.
+template class CuckooHashTable<std::string, int>;
@@ -0,0 +1,329 @@
+#include "data_structures/flow_table.h"
+
+#include <algorithm> // For std::min, std::max
+
+// FlowTable keys and entries are trivially copyable, so the ConcurrentHashTable
+// shards serve lookups without taking a lock.
+template class ConcurrentHashTable<FlowKey, FlowEntry>;
+template class ShardedHashTable<FlowKey, FlowEntry>;
+
+uint64_t FlowEntry::deadline() const {
+    uint64_t idle_deadline = idle_timeout != 0 ? last_seen + idle_timeout : 0;
+    uint64_t hard_deadline = hard_timeout != 0 ? first_seen + hard_timeout : 0;
+    if (idle_deadline == 0) {
+        return hard_deadline;
+    }
+    if (hard_deadline == 0) {
+        return idle_deadline;
+    }
+    return std::min(idle_deadline, hard_deadline);
+}
+
+namespace {
+constexpr uint8_t kProtocolTcp = 6;
+} // namespace
+
+FlowKey canonicalFlowKey(const FlowKey& key, bool& reversed) {
+    reversed = key.source_ip > key.dest_ip ||
+               (key.source_ip == key.dest_ip && key.source_port > key.dest_port);
+    if (!reversed) {
+        return key;
+    }
+    return FlowKey(key.dest_ip, key.source_ip, key.dest_port, key.source_port, key.protocol);
+}
+
+FlowTable::FlowTable() : FlowTable(Config()) {}
+
+FlowTable::FlowTable(const Config& config)
+    : config_(config),
+      flows_(config.initial_capacity == 0 ? 16 : config.initial_capacity),
+      generation_(1),
+      update_mutexes_(new PaddedMutex[flows_.getShardCount()]) {
+    if (config_.tick_ms == 0) {
+        std::cerr << "FlowTable: tick_ms must be non-zero, using 1 ms." << std::endl;
+        config_.tick_ms = 1;
+    }
+}
+
+FlowTable::TrackResult FlowTable::track(const FlowKey& key, uint32_t packet_bytes, uint64_t now_ms,
+                                        uint8_t tcp_flags) {
+    TrackResult result;
+    bool reversed = false;
+    FlowKey table_key = config_.conntrack ? canonicalFlowKey(key, reversed) : key;
+    std::lock_guard<std::mutex> lock(updateMutexFor(table_key));
+
+    FlowEntry entry;
+    if (flows_.lookup(table_key, entry)) {
+        if (config_.conntrack) {
+            if (entry.packets == 0) {
+                entry.originator_reversed = reversed; // Expected flow: whoever sends first originates
+            }
+            result.reply = reversed != entry.originator_reversed;
+            result.state = advanceConnLocked(entry, result.reply, key.protocol, tcp_flags);
+            if (result.reply) {
+                ++entry.reply_packets;
+                entry.reply_bytes += packet_bytes;
+            }
+        }
+        ++entry.packets;
+        entry.bytes += packet_bytes;
+        entry.last_seen = std::max(entry.last_seen, now_ms);
+
+        bool closed = entry.tcp_state == TcpState::TIME_WAIT || entry.tcp_state == TcpState::CLOSED;
+        if (closed && (entry.idle_timeout == 0 || entry.idle_timeout > config_.tcp_closing_timeout_ms)) {
+            // The connection is finished: age it out quickly. The deadline moved
+            // earlier, so it needs a fresh timer.
+            entry.idle_timeout = config_.tcp_closing_timeout_ms;
+            armTimerLocked(table_key, entry, now_ms);
+        }
+        // Otherwise the pending timer still points at the old deadline; it
+        // re-arms itself when it fires, so a busy flow costs no timer work per packet.
+        flows_.insert(table_key, entry);
+
+        bool reply = config_.conntrack && result.reply;
+        if ((reply ? entry.cached_reply_state : entry.cached_state) == result.state) {
+            result.cached_rule_id = reply ? entry.cached_reply_rule_id : entry.cached_rule_id;
+            result.cache_generation = reply ? entry.reply_cache_generation : entry.cache_generation;
+        }
+        return result;
+    }
+
+    if (config_.conntrack) {
+        bool opens = (tcp_flags & (TcpFlags::SYN | TcpFlags::ACK | TcpFlags::RST)) == TcpFlags::SYN;
+        if (key.protocol == kProtocolTcp && !opens) {
+            result.state = ConnState::INVALID; // Mid-stream or stray TCP packet: not tracked
+            return result;
+        }
+        entry.originator_reversed = reversed;
+        entry.tcp_state = key.protocol == kProtocolTcp ? TcpState::SYN_SENT : TcpState::NONE;
+        result.state = ConnState::NEW;
+    }
+    entry.packets = 1;
+    entry.bytes = packet_bytes;
+    entry.first_seen = now_ms;
+    entry.last_seen = now_ms;
+    entry.idle_timeout = config_.idle_timeout_ms;
+    entry.hard_timeout = config_.hard_timeout_ms;
+    entry.cache_generation = 0; // Generation 0 is never current: nothing cached yet
+    entry.reply_cache_generation = 0;
+    armTimerLocked(table_key, entry, now_ms);
+    flows_.insert(table_key, entry);
+    result.created = true;
+    return result;
+}
+
+bool FlowTable::expectRelated(const FlowKey& key, uint64_t now_ms) {
+    if (!config_.conntrack) {
+        return false;
+    }
+    FlowKey table_key = tableKey(key);
+    std::lock_guard<std::mutex> lock(updateMutexFor(table_key));
+    FlowEntry entry;
+    if (flows_.lookup(table_key, entry)) {
+        return false;
+    }
+    // No packets yet: the first one decides the direction (see track()).
+    entry.first_seen = now_ms;
+    entry.last_seen = now_ms;
+    entry.idle_timeout = config_.idle_timeout_ms;
+    entry.hard_timeout = config_.hard_timeout_ms;
+    entry.related = true;
+    armTimerLocked(table_key, entry, now_ms);
+    flows_.insert(table_key, entry);
+    return true;
+}
+
+ConnState FlowTable::advanceConnLocked(FlowEntry& entry, bool reply, uint8_t protocol, uint8_t tcp_flags) const {
+    if (protocol != kProtocolTcp) {
+        entry.seen_reply |= reply;
+        return entry.seen_reply ? ConnState::ESTABLISHED : (entry.related ? ConnState::RELATED : ConnState::NEW);
+    }
+
+    bool syn = tcp_flags & TcpFlags::SYN;
+    bool ack = tcp_flags & TcpFlags::ACK;
+    bool opening_syn = syn && !ack && !(tcp_flags & TcpFlags::RST);
+    bool valid = true;
+    switch (entry.tcp_state) {
+        case TcpState::NONE: // Expected connection, first packet
+            valid = opening_syn && !reply;
+            if (valid) {
+                entry.tcp_state = TcpState::SYN_SENT;
+            }
+            break;
+        case TcpState::SYN_SENT:
+            if (reply && syn && ack) {
+                entry.tcp_state = TcpState::SYN_RECV;
+                entry.seen_reply = true;
+            } else if (!(opening_syn && !reply) && !(tcp_flags & TcpFlags::RST)) {
+                valid = false; // Only SYN retransmits or a reset until the SYN+ACK
+            }
+            break;
+        case TcpState::SYN_RECV:
+            if (!reply && ack && !syn) {
+                entry.tcp_state = TcpState::ESTABLISHED;
+            } else if (syn && !(reply && ack)) {
+                valid = false; // Only SYN+ACK retransmits may carry SYN
+            }
+            break;
+        case TcpState::ESTABLISHED:
+        case TcpState::FIN_WAIT:
+        case TcpState::TIME_WAIT:
+            valid = !syn;
+            break;
+        case TcpState::CLOSED:
+            valid = opening_syn && !reply;
+            if (valid) { // Port reuse: start over
+                entry.tcp_state = TcpState::SYN_SENT;
+                entry.seen_reply = false;
+                entry.fin_seen = 0;
+                entry.idle_timeout = config_.idle_timeout_ms;
+            }
+            break;
+    }
+    if (!valid) {
+        return ConnState::INVALID;
+    }
+
+    if ((tcp_flags & TcpFlags::RST) && entry.tcp_state != TcpState::CLOSED) {
+        entry.tcp_state = TcpState::CLOSED;
+    } else if ((tcp_flags & TcpFlags::FIN) &&
+               (entry.tcp_state == TcpState::SYN_RECV || entry.tcp_state == TcpState::ESTABLISHED ||
+                entry.tcp_state == TcpState::FIN_WAIT)) {
+        entry.fin_seen |= reply ? 2 : 1;
+        entry.tcp_state = entry.fin_seen == 3 ? TcpState::TIME_WAIT : TcpState::FIN_WAIT;
+    }
+    return entry.seen_reply ? ConnState::ESTABLISHED : (entry.related ? ConnState::RELATED : ConnState::NEW);
+}
+
+bool FlowTable::isReply(const FlowKey& key, const FlowEntry& entry) const {
+    if (!config_.conntrack) {
+        return false;
+    }
+    bool reversed;
+    canonicalFlowKey(key, reversed);
+    return reversed != entry.originator_reversed;
+}
+
+bool FlowTable::remove(const FlowKey& key) {
+    FlowKey table_key = tableKey(key);
+    std::lock_guard<std::mutex> lock(updateMutexFor(table_key));
+    // The flow's timer stays in the wheel and is discarded when it fires.
+    return flows_.remove(table_key);
+}
+
+bool FlowTable::setTimeouts(const FlowKey& key, uint64_t idle_timeout_ms, uint64_t hard_timeout_ms) {
+    FlowKey table_key = tableKey(key);
+    std::lock_guard<std::mutex> lock(updateMutexFor(table_key));
+    FlowEntry entry;
+    if (!flows_.lookup(table_key, entry)) {
+        return false;
+    }
+    entry.idle_timeout = idle_timeout_ms;
+    entry.hard_timeout = hard_timeout_ms;
+    // The deadline may have moved earlier, so arm a fresh timer; the old one
+    // no longer matches timer_tick and is ignored when it fires.
+    armTimerLocked(table_key, entry, entry.last_seen);
+    flows_.insert(table_key, entry);
+    return true;
+}
+
+bool FlowTable::getCachedRule(const FlowKey& key, int& rule_id, ConnState state) const {
+    FlowEntry entry;
+    if (!flows_.lookup(tableKey(key), entry)) {
+        return false;
+    }
+    uint32_t generation = getGeneration();
+    if (isReply(key, entry)) {
+        if (entry.reply_cache_generation != generation || entry.cached_reply_state != state) {
+            return false;
+        }
+        rule_id = entry.cached_reply_rule_id;
+    } else {
+        if (entry.cache_generation != generation || entry.cached_state != state) {
+            return false;
+        }
+        rule_id = entry.cached_rule_id;
+    }
+    return true;
+}
+
+bool FlowTable::setCachedRule(const FlowKey& key, int rule_id, uint32_t generation, ConnState state) {
+    FlowKey table_key = tableKey(key);
+    std::lock_guard<std::mutex> lock(updateMutexFor(table_key));
+    FlowEntry entry;
+    if (!flows_.lookup(table_key, entry)) {
+        return false;
+    }
+    if (isReply(key, entry)) {
+        entry.cached_reply_rule_id = rule_id;
+        entry.reply_cache_generation = generation;
+        entry.cached_reply_state = state;
+    } else {
+        entry.cached_rule_id = rule_id;
+        entry.cache_generation = generation;
+        entry.cached_state = state;
+    }
+    flows_.insert(table_key, entry);
+    return true;
+}
+
+void FlowTable::invalidateCachedRules() {
+    uint32_t next = generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (next == 0) {
+        generation_.fetch_add(1, std::memory_order_acq_rel); // 0 is reserved for "never cached"
+    }
+}
+
+size_t FlowTable::pendingTimers() const {
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    return wheel_.pending();
+}
+
+void FlowTable::armTimerLocked(const FlowKey& key, FlowEntry& entry, uint64_t now_ms) {
+    uint64_t deadline = entry.deadline();
+    if (deadline == 0) {
+        entry.timer_tick = 0; // Never expires
+        return;
+    }
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    if (wheel_.pending() == 0) {
+        // Idle wheel: jump straight to the present instead of ticking through
+        // the gap on the next advance.
+        std::vector<TimerWheel<FlowKey>::Timer> none;
+        wheel_.advance(now_ms / config_.tick_ms, none);
+    }
+    entry.timer_tick = wheel_.schedule(key, toTick(deadline));
+}
+
+size_t FlowTable::expire(uint64_t now_ms, std::vector<ExpiredFlow>* expired) {
+    // Only ticks that lie entirely in the past are processed, and deadlines are
+    // rounded up to a tick, so a fired timer is never early.
+    std::vector<TimerWheel<FlowKey>::Timer> fired;
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        wheel_.advance(now_ms / config_.tick_ms, fired);
+    }
+
+    size_t removed = 0;
+    for (const auto& timer : fired) {
+        // Packets may still be updating the flow; decide under its shard's lock.
+        std::lock_guard<std::mutex> lock(updateMutexFor(timer.payload));
+        FlowEntry entry;
+        if (!flows_.lookup(timer.payload, entry) || entry.timer_tick != timer.expiry_tick) {
+            continue; // Flow removed, or superseded by a newer timer
+        }
+        uint64_t deadline = entry.deadline();
+        if (deadline != 0 && deadline <= now_ms) {
+            flows_.remove(timer.payload);
+            if (expired) {
+                expired->emplace_back(timer.payload, entry);
+            }
+            ++removed;
+        } else {
+            // Traffic (or new timeouts) pushed the deadline out: re-arm once.
+            armTimerLocked(timer.payload, entry, now_ms);
+            flows_.insert(timer.payload, entry);
+        }
+    }
+    return removed;
+}
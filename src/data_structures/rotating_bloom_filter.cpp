@@ -0,0 +1,190 @@
+#include "data_structures/rotating_bloom_filter.h"
+#include "utils/hashing.h"
+
+namespace {
+// Each added stage halves the previous stage's error target, so a generation's
+// total false-positive rate stays below its target however many stages it grows:
+// p/2 + p/4 + ... < p.
+constexpr double kStageTighteningRatio = 0.5;
+
+// New items this thread inserted, across all filters; drives the periodic
+// stage fill check without a shared counter.
+thread_local uint64_t tls_new_inserts = 0;
+} // namespace
+
+RotatingBloomFilter::RotatingBloomFilter() : RotatingBloomFilter(Config()) {}
+
+RotatingBloomFilter::RotatingBloomFilter(const Config& config, uint64_t now_ms)
+    : config_(config), current_(0), slice_start_ms_(now_ms) {
+    if (config_.generations == 0) {
+        config_.generations = 1;
+    }
+    if (config_.slice_ms == 0) {
+        config_.slice_ms = 1;
+    }
+    if (config_.min_capacity == 0) {
+        config_.min_capacity = 1;
+    }
+    if (config_.max_capacity < config_.min_capacity) {
+        config_.max_capacity = config_.min_capacity;
+    }
+    ring_.reset(new Generation[config_.generations]);
+    ring_[current_].planned_capacity = clampCapacity(static_cast<double>(config_.initial_capacity));
+}
+
+void RotatingBloomFilter::Generation::reset(uint64_t capacity) {
+    size_t count = stage_count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        stages[i].reset();
+    }
+    stage_count.store(0, std::memory_order_relaxed);
+    planned_capacity = capacity;
+}
+
+uint64_t RotatingBloomFilter::keyOf(const unsigned char* data, size_t len) {
+    return HashUtils::wyhash(data, len, 0);
+}
+
+uint64_t RotatingBloomFilter::keyOf(const std::string& item) {
+    return keyOf(reinterpret_cast<const unsigned char*>(item.data()), item.length());
+}
+
+uint64_t RotatingBloomFilter::clampCapacity(double capacity) const {
+    if (capacity < static_cast<double>(config_.min_capacity)) {
+        return config_.min_capacity;
+    }
+    if (capacity > static_cast<double>(config_.max_capacity)) {
+        return config_.max_capacity;
+    }
+    return static_cast<uint64_t>(capacity);
+}
+
+RotatingBloomFilter::Stage* RotatingBloomFilter::addStage(Generation& generation, size_t seen_count) {
+    std::lock_guard<std::mutex> lock(grow_mutex_);
+    size_t count = generation.stage_count.load(std::memory_order_relaxed);
+    if (count != seen_count || count == kMaxStages) {
+        return generation.stages[count - 1].get(); // Grown by another thread, or at the stage limit
+    }
+    uint64_t capacity =
+        count == 0 ? generation.planned_capacity : clampCapacity(2.0 * generation.stages[count - 1]->capacity);
+    double fp = config_.false_positive_prob * kStageTighteningRatio;
+    for (size_t i = 0; i < count; ++i) {
+        fp *= kStageTighteningRatio;
+    }
+    generation.stages[count] = std::make_unique<Stage>(capacity, fp);
+    generation.stage_count.store(count + 1, std::memory_order_release); // Publishes the stage
+    return generation.stages[count].get();
+}
+
+void RotatingBloomFilter::insertKey(uint64_t key) {
+    Generation& generation = ring_[current_];
+    size_t count = generation.stage_count.load(std::memory_order_acquire);
+    Stage* stage = count == 0 ? addStage(generation, 0) : generation.stages[count - 1].get();
+    if (stage->filter.insertKey(key) && ++tls_new_inserts % kFillCheckInterval == 0 &&
+        stage->filter.getApproximateCount() >= stage->capacity) {
+        // The item stays in the full stage; later inserts go to the new one.
+        addStage(generation, count == 0 ? 1 : count);
+    }
+}
+
+bool RotatingBloomFilter::possiblyContainsKey(uint64_t key) const {
+    // Newest first: recently inserted items are the likeliest hits.
+    size_t generations = config_.generations;
+    for (size_t age = 0; age < generations; ++age) {
+        const Generation& generation = ring_[(current_ + generations - age) % generations];
+        size_t count = generation.stage_count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (generation.stages[i]->filter.possiblyContainsKey(key)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint64_t RotatingBloomFilter::observedDistinct(const Generation& generation) const {
+    uint64_t distinct = 0;
+    size_t count = generation.stage_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        distinct += generation.stages[i]->filter.getApproximateCount();
+    }
+    return distinct;
+}
+
+size_t RotatingBloomFilter::advance(uint64_t now_ms) {
+    if (!isRotationDue(now_ms)) {
+        return 0;
+    }
+    uint64_t slices = (now_ms - slice_start_ms_) / config_.slice_ms;
+    slice_start_ms_ += slices * config_.slice_ms;
+
+    // After more slices than generations everything has expired; rotating the
+    // ring once per generation clears it.
+    size_t rotations = slices < config_.generations ? static_cast<size_t>(slices) : config_.generations;
+    for (size_t i = 0; i < rotations; ++i) {
+        uint64_t observed = observedDistinct(ring_[current_]);
+        current_ = (current_ + 1) % config_.generations;
+        ring_[current_].reset(clampCapacity(observed * config_.headroom));
+    }
+    return rotations;
+}
+
+void RotatingBloomFilter::clear(uint64_t now_ms) {
+    uint64_t capacity = getCurrentCapacity();
+    for (size_t i = 0; i < config_.generations; ++i) {
+        ring_[i].reset(0);
+    }
+    ring_[current_].planned_capacity = capacity;
+    slice_start_ms_ = now_ms;
+}
+
+uint64_t RotatingBloomFilter::getCurrentCapacity() const {
+    const Generation& generation = ring_[current_];
+    size_t count = generation.stage_count.load(std::memory_order_acquire);
+    if (count == 0) {
+        return generation.planned_capacity;
+    }
+    uint64_t capacity = 0;
+    for (size_t i = 0; i < count; ++i) {
+        capacity += generation.stages[i]->capacity;
+    }
+    return capacity;
+}
+
+size_t RotatingBloomFilter::getStageCount() const {
+    size_t stages = 0;
+    for (size_t i = 0; i < config_.generations; ++i) {
+        stages += ring_[i].stage_count.load(std::memory_order_acquire);
+    }
+    return stages;
+}
+
+uint64_t RotatingBloomFilter::getMemoryBits() const {
+    uint64_t bits = 0;
+    for (size_t g = 0; g < config_.generations; ++g) {
+        size_t count = ring_[g].stage_count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            bits += ring_[g].stages[i]->filter.getBlockCount() * ConcurrentBloomFilter::kBlockBits;
+        }
+    }
+    return bits;
+}
+
+uint64_t RotatingBloomFilter::getInsertCount() const {
+    uint64_t inserted = 0;
+    for (size_t i = 0; i < config_.generations; ++i) {
+        inserted += observedDistinct(ring_[i]);
+    }
+    return inserted;
+}
+
+double RotatingBloomFilter::getEffectiveFalsePositiveProbability() const {
+    double all_negative = 1.0;
+    for (size_t g = 0; g < config_.generations; ++g) {
+        size_t count = ring_[g].stage_count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            all_negative *= 1.0 - ring_[g].stages[i]->filter.getEffectiveFalsePositiveProbability();
+        }
+    }
+    return 1.0 - all_negative;
+}
@@ -0,0 +1,300 @@
+#include "data_structures/rule_prefilter.h"
+#include "packet_classifier.h" // For PacketFilter, PacketHeader
+#include "utils/ip_utils.h"
+
+namespace {
+
+uint64_t prefixKey(uint8_t length, uint32_t network) {
+    return (static_cast<uint64_t>(length) << 32) | network;
+}
+
+bool isPortWildcard(uint16_t low, uint16_t high) {
+    return low == 0 && high == 0; // PacketFilter's "any port"
+}
+
+} // anonymous namespace
+
+// --- CompiledPrefilter ---
+
+bool CompiledPrefilter::PrefixField::mayMatch(uint32_t address) const {
+    if (wildcard) {
+        return true;
+    }
+    // One probe per prefix length in use.
+    for (uint64_t lengths = active_lengths; lengths != 0; lengths &= lengths - 1) {
+        uint8_t length = static_cast<uint8_t>(__builtin_ctzll(lengths));
+        uint64_t key = prefixKey(length, address & IpUtils::prefixMask(length));
+        if (fuse->possiblyContains(key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CompiledPrefilter::PortField::mayMatch(uint16_t port) const {
+    if (wildcard) {
+        return true;
+    }
+    for (const Range& range : wide_ranges) {
+        if (port >= range.low && port <= range.high) {
+            return true;
+        }
+    }
+    return fuse && fuse->possiblyContains(port);
+}
+
+bool CompiledPrefilter::mayMatch(const PacketHeader& header) const {
+    if (empty_) {
+        return false;
+    }
+    // Cheapest fields first.
+    if ((protocols_[0] & 1) == 0 && (protocols_[header.protocol >> 6] & (uint64_t{1} << (header.protocol & 63))) == 0) {
+        return false;
+    }
+    return dest_port_.mayMatch(header.dest_port) && dest_ip_.mayMatch(header.dest_ip) &&
+           source_port_.mayMatch(header.source_port) && source_ip_.mayMatch(header.source_ip);
+}
+
+// --- PrefixField ---
+
+void RulePrefilter::PrefixField::add(const std::string& prefix) {
+    uint32_t network;
+    uint8_t length;
+    // Empty and /0 prefixes match every address. RuleManager rejects
+    // unparseable ones; should one get here it is treated the same way, so
+    // the pre-filter never rejects a packet the rule would match.
+    if (prefix.empty() || !IpUtils::parseIPv4Prefix(prefix, network, length) || length == 0) {
+        ++wildcard_rules;
+        return;
+    }
+    if (refcounts[prefixKey(length, network)]++ == 0) {
+        dirty = true;
+    }
+    ++length_refcounts[length];
+}
+
+bool RulePrefilter::PrefixField::contains(const std::string& prefix) const {
+    uint32_t network;
+    uint8_t length;
+    if (prefix.empty() || !IpUtils::parseIPv4Prefix(prefix, network, length) || length == 0) {
+        return wildcard_rules != 0;
+    }
+    return refcounts.count(prefixKey(length, network)) != 0;
+}
+
+void RulePrefilter::PrefixField::remove(const std::string& prefix) {
+    uint32_t network;
+    uint8_t length;
+    if (prefix.empty() || !IpUtils::parseIPv4Prefix(prefix, network, length) || length == 0) {
+        --wildcard_rules;
+        return;
+    }
+    auto it = refcounts.find(prefixKey(length, network));
+    if (--it->second == 0) {
+        refcounts.erase(it);
+        dirty = true;
+    }
+    --length_refcounts[length];
+}
+
+void RulePrefilter::PrefixField::publish(CompiledPrefilter::PrefixField& out) {
+    if (dirty || !out.fuse) {
+        std::vector<uint64_t> keys;
+        keys.reserve(refcounts.size());
+        for (const auto& entry : refcounts) {
+            keys.push_back(entry.first);
+        }
+        out.fuse = std::make_shared<const BinaryFuseFilter>(keys);
+        dirty = false;
+    }
+    out.active_lengths = 0;
+    for (uint8_t length = 1; length <= 32; ++length) {
+        if (length_refcounts[length] != 0) {
+            out.active_lengths |= uint64_t{1} << length;
+        }
+    }
+    out.wildcard = wildcard_rules != 0;
+}
+
+void RulePrefilter::PrefixField::clear() {
+    refcounts.clear();
+    for (uint32_t& count : length_refcounts) {
+        count = 0;
+    }
+    wildcard_rules = 0;
+    dirty = true;
+}
+
+// --- PortField ---
+
+void RulePrefilter::PortField::add(uint16_t low, uint16_t high) {
+    if (isPortWildcard(low, high)) {
+        ++wildcard_rules;
+        return;
+    }
+    if (low > high) {
+        return; // Matches no port, so it adds no candidates
+    }
+    if (static_cast<uint32_t>(high - low) < kMaxExpandedPortRange) {
+        for (uint32_t port = low; port <= high; ++port) {
+            dirty |= refcounts[static_cast<uint16_t>(port)]++ == 0;
+        }
+        return;
+    }
+    for (Range& range : wide_ranges) {
+        if (range.low == low && range.high == high) {
+            ++range.refcount;
+            return;
+        }
+    }
+    wide_ranges.push_back(Range{low, high, 1});
+}
+
+bool RulePrefilter::PortField::contains(uint16_t low, uint16_t high) const {
+    if (isPortWildcard(low, high)) {
+        return wildcard_rules != 0;
+    }
+    if (low > high) {
+        return true;
+    }
+    if (static_cast<uint32_t>(high - low) < kMaxExpandedPortRange) {
+        for (uint32_t port = low; port <= high; ++port) {
+            if (refcounts.count(static_cast<uint16_t>(port)) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (const Range& range : wide_ranges) {
+        if (range.low == low && range.high == high) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RulePrefilter::PortField::remove(uint16_t low, uint16_t high) {
+    if (isPortWildcard(low, high)) {
+        --wildcard_rules;
+        return;
+    }
+    if (low > high) {
+        return;
+    }
+    if (static_cast<uint32_t>(high - low) < kMaxExpandedPortRange) {
+        for (uint32_t port = low; port <= high; ++port) {
+            auto it = refcounts.find(static_cast<uint16_t>(port));
+            if (--it->second == 0) {
+                refcounts.erase(it);
+                dirty = true;
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < wide_ranges.size(); ++i) {
+        if (wide_ranges[i].low == low && wide_ranges[i].high == high) {
+            if (--wide_ranges[i].refcount == 0) {
+                wide_ranges[i] = wide_ranges.back();
+                wide_ranges.pop_back();
+            }
+            return;
+        }
+    }
+}
+
+void RulePrefilter::PortField::publish(CompiledPrefilter::PortField& out) {
+    if (dirty || !out.fuse) {
+        std::vector<uint64_t> keys;
+        keys.reserve(refcounts.size());
+        for (const auto& entry : refcounts) {
+            keys.push_back(entry.first);
+        }
+        out.fuse = std::make_shared<const BinaryFuseFilter>(keys);
+        dirty = false;
+    }
+    out.wide_ranges.clear();
+    for (const Range& range : wide_ranges) {
+        out.wide_ranges.push_back(CompiledPrefilter::PortField::Range{range.low, range.high});
+    }
+    out.wildcard = wildcard_rules != 0;
+}
+
+void RulePrefilter::PortField::clear() {
+    refcounts.clear();
+    wide_ranges.clear();
+    wildcard_rules = 0;
+    dirty = true;
+}
+
+// --- RulePrefilter ---
+
+void RulePrefilter::addRule(const PacketFilter& filter) {
+    source_ip_.add(filter.source_ip_prefix);
+    dest_ip_.add(filter.dest_ip_prefix);
+    source_port_.add(filter.source_port_low, filter.source_port_high);
+    dest_port_.add(filter.dest_port_low, filter.dest_port_high);
+    ++protocol_refcounts_[filter.protocol];
+    ++rule_count_;
+    if (batch_depth_ == 0) {
+        publish();
+    }
+}
+
+bool RulePrefilter::contains(const PacketFilter& filter) const {
+    return protocol_refcounts_[filter.protocol] != 0 &&
+           source_ip_.contains(filter.source_ip_prefix) && dest_ip_.contains(filter.dest_ip_prefix) &&
+           source_port_.contains(filter.source_port_low, filter.source_port_high) &&
+           dest_port_.contains(filter.dest_port_low, filter.dest_port_high);
+}
+
+bool RulePrefilter::removeRule(const PacketFilter& filter) {
+    if (!contains(filter)) {
+        return false;
+    }
+    source_ip_.remove(filter.source_ip_prefix);
+    dest_ip_.remove(filter.dest_ip_prefix);
+    source_port_.remove(filter.source_port_low, filter.source_port_high);
+    dest_port_.remove(filter.dest_port_low, filter.dest_port_high);
+    --protocol_refcounts_[filter.protocol];
+    --rule_count_;
+    if (batch_depth_ == 0) {
+        publish();
+    }
+    return true;
+}
+
+void RulePrefilter::endBatch() {
+    if (batch_depth_ > 0 && --batch_depth_ == 0) {
+        publish();
+    }
+}
+
+void RulePrefilter::publish() {
+    source_ip_.publish(compiled_.source_ip_);
+    dest_ip_.publish(compiled_.dest_ip_);
+    source_port_.publish(compiled_.source_port_);
+    dest_port_.publish(compiled_.dest_port_);
+    for (uint64_t& word : compiled_.protocols_) {
+        word = 0;
+    }
+    for (unsigned protocol = 0; protocol < 256; ++protocol) {
+        if (protocol_refcounts_[protocol] != 0) {
+            compiled_.protocols_[protocol >> 6] |= uint64_t{1} << (protocol & 63);
+        }
+    }
+    compiled_.empty_ = rule_count_ == 0;
+}
+
+void RulePrefilter::clear() {
+    source_ip_.clear();
+    dest_ip_.clear();
+    source_port_.clear();
+    dest_port_.clear();
+    for (uint32_t& count : protocol_refcounts_) {
+        count = 0;
+    }
+    rule_count_ = 0;
+    if (batch_depth_ == 0) {
+        publish();
+    }
+}
@@ -0,0 +1,5 @@
+#include "data_structures/sharded_hash.h"
+
+// ShardedHashTable is a header-only template. The default string -> int
+// instantiation is compiled once here, matching ConcurrentHashTable.
+template class ShardedHashTable<std::string, int>;
@@ -0,0 +1,5 @@
+#include "data_structures/swiss_table.h"
+
+// SwissHashTable is a header-only template. The default string -> int
+// instantiation is compiled once here, matching ConcurrentHashTable.
+template class SwissHashTable<std::string, int>;
@@ -1,6 +1,8 @@
 #include "packet_classifier.h"
 #include <algorithm> // For std::sort, std::remove_if, std::find_if
 #include <iostream>  // For placeholder output in skeletons
+#include <chrono>    // For match timestamps and the flow clock
+#include "utils/hashing.h" // For the miss cache flow key
 
 // --- Helper toString() methods for core data structures ---
 // PacketHeader::toString() is in the header (if simple enough) or here.
@@ -19,6 +21,35 @@ std::string PacketHeader::toString() const {
     return ss.str();
 }
 
+bool PacketFilter::hasValidPrefixes() const {
+    uint32_t network;
+    uint8_t length;
+    return (source_ip_prefix.empty() || IpUtils::parseIPv4Prefix(source_ip_prefix, network, length)) &&
+           (dest_ip_prefix.empty() || IpUtils::parseIPv4Prefix(dest_ip_prefix, network, length));
+}
+
+namespace {
+
+// Parses a prefix into (network, mask); empty or unparseable text gives mask 0.
+void compilePrefix(const std::string& prefix, uint32_t& network, uint32_t& mask) {
+    uint8_t length = 0;
+    network = 0;
+    mask = 0;
+    if (!prefix.empty() && IpUtils::parseIPv4Prefix(prefix, network, length)) {
+        mask = IpUtils::prefixMask(length);
+    }
+}
+
+} // anonymous namespace
+
+CompiledFilter::CompiledFilter(const PacketFilter& filter)
+    : source_port_low(filter.source_port_low), source_port_high(filter.source_port_high),
+      dest_port_low(filter.dest_port_low), dest_port_high(filter.dest_port_high), protocol(filter.protocol),
+      conn_state_mask(filter.conn_state_mask) {
+    compilePrefix(filter.source_ip_prefix, source_network, source_mask);
+    compilePrefix(filter.dest_ip_prefix, dest_network, dest_mask);
+}
+
 std::string PacketFilter::toString() const {
     std::stringstream ss;
     ss << "SrcIP_Pfx: " << (source_ip_prefix.empty() ? "any" : source_ip_prefix)
@@ -26,6 +57,13 @@ std::string PacketFilter::toString() const {
        << ", SrcPort: " << (source_port_low == 0 && source_port_high == 0 ? "any" : std::to_string(source_port_low) + "-" + std::to_string(source_port_high))
        << ", DstPort: " << (dest_port_low == 0 && dest_port_high == 0 ? "any" : std::to_string(dest_port_low) + "-" + std::to_string(dest_port_high))
        << ", Proto: " << (protocol == 0 ? "any" : std::to_string(static_cast<int>(protocol)));
+    if (conn_state_mask != 0) {
+        ss << ", State:";
+        if (conn_state_mask & ConnStateMask::NEW) ss << " NEW";
+        if (conn_state_mask & ConnStateMask::ESTABLISHED) ss << " ESTABLISHED";
+        if (conn_state_mask & ConnStateMask::RELATED) ss << " RELATED";
+        if (conn_state_mask & ConnStateMask::INVALID) ss << " INVALID";
+    }
     return ss.str();
 }
 
@@ -62,6 +100,7 @@ std::string ClassificationResult::toString() const {
 PacketClassifier::PacketClassifier(bool enable_bloom_filter_optimization)
     : use_bloom_filter_(enable_bloom_filter_optimization),
       rule_manager_(std::make_unique<RuleManager>()), // Initialize RuleManager
+      rule_set_(nullptr),
       logger_(Logger::getInstance()) {
 
     logger_.info("PacketClassifier: Initializing...");
@@ -75,36 +114,40 @@ PacketClassifier::PacketClassifier(bool enable_bloom_filter_optimization)
     dest_port_tree_ = std::make_unique<IntervalTree>();
 
     if (use_bloom_filter_) {
-        // These values (10000 items, 0.01 FP rate) are placeholders.
-        // They should be configured based on expected rule set size and desired performance.
-        bloom_filter_ = std::make_unique<BloomFilter>(10000, 0.01);
+        rule_prefilter_ = std::make_unique<RulePrefilter>();
         logger_.info("PacketClassifier: Bloom filter optimization enabled.");
     } else {
         logger_.info("PacketClassifier: Bloom filter optimization disabled.");
     }
     
-    // exact_match_table_ = std::make_unique<ConcurrentHashTable>(); // If using
+    // exact_match_table_ = std::make_unique<ConcurrentHashTable<>>(); // If using
     // rule_memory_pool_ = std::make_unique<MemoryPool>(sizeof(ClassificationRule), 1024); // If using
 
+    publishRuleSet(); // classify() always has a snapshot, even before any rule exists
+
     logger_.info("PacketClassifier: Initialization complete.");
 }
 
 PacketClassifier::~PacketClassifier() {
     logger_.info("PacketClassifier: Shutting down...");
+    // No reader can still be inside classify() once the classifier is destroyed.
+    delete rule_set_.load(std::memory_order_acquire);
     // std::unique_ptr members will be automatically deallocated.
 }
 
 // --- Rule Management API ---
 bool PacketClassifier::addRule(const ClassificationRule& rule) {
     logger_.debug("PacketClassifier: Add rule ID: " + std::to_string(rule.rule_id) + " requested.");
+    WriteLockGuard spec_lock(specialized_structures_lock_);
     if (!rule_manager_->addRule(rule)) {
         // RuleManager already logged the specific error (e.g. duplicate, conflict)
         return false;
     }
+    rule_counters_[rule.rule_id] = std::make_shared<RuleCounters>();
+    compileRule(rule);
 
     // If RuleManager added it successfully, update specialized structures
     {
-        WriteLockGuard spec_lock(specialized_structures_lock_);
         if (!updateSpecializedStructuresForRule(rule)) {
             // This is a potential inconsistency state. Specialized structure update failed.
             // Rollback rule addition in RuleManager? Or mark rule as inactive?
@@ -125,25 +168,56 @@ bool PacketClassifier::addRule(const ClassificationRule& rule) {
         //     }
         // }
     }
+    publishRuleSet();
+    invalidateFlowCache(); // Cached per-flow results may now be shadowed by this rule
     logger_.info("PacketClassifier: Rule ID " + std::to_string(rule.rule_id) + " processed successfully.");
     return true;
 }
 
+size_t PacketClassifier::addRules(const std::vector<ClassificationRule>& rules) {
+    logger_.debug("PacketClassifier: Bulk add of " + std::to_string(rules.size()) + " rules requested.");
+    WriteLockGuard spec_lock(specialized_structures_lock_);
+    std::vector<int> added = rule_manager_->addRules(rules);
+    if (added.empty()) {
+        return 0;
+    }
+
+    // One pre-filter rebuild and one snapshot for the whole batch, instead of
+    // one per rule.
+    if (use_bloom_filter_) {
+        rule_prefilter_->beginBatch();
+    }
+    for (int rule_id : added) {
+        const ClassificationRule* rule = rule_manager_->getRule(rule_id);
+        rule_counters_[rule_id] = std::make_shared<RuleCounters>();
+        compileRule(*rule);
+        updateSpecializedStructuresForRule(*rule);
+    }
+    if (use_bloom_filter_) {
+        rule_prefilter_->endBatch();
+    }
+    publishRuleSet();
+    invalidateFlowCache();
+    logger_.info("PacketClassifier: Added " + std::to_string(added.size()) + " of " + std::to_string(rules.size()) +
+                 " rules.");
+    return added.size();
+}
+
 bool PacketClassifier::deleteRule(int rule_id) {
     logger_.debug("PacketClassifier: Delete rule ID: " + std::to_string(rule_id) + " requested.");
 
     // First, attempt to remove from specialized structures.
     // This order (specialized first, then RuleManager) might be safer to avoid
     // having a rule in RuleManager that isn't in specialized structures if this part fails.
+    WriteLockGuard spec_lock(specialized_structures_lock_);
     {
-        WriteLockGuard spec_lock(specialized_structures_lock_);
-        if (!removeRuleFromSpecializedStructures(rule_id)) {
+        const ClassificationRule* existing = rule_manager_->getRule(rule_id);
+        if (!existing || !removeRuleFromSpecializedStructures(*existing)) {
             // Log warning, but proceed to try to remove from RuleManager anyway,
             // as the rule might not have been in specialized structures for some reason.
             logger_.warning("PacketClassifier: Failed to remove rule ID " + std::to_string(rule_id) + 
                             " from specialized structures, or rule was not found there. Proceeding to RuleManager deletion.");
         }
-        // Note: Bloom filter items are not removed in this skeleton.
     }
 
     if (!rule_manager_->deleteRule(rule_id)) {
@@ -152,7 +226,13 @@ bool PacketClassifier::deleteRule(int rule_id) {
         // However, if rule wasn't in specialized structures, failing here is okay.
         return false;
     }
+    rule_counters_.erase(rule_id);
+    compiled_rules_.erase(rule_id);
 
+    // Readers still holding the previous snapshot keep seeing the rule until
+    // they leave their RCU read-side section; nothing they touch is freed early.
+    publishRuleSet();
+    invalidateFlowCache();
     logger_.info("PacketClassifier: Rule ID " + std::to_string(rule_id) + " deleted successfully.");
     return true;
 }
@@ -160,9 +240,15 @@ bool PacketClassifier::deleteRule(int rule_id) {
 bool PacketClassifier::modifyRule(int rule_id, const ClassificationRule& new_rule_data) {
     logger_.debug("PacketClassifier: Modify rule ID: " + std::to_string(rule_id) + " requested.");
 
-    // Get old rule data for Bloom Filter comparison if needed, before RuleManager updates it.
-    // However, direct access to old rule before RuleManager's lock is tricky.
-    // It's better to let RuleManager handle the update first.
+    // Copy the old rule before RuleManager overwrites it: its filter is what
+    // has to come out of the specialized structures (and the rule pre-filter).
+    WriteLockGuard spec_lock(specialized_structures_lock_);
+    const ClassificationRule* existing = rule_manager_->getRule(rule_id);
+    if (!existing) {
+        logger_.warning("PacketClassifier: Rule ID " + std::to_string(rule_id) + " not found for modification.");
+        return false;
+    }
+    ClassificationRule old_rule = *existing;
 
     if (!rule_manager_->modifyRule(rule_id, new_rule_data)) {
         // RuleManager already logged.
@@ -170,10 +256,10 @@ bool PacketClassifier::modifyRule(int rule_id, const ClassificationRule& new_rul
     }
 
     // RuleManager successfully modified it. Now update specialized structures.
+    compileRule(*rule_manager_->getRule(rule_id));
     {
-        WriteLockGuard spec_lock(specialized_structures_lock_);
         // Order: remove old representation, then add new representation.
-        if (!removeRuleFromSpecializedStructures(rule_id)) {
+        if (!removeRuleFromSpecializedStructures(old_rule)) {
              logger_.warning("PacketClassifier: Could not remove old state of modified rule ID " + std::to_string(rule_id) + 
                              " from specialized structures (may not have been there or error).");
         }
@@ -194,6 +280,8 @@ bool PacketClassifier::modifyRule(int rule_id, const ClassificationRule& new_rul
         //     }
         // }
     }
+    publishRuleSet();
+    invalidateFlowCache();
     logger_.info("PacketClassifier: Rule ID " + std::to_string(rule_id) + " modified successfully.");
     return true;
 }
@@ -201,111 +289,161 @@ bool PacketClassifier::modifyRule(int rule_id, const ClassificationRule& new_rul
 
 // --- Classification API ---
 ClassificationResult PacketClassifier::classify(const PacketHeader& header) {
-    // No top-level lock here for rule access; RuleManager's getRulesByPriority() provides a snapshot.
-    // The specialized_structures_lock_ (read mode) would be needed if Tries/IntervalTrees are accessed directly here
-    // AND if their internal operations are not independently thread-safe for reads.
-    // CompressedTrie, IntervalTree skeletons currently don't show internal locking.
-    // For now, assume their lookup methods are thread-safe for concurrent reads.
-    // If not, a RcuUtils::ReadLockGuard(specialized_structures_lock_) would be needed here.
-    ReadLockGuard spec_structures_read_lock(specialized_structures_lock_);
+    // One acquire load replaces the RuleManager lock and rule vector copy; the
+    // RCU read-side section keeps the loaded snapshot alive until we are done.
+    RcuUtils::rcuReadLock();
+    // Cache generations are read before the snapshot. Rule changes publish
+    // first and invalidate second, so a reader that sees a new generation also
+    // loads the new rules, and a result computed from an older snapshot is
+    // only ever cached under the generation it was superseded by.
+    CacheGenerations generations;
+    generations.flow = flow_table_ ? flow_table_->getGeneration() : 0;
+    generations.miss = miss_cache_generation_.load(std::memory_order_acquire);
+    const CompiledRuleSet* rules = rule_set_.load(std::memory_order_acquire);
+    ClassificationResult result = classifySnapshot(*rules, header, generations);
+    RcuUtils::rcuReadUnlock();
+    return result;
+}
 
-    logger_.trace("PacketClassifier: Classifying packet: " + header.toString());
-    ClassificationResult result;
-    if (use_bloom_filter_) {
-        // Use the packet's string representation for the Bloom filter check.
-        std::string packet_representation = header.toString();
-        if (!bloom_filter_->possiblyContains(packet_representation)) {
-            logger_.trace("PacketClassifier: Packet might be rejected by Bloom filter (possiblyContains returned false).");
-            // If bloom_filter_->possiblyContains returns false, it means the item is *definitely not* in the set.
-            // For packet classification, if the Bloom filter is used to store representations of *packets* that
-            // are *known* to match some rule (less common), then a 'false' here means "definitely no rule for this exact packet flow".
-            // More commonly, a Bloom filter might store elements of *rules*. In that case, a 'false' for a packet
-            // characteristic might mean "no rule contains this characteristic".
-            // The current simplistic usage (inserting rule.filter.toString() and packet.toString())
-            // means it's checking if an identical filter string (for a rule) matches an identical packet string.
-            // This is unlikely to be effective.
-            // For this skeleton, we'll log it but proceed, as the Bloom filter strategy needs refinement.
+ClassificationResult PacketClassifier::classifySnapshot(const CompiledRuleSet& rules, const PacketHeader& header,
+                                                        const CacheGenerations& generations) {
+    if (!flow_table_) {
+        return miss_cache_ ? classifyWithMissCache(rules, header, generations.miss) : classifyUncached(rules, header);
+    }
+
+    FlowKey key(header.source_ip, header.dest_ip, header.source_port, header.dest_port, header.protocol);
+    FlowTable::TrackResult tracked = flow_table_->track(key, header.packet_length, flowClockMs(), header.tcp_flags);
+
+    // If rules change while we classify, the result is cached under the old
+    // generation and never served.
+    uint32_t generation = generations.flow;
+    if (tracked.cache_generation == generation) {
+        if (tracked.cached_rule_id < 0) {
+            logger_.trace("PacketClassifier: Flow cache hit (no match) for packet: " + header.toString());
+            return ClassificationResult();
+        }
+        const CompiledRuleSet::Entry* rule = rules.findRule(tracked.cached_rule_id);
+        if (rule) {
+            logger_.trace("PacketClassifier: Flow cache hit for rule ID " + std::to_string(rule->rule_id));
+            return recordMatch(*rule);
         }
+        // Rule vanished without an invalidation reaching us yet; classify normally.
+    }
+
+    ClassificationResult result = classifyUncached(rules, header, tracked.state);
+    flow_table_->setCachedRule(key, result.matched ? result.matched_rule_id : -1, generation, tracked.state);
+    return result;
+}
+
+ClassificationResult PacketClassifier::classifyWithMissCache(const CompiledRuleSet& rules, const PacketHeader& header,
+                                                             uint64_t generation) {
+    // The pre-filter is cheaper than the miss cache, and its misses would only
+    // fill the cache's generations, so such packets never touch it.
+    if (rejectedByPrefilter(rules, header)) {
+        return ClassificationResult();
+    }
+
+    FlowKey flow(header.source_ip, header.dest_ip, header.source_port, header.dest_port, header.protocol);
+    uint64_t key = HashUtils::hashFiveTuple(&flow);
+    uint64_t now = flowClockMs();
+
+    bool rotation_due;
+    bool cached_miss = false;
+    {
+        BigReaderReadGuard read_lock(miss_cache_lock_);
+        rotation_due = miss_cache_->isRotationDue(now);
+        if (!rotation_due) {
+            cached_miss = miss_cache_->possiblyContainsKey(key);
+        }
+    }
+    if (rotation_due) {
+        BigReaderWriteGuard write_lock(miss_cache_lock_);
+        miss_cache_->advance(now);
+        cached_miss = miss_cache_->possiblyContainsKey(key);
+    }
+    if (cached_miss) {
+        logger_.trace("PacketClassifier: Miss cache hit for packet: " + header.toString());
+        return ClassificationResult();
+    }
+
+    // As with the flow cache: a miss computed while rules changed is dropped.
+    // Inserts are lock-free, so the read side suffices; it only keeps
+    // invalidateFlowCache() and rotation from running concurrently.
+    ClassificationResult result = matchRules(rules, header, ConnState::UNTRACKED);
+    if (!result.matched) {
+        BigReaderReadGuard read_lock(miss_cache_lock_);
+        if (miss_cache_generation_.load(std::memory_order_relaxed) == generation) {
+            miss_cache_->insertKey(key);
+        }
+    }
+    return result;
+}
+
+ClassificationResult PacketClassifier::classifyUncached(const CompiledRuleSet& rules, const PacketHeader& header,
+                                                        ConnState state) {
+    // Everything read here belongs to the immutable snapshot, so no lock is
+    // needed. The Tries and IntervalTrees are not consulted yet; once they
+    // are, they belong in CompiledRuleSet as well.
+    logger_.trace("PacketClassifier: Classifying packet: " + header.toString());
+    if (rejectedByPrefilter(rules, header)) {
+        return ClassificationResult();
     }
+    return matchRules(rules, header, state);
+}
 
-    // Get rules sorted by priority from RuleManager
-    std::vector<const ClassificationRule*> rules = rule_manager_->getRulesByPriority();
-            // If bloom_filter_->possiblyContains returns false, it means the item is *definitely not* in the set.
-            // For packet classification, this means no rule *likely* matches this exact packet's representation.
-            // This type of Bloom filter usage is more for "is this specific flow known?"
-            // For general rule matching, the Bloom filter would need to be constructed differently,
-            // e.g., by adding all possible packet n-tuples that could match any rule. This is complex.
-            // Alternative: use Bloom filter to check if parts of the packet (e.g. src_ip) are in any rule.
-
-    // Iterate through rules (sorted by priority)
-    for (const ClassificationRule* rule : rules) {
-        if (!rule || !rule->enabled) continue; 
-
-        // **Placeholder for specialized data structure lookups**
-        // A more optimized approach would involve:
-        // 1. Performing lookups in Tries/IntervalTrees based on packet header fields.
-        //    These lookups would return a set of candidate rule IDs.
-        //    Example: 
-        //      candidate_rules_sip = source_ip_trie_->lookup(header.source_ip_as_string_or_bits);
-        //      candidate_rules_dip = dest_ip_trie_->lookup(header.dest_ip_as_string_or_bits);
-        //      candidate_rules_sport = source_port_tree_->findOverlappingIntervals(header.source_port);
-        //      candidate_rules_dport = dest_port_tree_->findOverlappingIntervals(header.dest_port);
-        //
-        // 2. Intersecting these sets of candidate rule IDs to find rules that match on multiple fields.
-        // 
-        // 3. For rules that are candidates after specialized lookups, then proceed with
-        //    the finer-grained `rule->filter.matches(header)` for any remaining checks
-        //    not covered by the specialized structures (e.g., exact protocol if not in a specialized table).
-
-        // Current skeleton: directly call rule->filter.matches() for each rule.
-        // This relies on PacketFilter::matches() to do its part (protocol, ports).
-        // IP prefix matching is assumed to be implicitly handled if this rule was chosen
-        // by a (yet-to-be-implemented) specialized lookup phase.
-        // For now, filter.matches() is simplified and doesn't do IP prefix checks itself.
-        
-        if (rule->filter.matches(header)) {
-            // Conceptual: At this point, if we had a preceding specialized lookup phase,
-            // this rule would be one of the candidates. The call to rule->filter.matches()
-            // would then be a final validation or for fields not covered by specialized structures.
-
-            // If PacketFilter::matches is the *only* check (as in current simple skeleton),
-            // it needs to be comprehensive enough for correctness, though it won't be performant
-            // for all field types (like IP prefixes).
-
-            result.matched = true;
-            result.matched_rule_id = rule->rule_id;
-            result.actions = rule->actions;
-            
-            auto now = std::chrono::system_clock::now();
-            auto epoch_time = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-            if (rule_manager_->incrementRuleMatchCount(rule->rule_id, epoch_time)) {
-                // Successfully incremented
-            } else {
-                logger_.warning("PacketClassifier: Failed to increment match count for rule ID " + std::to_string(rule->rule_id));
-            }
-            
-            logger_.debug("PacketClassifier: Packet matched rule ID " + std::to_string(rule->rule_id) + " using basic filter.matches().");
-            return result; // First match (highest priority) wins
+bool PacketClassifier::rejectedByPrefilter(const CompiledRuleSet& rules, const PacketHeader& header) const {
+    if (rules.prefilter && !rules.prefilter->mayMatch(header)) {
+        // Some field of the packet is excluded by every enabled rule, so no
+        // rule can match: skip rule evaluation (typical for scan traffic).
+        logger_.trace("PacketClassifier: Packet rejected by rule pre-filter.");
+        return true;
+    }
+    return false;
+}
+
+ClassificationResult PacketClassifier::matchRules(const CompiledRuleSet& rules, const PacketHeader& header,
+                                                  ConnState state) {
+    // Rules are enabled-only and sorted by priority; first match wins.
+    // PacketFilter::matches() checks every field (state, protocol, ports, IP prefixes).
+    for (const CompiledRuleSet::Entry& rule : rules.rules) {
+        if (rule.filter.matches(header, state)) {
+            logger_.debug("PacketClassifier: Packet matched rule ID " + std::to_string(rule.rule_id) + ".");
+            return recordMatch(rule);
         }
     }
 
     logger_.trace("PacketClassifier: Packet did not match any enabled rules after iterating all.");
     // Define a default action if no rule matches.
     // For example, ActionType::DROP or a default FORWARD rule (not implemented here).
-    result.matched = false;
-    result.matched_rule_id = -1; // Or some indicator for "no match"
-    // result.actions.primary_action = ActionList::ActionType::DROP; // Example default
     logger_.debug("PacketClassifier: No explicit rule matched. Applying default action (if any defined, otherwise 'no match').");
+    return ClassificationResult();
+}
 
-    return result; 
+ClassificationResult PacketClassifier::recordMatch(const CompiledRuleSet::Entry& rule) {
+    auto now = std::chrono::system_clock::now();
+    auto epoch_time = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    rule.counters->match_count.fetch_add(1, std::memory_order_relaxed);
+    rule.counters->last_match_time.store(static_cast<uint64_t>(epoch_time), std::memory_order_relaxed);
+
+    ClassificationResult result;
+    result.matched = true;
+    result.matched_rule_id = rule.rule_id;
+    result.actions = *rule.actions;
+    return result;
 }
 
 std::vector<ClassificationResult> PacketClassifier::classifyBatch(const std::vector<PacketHeader>& headers) {
     // No top-level PacketClassifier lock here for rule access.
-    // Each call to classify() will get a fresh snapshot if needed, or RuleManager handles it.
+    // Each call to classify() loads the current CompiledRuleSet, so a rule change mid-batch applies from the next packet.
+    logger_.debug("PacketClassifier: Classifying batch of " + std::to_string(headers.size()) + " packets.");
+    if (batch_pool_ && headers.size() >= kParallelBatchThreshold) {
+        std::vector<ClassificationResult> results(headers.size());
+        // Chunks of 64 packets keep per-task overhead small; idle workers steal the rest.
+        batch_pool_->parallelFor(0, headers.size(), [&](size_t i) { results[i] = classify(headers[i]); }, 64);
+        return results;
+    }
     std::vector<ClassificationResult> results;
     results.reserve(headers.size());
-    logger_.debug("PacketClassifier: Classifying batch of " + std::to_string(headers.size()) + " packets.");
     for (const auto& header : headers) {
         // In a batch, can optimize by not re-evaluating common parts for each packet if patterns exist.
         // For this skeleton, just call single classify.
@@ -314,41 +452,108 @@ std::vector<ClassificationResult> PacketClassifier::classifyBatch(const std::vec
     return results;
 }
 
+void PacketClassifier::enableParallelBatch(size_t num_threads) {
+    batch_pool_ = std::make_unique<RcuUtils::WorkStealingThreadPool>(num_threads);
+    logger_.info("PacketClassifier: Parallel batch classification enabled (" +
+                 std::to_string(batch_pool_->getThreadCount()) + " threads).");
+}
+
+// --- Flow Cache API ---
+void PacketClassifier::enableFlowCache(const FlowTable::Config& config) {
+    // Not synchronised with classify(); enable before classifying packets.
+    flow_table_ = std::make_unique<FlowTable>(config);
+    logger_.info("PacketClassifier: Flow cache enabled (idle timeout " + std::to_string(config.idle_timeout_ms) +
+                 " ms, hard timeout " + std::to_string(config.hard_timeout_ms) + " ms).");
+}
+
+size_t PacketClassifier::expireFlows(uint64_t now_ms, std::vector<FlowTable::ExpiredFlow>* expired) {
+    if (!flow_table_) {
+        return 0;
+    }
+    size_t removed = flow_table_->expire(now_ms, expired);
+    if (removed > 0) {
+        logger_.debug("PacketClassifier: Expired " + std::to_string(removed) + " flows.");
+    }
+    return removed;
+}
+
+size_t PacketClassifier::expireFlows() {
+    return expireFlows(flowClockMs());
+}
+
+uint64_t PacketClassifier::flowClockMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void PacketClassifier::invalidateFlowCache() {
+    if (flow_table_) {
+        flow_table_->invalidateCachedRules();
+    }
+    if (miss_cache_) {
+        BigReaderWriteGuard write_lock(miss_cache_lock_);
+        miss_cache_generation_.fetch_add(1, std::memory_order_release);
+        miss_cache_->clear(flowClockMs());
+    }
+}
+
+void PacketClassifier::enableMissCache(const RotatingBloomFilter::Config& config) {
+    // Not synchronised with classify(); enable before classifying packets.
+    miss_cache_ = std::make_unique<RotatingBloomFilter>(config, flowClockMs());
+    logger_.info("PacketClassifier: Miss cache enabled (" + std::to_string(config.generations) + " generations of " +
+                 std::to_string(config.slice_ms) + " ms).");
+}
+
 // --- Statistics API ---
+// Match counts live in the RuleCounters shared with the compiled rule sets
+// (RuleManager's own counters are no longer bumped per packet).
 std::map<int, uint64_t> PacketClassifier::getStatistics() const {
-    //RcuUtils::ReadLockGuard r_lock(rule_management_lock_); // No longer needed, RuleManager handles its own locking
     logger_.debug("PacketClassifier: Retrieving all rule statistics.");
     std::map<int, uint64_t> stats;
-    std::map<int, const ClassificationRule*> all_rules = rule_manager_->getAllRules();
-    for (const auto& pair : all_rules) {
-        if (pair.second) { // Check if rule pointer is not null
-            stats[pair.first] = pair.second->match_count;
-        }
+    ReadLockGuard spec_lock(specialized_structures_lock_);
+    for (const auto& pair : rule_counters_) {
+        stats[pair.first] = pair.second->match_count.load(std::memory_order_relaxed);
     }
     return stats;
 }
 
 uint64_t PacketClassifier::getRuleStatistics(int rule_id) const {
-    //RcuUtils::ReadLockGuard r_lock(rule_management_lock_); // No longer needed
     logger_.debug("PacketClassifier: Retrieving statistics for rule ID: " + std::to_string(rule_id));
-    const ClassificationRule* rule = rule_manager_->getRule(rule_id);
-    if (rule) {
-        return rule->match_count;
+    ReadLockGuard spec_lock(specialized_structures_lock_);
+    auto it = rule_counters_.find(rule_id);
+    if (it != rule_counters_.end()) {
+        return it->second->match_count.load(std::memory_order_relaxed);
     }
     logger_.warning("PacketClassifier: Rule ID " + std::to_string(rule_id) + " not found for statistics.");
     return 0;
 }
 
 void PacketClassifier::resetStatistics() {
-    //RcuUtils::WriteLockGuard w_lock(rule_management_lock_); // No longer needed
     logger_.info("PacketClassifier: Resetting all rule statistics requested.");
-    rule_manager_->resetAllRuleStatistics();
+    ReadLockGuard spec_lock(specialized_structures_lock_); // Only the atomic counters change
+    for (auto& pair : rule_counters_) {
+        pair.second->match_count.store(0, std::memory_order_relaxed);
+        pair.second->last_match_time.store(0, std::memory_order_relaxed);
+    }
 }
 
 void PacketClassifier::resetRuleStatistics(int rule_id) {
-    //RcuUtils::WriteLockGuard w_lock(rule_management_lock_); // No longer needed
     logger_.info("PacketClassifier: Resetting statistics for rule ID: " + std::to_string(rule_id) + " requested.");
-    rule_manager_->resetRuleStatistics(rule_id);
+    ReadLockGuard spec_lock(specialized_structures_lock_);
+    auto it = rule_counters_.find(rule_id);
+    if (it == rule_counters_.end()) {
+        logger_.warning("PacketClassifier: Rule ID " + std::to_string(rule_id) + " not found for statistics reset.");
+        return;
+    }
+    it->second->match_count.store(0, std::memory_order_relaxed);
+    it->second->last_match_time.store(0, std::memory_order_relaxed);
+}
+
+uint64_t PacketClassifier::getRuleSetVersion() const {
+    RcuUtils::rcuReadLock();
+    uint64_t version = rule_set_.load(std::memory_order_acquire)->version;
+    RcuUtils::rcuReadUnlock();
+    return version;
 }
 
 
@@ -388,70 +593,88 @@ bool PacketClassifier::updateSpecializedStructuresForRule(const ClassificationRu
     }
     // Similar for dest_port_tree_
 
-    // Example for Bloom Filter update when a rule is added/enabled
+    // Register the rule's field values with the pre-filter. Disabled rules can
+    // never match, so they are not added; removeRuleFromSpecializedStructures()
+    // takes an enabled rule out again when it is deleted or modified.
     if (rule.enabled && use_bloom_filter_) {
-        // Add a representation of the rule to the Bloom filter.
-        // This helps in pre-filtering packets if the Bloom filter is queried correctly.
-        // The string representation needs to be consistent and capture the essence of the filter.
-        bloom_filter_->insert(rule.filter.toString()); 
-        logger_.debug("Conceptual: Updated Bloom Filter for enabled rule ID " + std::to_string(rule.rule_id));
+        rule_prefilter_->addRule(rule.filter);
+        logger_.debug("PacketClassifier: Added rule ID " + std::to_string(rule.rule_id) + " to the rule pre-filter.");
     }
-    // Note: If a rule is disabled, removing its specific elements from a standard Bloom filter is not possible.
-    // The filter would need to be rebuilt or be a Counting Bloom Filter.
 
     return true;
 }
 
-bool PacketClassifier::removeRuleFromSpecializedStructures(int rule_id) {
+bool PacketClassifier::removeRuleFromSpecializedStructures(const ClassificationRule& rule) {
     WriteLockGuard spec_lock(specialized_structures_lock_);
-    
-    // Fetch the rule details from RuleManager to know what to remove.
-    // This is important because RuleManager is the source of truth for rule definitions.
-    // If the rule is already deleted from RuleManager (e.g. in deleteRule flow),
-    // then this function might receive a rule_id for which getRule returns nullptr.
-    // In such a case, we might not have the filter details.
-    // The specialized data structures should ideally support removal by just rule_id if possible
-    // (e.g., by scanning or having reverse maps, though less efficient).
-    const ClassificationRule* rule = rule_manager_->getRule(rule_id); 
-                                       // ^ This might be called *after* rule is deleted from manager.
-                                       // This is a design consideration.
-                                       // For modify: rule still exists. For delete: rule might be gone.
-                                       // Let's assume for delete, we might need rule data passed in, or specialized structures handle rule_id only.
-
-    if (!rule) {
-         logger_.warning("PacketClassifier: Rule ID " + std::to_string(rule_id) + " not found in RuleManager during removeRuleFromSpecializedStructures. Attempting removal by ID only if structures support it.");
-         // Conceptual: If tries/trees support remove_by_rule_id(rule_id)
-         // source_ip_trie_->remove_associated_rule(rule_id);
-         // dest_ip_trie_->remove_associated_rule(rule_id);
-         // source_port_tree_->remove_associated_rule(rule_id);
-         // dest_port_tree_->remove_associated_rule(rule_id);
-         logger_.debug("Conceptual: Attempting to remove rule ID " + std::to_string(rule_id) + " from all specialized structures by ID only.");
-         return true; // Assuming this operation is attempted.
-    }
-
-    logger_.trace("PacketClassifier: Removing rule ID: " + std::to_string(rule_id) + " (Filter: " + rule->filter.toString() + ") from specialized structures.");
+    // The caller passes the rule as it was when its elements were added (for
+    // modify, a copy taken before RuleManager applied the change), so exactly
+    // those elements can be taken out again.
+    int rule_id = rule.rule_id;
+    logger_.trace("PacketClassifier: Removing rule ID: " + std::to_string(rule_id) + " (Filter: " + rule.filter.toString() + ") from specialized structures.");
     
     // Example for source IP prefix:
-    if (!rule->filter.source_ip_prefix.empty()) {
+    if (!rule.filter.source_ip_prefix.empty()) {
         // Conceptual: source_ip_trie_->remove(parsed_prefix, rule_id);
-        logger_.debug("Conceptual: Remove src_ip_prefix '" + rule->filter.source_ip_prefix + "' for rule " + std::to_string(rule_id) + " from source_ip_trie_.");
+        logger_.debug("Conceptual: Remove src_ip_prefix '" + rule.filter.source_ip_prefix + "' for rule " + std::to_string(rule_id) + " from source_ip_trie_.");
     }
     // Similar for dest_ip_trie_
 
     // Example for source port range:
-    if (rule->filter.source_port_low != 0 || rule->filter.source_port_high != 0) {
-        // Conceptual: source_port_tree_->remove(rule->filter.source_port_low, rule->filter.source_port_high, rule->rule_id);
+    if (rule.filter.source_port_low != 0 || rule.filter.source_port_high != 0) {
+        // Conceptual: source_port_tree_->remove(rule.filter.source_port_low, rule.filter.source_port_high, rule.rule_id);
         logger_.debug("Conceptual: Remove src_port_range for rule " + std::to_string(rule_id) + " from source_port_tree_.");
     }
     // Similar for dest_port_tree_
 
-    // Note: Bloom filter elements are typically not removed. If this rule significantly
-    // changes the profile, the Bloom filter might need rebuilding or be a counting variant.
-    // For this skeleton, no action for Bloom filter on removal.
+    // Undo the pre-filter registration made when the rule was added (only
+    // enabled rules were added, see updateSpecializedStructuresForRule).
+    if (rule.enabled && use_bloom_filter_) {
+        if (!rule_prefilter_->removeRule(rule.filter)) {
+            logger_.warning("PacketClassifier: Rule pre-filter did not contain rule ID " + std::to_string(rule_id) + ".");
+        }
+    }
 
     return true;
 }
 
+void PacketClassifier::compileRule(const ClassificationRule& rule) {
+    auto counters = rule_counters_.find(rule.rule_id);
+    if (counters == rule_counters_.end()) {
+        counters = rule_counters_.emplace(rule.rule_id, std::make_shared<RuleCounters>()).first;
+    }
+    compiled_rules_[rule.rule_id] = CompiledRuleSet::Entry{rule.rule_id, rule.priority, CompiledFilter(rule.filter),
+                                                           std::make_shared<const ActionList>(rule.actions),
+                                                           counters->second};
+}
+
+void PacketClassifier::publishRuleSet() {
+    // Caller holds specialized_structures_lock_ for writing, so RuleManager's
+    // rule pointers stay valid while they are copied into the snapshot.
+    auto next = std::make_unique<CompiledRuleSet>();
+    const CompiledRuleSet* previous = rule_set_.load(std::memory_order_relaxed);
+    next->version = previous ? previous->version + 1 : 0;
+
+    // Rules were compiled when they changed, so this only copies fixed-size
+    // entries; the pre-filter snapshot shares its fuse filters.
+    std::vector<const ClassificationRule*> by_priority = rule_manager_->getRulesByPriority();
+    next->rules.reserve(by_priority.size());
+    for (const ClassificationRule* rule : by_priority) {
+        if (!rule || !rule->enabled) continue;
+        next->index_by_id.emplace(rule->rule_id, next->rules.size());
+        next->rules.push_back(compiled_rules_.at(rule->rule_id));
+    }
+    if (use_bloom_filter_) {
+        next->prefilter = rule_prefilter_->snapshot();
+    }
+
+    rule_set_.store(next.release(), std::memory_order_release);
+    if (previous) {
+        RcuUtils::callRcu([previous]() { delete previous; });
+    }
+    logger_.debug("PacketClassifier: Published rule set version " +
+                  std::to_string(rule_set_.load(std::memory_order_relaxed)->version) + ".");
+}
+
 // Placeholder for IP parsing utilities - would need robust implementation
 // std::string PacketClassifier::ipPrefixToBitString(const std::string& ip_prefix) { /* ... */ return ""; }
 // uint32_t PacketClassifier::ipStringToUint32(const std::string& ip_str) { /* ... */ return 0; }
@@ -0,0 +1,359 @@
+#include "utils/hashing.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h> // SSE4.2 crc32, AVX2 gathers
+#define HASHING_X86_64 1
+#endif
+
+namespace HashUtils {
+
+// ============================================================================
+// CRC32C
+// ============================================================================
+
+namespace {
+
+// Reflected Castagnoli polynomial.
+constexpr uint32_t kCrc32cPoly = 0x82F63B78u;
+
+struct Crc32cTable {
+    uint32_t entries[256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? kCrc32cPoly : 0);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+const Crc32cTable& crc32cTable() {
+    static const Crc32cTable table;
+    return table;
+}
+
+#ifdef HASHING_X86_64
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(const void* data, size_t len, uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t c = ~crc;
+    while (len >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+        p += 8;
+        len -= 8;
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    if (len >= 4) {
+        uint32_t word;
+        std::memcpy(&word, p, 4);
+        c32 = _mm_crc32_u32(c32, word);
+        p += 4;
+        len -= 4;
+    }
+    while (len--) {
+        c32 = _mm_crc32_u8(c32, *p++);
+    }
+    return ~c32;
+}
+#endif
+
+using Crc32cFunction = uint32_t (*)(const void*, size_t, uint32_t);
+
+Crc32cFunction resolveCrc32c() {
+#ifdef HASHING_X86_64
+    if (hasHardwareCrc32c()) {
+        return crc32cHardware;
+    }
+#endif
+    return crc32cSoftware;
+}
+
+} // namespace
+
+bool hasHardwareCrc32c() {
+#ifdef HASHING_X86_64
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32cSoftware(const void* data, size_t len, uint32_t crc) {
+    const uint32_t* table = crc32cTable().entries;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t c = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    }
+    return ~c;
+}
+
+uint32_t crc32c(const void* data, size_t len, uint32_t crc) {
+    static const Crc32cFunction implementation = resolveCrc32c();
+    return implementation(data, len, crc);
+}
+
+// ============================================================================
+// Toeplitz
+// ============================================================================
+
+const uint8_t kDefaultRssKey[40] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67,
+    0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb,
+    0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30,
+    0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+namespace {
+// The 32 key bits starting at bit offset 'bit' (MSB-first).
+uint32_t keyWindow(const uint8_t* key, size_t key_len, size_t bit) {
+    uint32_t window = 0;
+    for (size_t i = 0; i < 32; ++i) {
+        size_t b = bit + i;
+        uint32_t key_bit = b / 8 < key_len ? (key[b / 8] >> (7 - b % 8)) & 1 : 0;
+        window = (window << 1) | key_bit;
+    }
+    return window;
+}
+
+void putBigEndian32(uint8_t* out, uint32_t v) {
+    out[0] = static_cast<uint8_t>(v >> 24);
+    out[1] = static_cast<uint8_t>(v >> 16);
+    out[2] = static_cast<uint8_t>(v >> 8);
+    out[3] = static_cast<uint8_t>(v);
+}
+} // namespace
+
+uint32_t toeplitz(const uint8_t* data, size_t len, const uint8_t* key, size_t key_len) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < len; ++i) {
+        for (int bit = 7; bit >= 0; --bit) {
+            if ((data[i] >> bit) & 1) {
+                result ^= keyWindow(key, key_len, i * 8 + (7 - bit));
+            }
+        }
+    }
+    return result;
+}
+
+ToeplitzHasher::ToeplitzHasher(const uint8_t* key, size_t key_len)
+    : max_input_len_(key_len >= 4 ? key_len - 4 : 0), table_(max_input_len_ * 256, 0) {
+    for (size_t pos = 0; pos < max_input_len_; ++pos) {
+        uint32_t windows[8];
+        for (int bit = 0; bit < 8; ++bit) {
+            windows[bit] = keyWindow(key, key_len, pos * 8 + bit);
+        }
+        for (uint32_t value = 0; value < 256; ++value) {
+            uint32_t h = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (value & (0x80u >> bit)) {
+                    h ^= windows[bit];
+                }
+            }
+            table_[pos * 256 + value] = h;
+        }
+    }
+}
+
+uint32_t ToeplitzHasher::hash(const uint8_t* data, size_t len) const {
+    if (len > max_input_len_) {
+        len = max_input_len_; // Key too short for the rest of the input
+    }
+    uint32_t result = 0;
+    for (size_t i = 0; i < len; ++i) {
+        result ^= table_[i * 256 + data[i]];
+    }
+    return result;
+}
+
+uint32_t ToeplitzHasher::hashIPv4Tuple(uint32_t source_ip, uint32_t dest_ip, uint16_t source_port,
+                                       uint16_t dest_port) const {
+    uint8_t input[12];
+    putBigEndian32(input, source_ip);
+    putBigEndian32(input + 4, dest_ip);
+    input[8] = static_cast<uint8_t>(source_port >> 8);
+    input[9] = static_cast<uint8_t>(source_port);
+    input[10] = static_cast<uint8_t>(dest_port >> 8);
+    input[11] = static_cast<uint8_t>(dest_port);
+    return hash(input, sizeof(input));
+}
+
+uint32_t ToeplitzHasher::hashIPv4(uint32_t source_ip, uint32_t dest_ip) const {
+    uint8_t input[8];
+    putBigEndian32(input, source_ip);
+    putBigEndian32(input + 4, dest_ip);
+    return hash(input, sizeof(input));
+}
+
+// ============================================================================
+// MurmurHash3_x86_32
+// ============================================================================
+
+namespace {
+constexpr uint32_t kMurmurC1 = 0xcc9e2d51u;
+constexpr uint32_t kMurmurC2 = 0x1b873593u;
+
+inline uint32_t rotl32(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+inline uint32_t murmurScrambleBlock(uint32_t k) {
+    k *= kMurmurC1;
+    k = rotl32(k, 15);
+    return k * kMurmurC2;
+}
+
+inline uint32_t murmurFinalize(uint32_t h, size_t len) {
+    h ^= static_cast<uint32_t>(len);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+#ifdef HASHING_X86_64
+// Eight-lane versions of the scalar steps above; lane i hashes key i.
+__attribute__((target("avx2")))
+inline __m256i rotl32x8(__m256i x, int r) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, r), _mm256_srli_epi32(x, 32 - r));
+}
+
+__attribute__((target("avx2")))
+inline __m256i murmurScrambleBlockx8(__m256i k) {
+    k = _mm256_mullo_epi32(k, _mm256_set1_epi32(static_cast<int>(kMurmurC1)));
+    k = rotl32x8(k, 15);
+    return _mm256_mullo_epi32(k, _mm256_set1_epi32(static_cast<int>(kMurmurC2)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i murmurBodyx8(__m256i h, __m256i k) {
+    h = _mm256_xor_si256(h, murmurScrambleBlockx8(k));
+    h = rotl32x8(h, 13);
+    return _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(h, 2), h),
+                            _mm256_set1_epi32(static_cast<int>(0xe6546b64u))); // h * 5 + n
+}
+
+__attribute__((target("avx2")))
+inline __m256i murmurFinalizex8(__m256i h, size_t len) {
+    h = _mm256_xor_si256(h, _mm256_set1_epi32(static_cast<int>(len)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x85ebca6bu)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0xc2b2ae35u)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+// Gathers the little-endian 32-bit word at byte 'offset' of eight keys spaced
+// 'stride' bytes apart. Every gathered word lies inside its own key.
+__attribute__((target("avx2")))
+inline __m256i gatherWordx8(const uint8_t* keys, int stride, int offset) {
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(keys + offset), offsets, 1);
+}
+
+__attribute__((target("avx2")))
+void murmur3FiveTuplex8(const uint8_t* keys, uint32_t seed, uint32_t* out) {
+    const int stride = static_cast<int>(kFiveTupleKeySize);
+    __m256i h = _mm256_set1_epi32(static_cast<int>(seed));
+    h = murmurBodyx8(h, gatherWordx8(keys, stride, 0));
+    h = murmurBodyx8(h, gatherWordx8(keys, stride, 4));
+    h = murmurBodyx8(h, gatherWordx8(keys, stride, 8));
+    // 1-byte tail (protocol): top byte of the word ending at the key's last byte.
+    __m256i tail = _mm256_srli_epi32(gatherWordx8(keys, stride, 9), 24);
+    h = _mm256_xor_si256(h, murmurScrambleBlockx8(tail));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), murmurFinalizex8(h, kFiveTupleKeySize));
+}
+
+__attribute__((target("avx2")))
+void murmur3Macx8(const uint8_t* keys, uint32_t seed, uint32_t* out) {
+    const int stride = static_cast<int>(kMacKeySize);
+    __m256i h = _mm256_set1_epi32(static_cast<int>(seed));
+    h = murmurBodyx8(h, gatherWordx8(keys, stride, 0));
+    // 2-byte tail: upper half of the word ending at the key's last byte.
+    __m256i tail = _mm256_srli_epi32(gatherWordx8(keys, stride, 2), 16);
+    h = _mm256_xor_si256(h, murmurScrambleBlockx8(tail));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), murmurFinalizex8(h, kMacKeySize));
+}
+#endif
+
+using Batch8Function = void (*)(const uint8_t*, uint32_t, uint32_t*);
+
+void hashBatch(const void* keys, size_t n, size_t key_size, uint32_t* out, uint32_t seed, Batch8Function x8) {
+    const uint8_t* p = static_cast<const uint8_t*>(keys);
+    size_t i = 0;
+    if (x8 && hasAvx2()) {
+        for (; i + 8 <= n; i += 8) {
+            x8(p + i * key_size, seed, out + i);
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = murmur3(p + i * key_size, key_size, seed);
+    }
+}
+} // namespace
+
+uint32_t murmur3(const void* data, size_t len, uint32_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const size_t nblocks = len / 4;
+    uint32_t h = seed;
+
+    for (size_t i = 0; i < nblocks; ++i) {
+        uint32_t k;
+        std::memcpy(&k, p + i * 4, 4);
+        h ^= murmurScrambleBlock(k);
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64u;
+    }
+
+    const uint8_t* tail = p + nblocks * 4;
+    uint32_t k = 0;
+    switch (len & 3) {
+    case 3: k ^= static_cast<uint32_t>(tail[2]) << 16; // fall through
+    case 2: k ^= static_cast<uint32_t>(tail[1]) << 8;  // fall through
+    case 1:
+        k ^= tail[0];
+        h ^= murmurScrambleBlock(k);
+    }
+    return murmurFinalize(h, len);
+}
+
+bool hasAvx2() {
+#ifdef HASHING_X86_64
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool hasAvx512() {
+#ifdef HASHING_X86_64
+    static const bool supported = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void murmur3FiveTupleBatch(const void* keys, size_t n, uint32_t* out, uint32_t seed) {
+#ifdef HASHING_X86_64
+    hashBatch(keys, n, kFiveTupleKeySize, out, seed, murmur3FiveTuplex8);
+#else
+    hashBatch(keys, n, kFiveTupleKeySize, out, seed, nullptr);
+#endif
+}
+
+void murmur3MacBatch(const void* keys, size_t n, uint32_t* out, uint32_t seed) {
+#ifdef HASHING_X86_64
+    hashBatch(keys, n, kMacKeySize, out, seed, murmur3Macx8);
+#else
+    hashBatch(keys, n, kMacKeySize, out, seed, nullptr);
+#endif
+}
+
+} // namespace HashUtils
@@ -0,0 +1,97 @@
+#include "utils/ip_utils.h"
+#include <sstream> // For formatIPv4
+
+namespace IpUtils {
+
+namespace {
+
+// Parses a dotted quad in [p, end). Works on the caller's buffer so that
+// matching a packet against a rule's prefix text never allocates.
+bool parseAddress(const char* p, const char* end, uint32_t& address) {
+    uint32_t result = 0;
+    for (int octet_index = 0; octet_index < 4; ++octet_index) {
+        if (octet_index > 0) {
+            if (p == end || *p != '.') {
+                return false;
+            }
+            ++p;
+        }
+        uint32_t octet = 0;
+        int digits = 0;
+        while (p != end && *p >= '0' && *p <= '9') {
+            octet = octet * 10 + static_cast<uint32_t>(*p - '0');
+            ++p;
+            if (++digits > 3 || octet > 255) {
+                return false;
+            }
+        }
+        if (digits == 0) {
+            return false;
+        }
+        result = (result << 8) | octet;
+    }
+    if (p != end) {
+        return false;
+    }
+    address = result;
+    return true;
+}
+
+bool parsePrefix(const char* begin, const char* end, uint32_t& network, uint8_t& length) {
+    const char* slash = begin;
+    while (slash != end && *slash != '/') {
+        ++slash;
+    }
+    uint32_t address = 0;
+    if (!parseAddress(begin, slash, address)) {
+        return false;
+    }
+    uint32_t len = 32;
+    if (slash != end) {
+        const char* p = slash + 1;
+        if (p == end || end - p > 2) {
+            return false;
+        }
+        len = 0;
+        for (; p != end; ++p) {
+            if (*p < '0' || *p > '9') {
+                return false;
+            }
+            len = len * 10 + static_cast<uint32_t>(*p - '0');
+        }
+        if (len > 32) {
+            return false;
+        }
+    }
+    length = static_cast<uint8_t>(len);
+    network = address & prefixMask(length);
+    return true;
+}
+
+} // anonymous namespace
+
+bool parseIPv4Address(const std::string& text, uint32_t& address) {
+    return parseAddress(text.data(), text.data() + text.size(), address);
+}
+
+bool parseIPv4Prefix(const std::string& text, uint32_t& network, uint8_t& length) {
+    return parsePrefix(text.data(), text.data() + text.size(), network, length);
+}
+
+std::string formatIPv4(uint32_t address) {
+    std::ostringstream ss;
+    ss << (address >> 24) << '.' << ((address >> 16) & 0xFF) << '.' << ((address >> 8) & 0xFF) << '.'
+       << (address & 0xFF);
+    return ss.str();
+}
+
+bool matchesPrefixText(const std::string& prefix_text, uint32_t address) {
+    uint32_t network;
+    uint8_t length;
+    if (prefix_text.empty() || !parseIPv4Prefix(prefix_text, network, length)) {
+        return true;
+    }
+    return prefixContains(network, length, address);
+}
+
+} // namespace IpUtils
@@ -0,0 +1,172 @@
+#include "utils/range_encoder.h"
+#include "packet_classifier.h" // For full definition of PacketFilter
+
+namespace {
+constexpr int kPortBits = 16;
+constexpr uint32_t kPortFieldMask = 0xFFFFu;
+
+// Index of the most significant set bit (v must be non-zero).
+inline int highestBit(uint32_t v) {
+    return 31 - __builtin_clz(v);
+}
+} // namespace
+
+// --- TernaryPortEntry ---
+bool TernaryPortEntry::isPrefix() const {
+    // A prefix mask is a run of ones from the MSB: its complement (within 16 bits)
+    // is of the form 0...01...1, i.e. complement + 1 is a power of two.
+    uint32_t inverted = (~static_cast<uint32_t>(mask)) & kPortFieldMask;
+    return (inverted & (inverted + 1)) == 0;
+}
+
+int TernaryPortEntry::prefixLength() const {
+    if (!isPrefix()) return -1;
+    return __builtin_popcount(mask);
+}
+
+std::string TernaryPortEntry::toString() const {
+    std::string s(kPortBits, '*');
+    for (int i = 0; i < kPortBits; ++i) {
+        uint16_t bit = static_cast<uint16_t>(1u << (kPortBits - 1 - i));
+        if (mask & bit) {
+            s[i] = (value & bit) ? '1' : '0';
+        }
+    }
+    return s;
+}
+
+// --- EncodedPortFilter ---
+bool EncodedPortFilter::matches(uint16_t source_port, uint16_t dest_port) const {
+    uint16_t sk = RangeEncoder::encodeKey(source_port, encoding);
+    uint16_t dk = RangeEncoder::encodeKey(dest_port, encoding);
+    bool source_ok = false;
+    for (const auto& e : source_ports) {
+        if (e.matches(sk)) { source_ok = true; break; }
+    }
+    if (!source_ok) return false;
+    for (const auto& e : dest_ports) {
+        if (e.matches(dk)) return true;
+    }
+    return false;
+}
+
+// --- RangeEncoder ---
+RangeEncoder::RangeEncoder(PortEncoding encoding) : encoding_(encoding) {}
+
+std::vector<TernaryPortEntry> RangeEncoder::encodeRange(uint16_t low, uint16_t high) const {
+    return encoding_ == PortEncoding::SRGE ? rangeToSrge(low, high) : rangeToPrefixes(low, high);
+}
+
+EncodedPortFilter RangeEncoder::encode(const PacketFilter& filter) const {
+    EncodedPortFilter encoded;
+    encoded.encoding = encoding_;
+
+    // 0-0 is the "any" convention used by PacketFilter::matches().
+    if (filter.source_port_low == 0 && filter.source_port_high == 0) {
+        encoded.source_ports.emplace_back(0, 0);
+    } else {
+        encoded.source_ports = encodeRange(filter.source_port_low, filter.source_port_high);
+    }
+    if (filter.dest_port_low == 0 && filter.dest_port_high == 0) {
+        encoded.dest_ports.emplace_back(0, 0);
+    } else {
+        encoded.dest_ports = encodeRange(filter.dest_port_low, filter.dest_port_high);
+    }
+    return encoded;
+}
+
+// Splits [low, high] into maximal aligned power-of-two blocks (start, size).
+void RangeEncoder::appendPrefixBlocks(uint32_t low, uint32_t high,
+                                      std::vector<std::pair<uint32_t, uint32_t>>& blocks) {
+    while (low <= high) {
+        // Largest block aligned at 'low'...
+        uint32_t size = low == 0 ? (1u << kPortBits) : (low & (~low + 1));
+        // ...that does not run past 'high'.
+        while (low + size - 1 > high) {
+            size >>= 1;
+        }
+        blocks.emplace_back(low, size);
+        low += size;
+    }
+}
+
+std::vector<TernaryPortEntry> RangeEncoder::rangeToPrefixes(uint16_t low, uint16_t high) {
+    std::vector<TernaryPortEntry> entries;
+    if (low > high) return entries;
+
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;
+    appendPrefixBlocks(low, high, blocks);
+    entries.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        uint16_t mask = static_cast<uint16_t>(~(block.second - 1) & kPortFieldMask);
+        entries.emplace_back(static_cast<uint16_t>(block.first), mask);
+    }
+    return entries;
+}
+
+// An aligned binary block [start, start + size) maps onto a Gray-code ternary
+// entry: gray bits at or above log2(size) are fixed by the block's high bits,
+// the low log2(size) bits take every combination.
+TernaryPortEntry RangeEncoder::grayBlockEntry(uint32_t block_start, uint32_t block_size, uint32_t extra_wildcard_mask) {
+    uint32_t mask = ~(block_size - 1) & ~extra_wildcard_mask & kPortFieldMask;
+    uint16_t gray = toGray(static_cast<uint16_t>(block_start));
+    return TernaryPortEntry(gray, static_cast<uint16_t>(mask));
+}
+
+void RangeEncoder::srgeRecursive(uint32_t low, uint32_t high, std::vector<TernaryPortEntry>& out) {
+    if (low > high) return;
+
+    // Already an aligned block: one entry.
+    uint32_t span = high - low + 1;
+    if ((span & (span - 1)) == 0 && (low & (span - 1)) == 0) {
+        out.push_back(grayBlockEntry(low, span, 0));
+        return;
+    }
+
+    // Split at the highest bit where low and high differ. 'mid' is the first
+    // value of the upper half of the smallest aligned block containing the range.
+    int level = highestBit(low ^ high);
+    uint32_t mid = (high >> level) << level;
+    uint32_t left_len = mid - low;
+    uint32_t right_len = high - mid + 1;
+    uint32_t level_bit = 1u << level;
+
+    // Reflection around 'mid' flips exactly gray bit 'level', so the shorter side
+    // and its mirror image in the longer side share entries with that bit as '*'.
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;
+    if (left_len >= right_len) {
+        uint32_t mirror_low = 2 * mid - 1 - high;
+        appendPrefixBlocks(mirror_low, mid - 1, blocks);
+        for (const auto& block : blocks) {
+            out.push_back(grayBlockEntry(block.first, block.second, level_bit));
+        }
+        if (mirror_low > low) {
+            srgeRecursive(low, mirror_low - 1, out);
+        }
+    } else {
+        uint32_t mirror_high = 2 * mid - 1 - low;
+        appendPrefixBlocks(mid, mirror_high, blocks);
+        for (const auto& block : blocks) {
+            out.push_back(grayBlockEntry(block.first, block.second, level_bit));
+        }
+        srgeRecursive(mirror_high + 1, high, out);
+    }
+}
+
+std::vector<TernaryPortEntry> RangeEncoder::rangeToSrge(uint16_t low, uint16_t high) {
+    std::vector<TernaryPortEntry> entries;
+    if (low > high) return entries;
+    srgeRecursive(low, high, entries);
+
+    // Every binary prefix is also a valid Gray ternary entry, so fall back to the
+    // plain prefix cover in the (rare) case the reflection split does not pay off.
+    std::vector<std::pair<uint32_t, uint32_t>> blocks;
+    appendPrefixBlocks(low, high, blocks);
+    if (blocks.size() < entries.size()) {
+        entries.clear();
+        for (const auto& block : blocks) {
+            entries.push_back(grayBlockEntry(block.first, block.second, 0));
+        }
+    }
+    return entries;
+}
@@ -12,6 +12,32 @@ RuleManager::~RuleManager() {
 
 bool RuleManager::addRule(const ClassificationRule& rule) {
     WriteLockGuard lock(rw_lock_);
+    if (!addRule_nolock(rule)) {
+        return false;
+    }
+    rebuildPriorityCache();
+    logger_.info("RuleManager: Added rule ID: " + std::to_string(rule.rule_id) + " successfully.");
+    return true;
+}
+
+std::vector<int> RuleManager::addRules(const std::vector<ClassificationRule>& rules) {
+    WriteLockGuard lock(rw_lock_);
+    std::vector<int> added;
+    added.reserve(rules.size());
+    for (const ClassificationRule& rule : rules) {
+        if (addRule_nolock(rule)) {
+            added.push_back(rule.rule_id);
+        }
+    }
+    if (!added.empty()) {
+        rebuildPriorityCache();
+    }
+    logger_.info("RuleManager: Added " + std::to_string(added.size()) + " of " + std::to_string(rules.size()) +
+                 " rules.");
+    return added;
+}
+
+bool RuleManager::addRule_nolock(const ClassificationRule& rule) {
     logger_.debug("RuleManager: Attempting to add rule ID: " + std::to_string(rule.rule_id));
 
     if (rules_by_id_.count(rule.rule_id)) {
@@ -19,20 +45,23 @@ bool RuleManager::addRule(const ClassificationRule& rule) {
         return false;
     }
 
+    if (!rule.filter.hasValidPrefixes()) {
+        logger_.warning("RuleManager: Failed to add rule ID " + std::to_string(rule.rule_id) +
+                        ". Invalid IP prefix in filter: " + rule.filter.toString());
+        return false;
+    }
+
     if (detectConflict_nolock(rule)) { // Placeholder call
         logger_.warning("RuleManager: Failed to add rule ID " + std::to_string(rule.rule_id) + ". Conflict detected.");
         return false;
     }
 
     auto pair = rules_by_id_.emplace(rule.rule_id, rule);
-    if(pair.second){ // Check if emplace was successful
-        rebuildPriorityCache();
-        logger_.info("RuleManager: Added rule ID: " + std::to_string(rule.rule_id) + " successfully.");
-        return true;
-    } else {
+    if (!pair.second) { // Check if emplace was successful
         logger_.error("RuleManager: Failed to emplace rule ID " + std::to_string(rule.rule_id) + " into map for unknown reasons.");
         return false;
     }
+    return true;
 }
 
 bool RuleManager::deleteRule(int rule_id) {
@@ -59,6 +88,12 @@ bool RuleManager::modifyRule(int rule_id, const ClassificationRule& new_rule_dat
         return false;
     }
 
+    if (!new_rule_data.filter.hasValidPrefixes()) {
+        logger_.warning("RuleManager: Failed to modify rule ID " + std::to_string(rule_id) +
+                        ". Invalid IP prefix in filter: " + new_rule_data.filter.toString());
+        return false;
+    }
+
     // Create a temporary rule to check for conflicts, excluding the rule being modified.
     // This is a simplified conflict check logic.
     ClassificationRule temp_new_rule = new_rule_data;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <algorithm>    // For std::all_of, std::find_if
 #include <chrono>       // For sleep_for
+#include <exception>    // For std::exception_ptr
 
 // --- ReadWriteLock Implementation ---
 ReadWriteLock::ReadWriteLock() : active_readers_(0), waiting_writers_(0), writer_active_(false), writer_thread_id_(), recursive_write_count_(0) {
@@ -106,171 +107,769 @@ bool ReadWriteLock::tryWriteLock() {
 }
 
 
+// --- BigReaderLock Implementation ---
+BigReaderLock::BigReaderLock(size_t reader_slots) : writer_(false) {
+    if (reader_slots == 0) {
+        reader_slots = std::thread::hardware_concurrency();
+    }
+    size_t count = 1;
+    while (count < reader_slots && count < kMaxReaderSlots) {
+        count <<= 1;
+    }
+    slots_.reset(new ReaderSlot[count]);
+    slot_mask_ = count - 1;
+}
+
+void BigReaderLock::writeLock() {
+    writer_mutex_.lock();
+    writer_.store(true, std::memory_order_seq_cst);
+    // The slot loads must be seq_cst as well: with readLock()'s seq_cst
+    // increment and flag load this is a Dekker pairing, and an acquire load
+    // could be ordered before the flag store and miss an entering reader.
+    for (size_t i = 0; i <= slot_mask_; ++i) {
+        while (slots_[i].readers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void BigReaderLock::writeUnlock() {
+    writer_.store(false, std::memory_order_release);
+    writer_mutex_.unlock();
+}
+
+
 // --- RcuUtils Implementation ---
 namespace RcuUtils {
 
-// Thread-local epoch for when a reader started.
-// 0 means not in RCU read-side critical section or uses current global epoch.
-thread_local uint64_t rcu_thread_epoch = 0; 
+std::atomic<uint64_t> rcu_global_epoch(1); // 0 is reserved for "quiescent"
+thread_local ReaderSlot* rcu_reader_slot = nullptr;
+thread_local unsigned rcu_read_nesting = 0;
+thread_local bool rcu_qsbr_thread = false;
+
+namespace {
 
-// Global epoch counter. Incremented by writers.
-std::atomic<uint64_t> rcu_global_epoch(1); // Starts at 1, 0 can mean "not set"
+// Grace periods scan every slot under registry.mutex, so slots are only
+// freed when no scan can be looking at them. Deliberately leaked: threads may
+// exit (and unregister) during static destruction.
+struct ReaderRegistry {
+    std::mutex mutex;
+    std::vector<ReaderSlot*> slots;
+};
 
-// For simplified grace period tracking:
-// Store epochs of threads currently in read-side critical sections.
-// This is NOT a scalable or performant way to do RCU, just for skeleton illustration.
-// A real RCU uses per-CPU data, quiescent state detection, etc.
-static std::mutex rcu_state_mutex; // Protects active_reader_epochs and deferred_callbacks
-static std::vector<uint64_t> active_reader_epochs; // Epochs of currently active readers
-static std::vector<std::function<void()>> deferred_callbacks;
+ReaderRegistry& registry() {
+    static ReaderRegistry* instance = new ReaderRegistry();
+    return *instance;
+}
 
-// (rcuReadLock and rcuReadUnlock are inline in header)
+// Unregisters the thread's slot when the thread exits.
+struct ReaderSlotOwner {
+    ~ReaderSlotOwner() { unregisterReaderThread(); }
+};
+thread_local ReaderSlotOwner reader_slot_owner;
+
+// Waits until every registered reader is quiescent or has entered its
+// section at target_epoch or later.
+void waitForReaders(uint64_t target_epoch) {
+    ReaderRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (ReaderSlot* slot : reg.slots) {
+        if (slot == rcu_reader_slot) {
+            // A QSBR thread waiting for a grace period is offline (see
+            // QsbrOfflineScope); an epoch reader inside a section would deadlock.
+            if (rcu_read_nesting > 0) {
+                std::cerr << "RCU: Grace period requested inside a read-side section; not waiting for this thread."
+                          << std::endl;
+            }
+            continue;
+        }
+        for (unsigned spins = 0;; ++spins) {
+            uint64_t epoch = slot->epoch.load(std::memory_order_acquire);
+            if (epoch == 0 || epoch >= target_epoch) {
+                break;
+            }
+            if (spins < 128) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50)); // Long section; stop burning the core
+            }
+        }
+    }
+}
 
-void synchronizeRcu(bool force_full_wait) {
-    std::cout << "RCU: Starting synchronizeRcu (grace period)..." << std::endl;
+// Runs one grace period: readers that entered before the epoch advanced hold
+// an older epoch in their slot and are waited for.
+void runGracePeriod() {
     uint64_t target_epoch = rcu_global_epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
-    // The new global epoch is now target_epoch.
-    // We need to wait for all readers that started before or during target_epoch-1 to finish.
+    // Pairs with the fence in rcuReadLock(): either we see the reader's slot
+    // store, or the reader sees everything published before this point.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    waitForReaders(target_epoch);
+}
+
+void runCallbacks(std::vector<std::function<void()>>& callbacks) {
+    for (const auto& cb : callbacks) {
+        try {
+            cb();
+        } catch (const std::exception& e) {
+            std::cerr << "RCU: Exception in deferred callback: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "RCU: Unknown exception in deferred callback." << std::endl;
+        }
+    }
+}
+
+// Queues callRcu() callbacks and reclaims them in batches on a background
+// thread, started on the first callRcu(). A batch is every callback queued
+// when it starts, so one grace period is amortised over all of them.
+class Reclaimer {
+public:
+    // How long the background thread lets callbacks accumulate after the
+    // first one arrives, unless kBatchSize are queued sooner.
+    static constexpr std::chrono::milliseconds kBatchWindow{1};
+    static constexpr size_t kBatchSize = 256;
+
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        queue_cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        runBatch(false); // Whatever was queued after the thread's last batch
+    }
+
+    void enqueue(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            pending_.push_back(std::move(callback));
+            if (!thread_.joinable() && !stop_) {
+                thread_ = std::thread([this]() { run(); });
+            }
+        }
+        queue_cv_.notify_one();
+    }
+
+    // Takes every queued callback, waits a grace period (also when there are
+    // none, if always_wait) and runs them. Batches run one at a time, in
+    // queue order, so a caller returning from here knows that everything
+    // queued before it was reclaimed.
+    void runBatch(bool always_wait) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        std::vector<std::function<void()>> batch;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            batch.swap(pending_);
+        }
+        if (batch.empty() && !always_wait) {
+            return;
+        }
+        runGracePeriod();
+        runCallbacks(batch);
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        while (true) {
+            queue_cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+            if (stop_) {
+                return; // The destructor drains what is left
+            }
+            queue_cv_.wait_for(lock, kBatchWindow, [this]() { return stop_ || pending_.size() >= kBatchSize; });
+            lock.unlock();
+            runBatch(false);
+            lock.lock();
+        }
+    }
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::vector<std::function<void()>> pending_;
+    bool stop_ = false;
+    std::thread thread_;
+    std::mutex run_mutex_; // Serialises batches
+};
+
+Reclaimer& reclaimer() {
+    static Reclaimer instance;
+    return instance;
+}
+
+// Takes an online QSBR thread offline while it waits for reclamation, as
+// liburcu-qsbr does in synchronize_rcu(). Otherwise it can block on the
+// Reclaimer's run_mutex_ while the background thread, holding it, waits in
+// runGracePeriod() for this thread's next quiescent state.
+class QsbrOfflineScope {
+public:
+    QsbrOfflineScope()
+        : was_online_(rcu_qsbr_thread && rcu_reader_slot->epoch.load(std::memory_order_relaxed) != 0) {
+        if (was_online_) {
+            rcuThreadOffline();
+        }
+    }
+    ~QsbrOfflineScope() {
+        if (was_online_) {
+            rcuThreadOnline();
+        }
+    }
+
+private:
+    bool was_online_;
+};
+
+} // namespace
 
-    // This is a highly simplified and potentially slow way to wait for grace period.
-    // It simulates waiting for all threads to pass through a quiescent state.
-    // A real implementation would involve checking per-CPU flags or more advanced quiescent state detection.
-    
-    // Heuristic: Yield a few times, then potentially sleep if force_full_wait is true.
-    // This is not robust.
-    for (int i = 0; i < 10; ++i) { // Try a few yields
-        std::this_thread::yield();
+ReaderSlot* registerReaderThread() {
+    if (rcu_reader_slot == nullptr) {
+        ReaderSlot* slot = new ReaderSlot();
+        {
+            ReaderRegistry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.slots.push_back(slot);
+        }
+        rcu_reader_slot = slot;
+        (void)&reader_slot_owner; // Odr-use: constructs the exit hook for this thread
     }
+    return rcu_reader_slot;
+}
+
+void unregisterReaderThread() {
+    ReaderSlot* slot = rcu_reader_slot;
+    if (slot == nullptr) {
+        return;
+    }
+    if (rcu_read_nesting > 0) {
+        std::cerr << "RCU: Thread unregistered inside a read-side section." << std::endl;
+        rcu_read_nesting = 0;
+    }
+    rcu_qsbr_thread = false;
+    // Go quiescent before taking the registry lock: a grace period holds it
+    // while waiting for this slot, so a QSBR thread exiting online would
+    // otherwise deadlock against it.
+    slot->epoch.store(0, std::memory_order_release);
+    {
+        ReaderRegistry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.slots.erase(std::find(reg.slots.begin(), reg.slots.end(), slot));
+    }
+    rcu_reader_slot = nullptr;
+    delete slot;
+}
+
+void rcuQsbrRegisterThread() {
+    if (rcu_read_nesting > 0) {
+        std::cerr << "RCU: QSBR registration inside a read-side section ignored." << std::endl;
+        return;
+    }
+    registerReaderThread();
+    rcu_qsbr_thread = true;
+    rcuThreadOnline();
+}
 
-    if (force_full_wait) {
-        // Artificial delay to simulate waiting for readers.
-        // In a real system, this loop would check actual quiescent states of all relevant CPUs/threads.
-        // The condition would be: "all threads that were active at epoch E < target_epoch have
-        // indicated they are done with epoch E".
-        // For this skeleton, we just simulate a wait.
-        std::cout << "RCU: Simulating longer wait for grace period (force_full_wait=true)." << std::endl;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // Arbitrary small delay
+void rcuQsbrUnregisterThread() {
+    if (!rcu_qsbr_thread) {
+        return;
     }
-    
-    // After waiting, process any callbacks that were deferred until this epoch.
-    // In a more complex system, callbacks are associated with specific epochs.
-    // Here, we just process all pending ones after any sync.
-    processRcuCallbacks();
+    rcuThreadOffline();
+    rcu_qsbr_thread = false;
+}
 
-    std::cout << "RCU: synchronizeRcu finished for epoch transition to " << target_epoch << "." << std::endl;
+size_t getRegisteredReaderCount() {
+    ReaderRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.slots.size();
 }
 
+void synchronizeRcu() {
+    QsbrOfflineScope offline;
+    reclaimer().runBatch(true);
+}
 
 void callRcu(std::function<void()> callback) {
     if (!callback) return;
-    std::lock_guard<std::mutex> lock(rcu_state_mutex);
-    deferred_callbacks.push_back(std::move(callback));
-    std::cout << "RCU: Queued a callback. Total pending: " << deferred_callbacks.size() << std::endl;
+    reclaimer().enqueue(std::move(callback));
 }
 
 void processRcuCallbacks() {
-    std::vector<std::function<void()>> callbacks_to_run;
-    {
-        std::lock_guard<std::mutex> lock(rcu_state_mutex);
-        if (deferred_callbacks.empty()) {
-            return;
+    QsbrOfflineScope offline;
+    reclaimer().runBatch(false);
+}
+
+
+// --- WorkStealingThreadPool Implementation ---
+namespace {
+// The pool and worker index of the calling thread, if it is a pool worker.
+thread_local const WorkStealingThreadPool* tls_pool = nullptr;
+thread_local int tls_worker_index = -1;
+} // namespace
+
+WorkStealingThreadPool::WorkDeque::WorkDeque() : top_(0), bottom_(0) {
+    arrays_.push_back(std::make_unique<Array>(64));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+}
+
+WorkStealingThreadPool::WorkDeque::~WorkDeque() {
+    // Only reached after the workers were joined and the deque drained.
+    Array* array = array_.load(std::memory_order_relaxed);
+    for (int64_t i = top_.load(std::memory_order_relaxed); i < bottom_.load(std::memory_order_relaxed); ++i) {
+        delete array->get(i);
+    }
+}
+
+void WorkStealingThreadPool::WorkDeque::push(Task* task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* array = array_.load(std::memory_order_relaxed);
+    if (b - t > array->capacity - 1) {
+        auto grown = std::make_unique<Array>(array->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            grown->put(i, array->get(i));
         }
-        callbacks_to_run.swap(deferred_callbacks);
+        array = grown.get();
+        arrays_.push_back(std::move(grown));
+        array_.store(array, std::memory_order_release);
     }
+    array->put(b, task);
+    bottom_.store(b + 1, std::memory_order_release); // Publishes the slot to steal()
+}
 
-    if (!callbacks_to_run.empty()) {
-        std::cout << "RCU: Processing " << callbacks_to_run.size() << " deferred callbacks..." << std::endl;
-        for (const auto& cb : callbacks_to_run) {
-            if (cb) {
-                try {
-                    cb();
-                } catch (const std::exception& e) {
-                    std::cerr << "RCU: Exception in deferred callback: " << e.what() << std::endl;
-                } catch (...) {
-                    std::cerr << "RCU: Unknown exception in deferred callback." << std::endl;
-                }
-            }
+WorkStealingThreadPool::Task* WorkStealingThreadPool::WorkDeque::pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* array = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed); // Empty
+        return nullptr;
+    }
+    Task* task = array->get(b);
+    if (t == b) {
+        // Last element: race thieves for it.
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = nullptr;
         }
-        std::cout << "RCU: Finished processing callbacks." << std::endl;
+        bottom_.store(b + 1, std::memory_order_relaxed);
     }
+    return task;
 }
 
+WorkStealingThreadPool::Task* WorkStealingThreadPool::WorkDeque::steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    Array* array = array_.load(std::memory_order_acquire);
+    Task* task = array->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr; // Another thief or the owner got it
+    }
+    return task;
+}
 
-// --- SimpleThreadPool Implementation ---
-SimpleThreadPool::SimpleThreadPool(size_t num_threads) : stop_(false) {
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads) : queued_(0), sleepers_(0), stop_(false) {
     size_t threads_to_create = num_threads == 0 ? std::thread::hardware_concurrency() : num_threads;
     if (threads_to_create == 0) threads_to_create = 1; // At least one thread
 
-    std::cout << "SimpleThreadPool: Creating " << threads_to_create << " worker threads." << std::endl;
+    for (size_t i = 0; i < threads_to_create; ++i) {
+        deques_.push_back(std::make_unique<WorkDeque>());
+    }
     workers_.reserve(threads_to_create);
     for (size_t i = 0; i < threads_to_create; ++i) {
-        workers_.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex_);
-                    this->condition_.wait(lock, [this] { return this->stop_.load(std::memory_order_relaxed) || !this->tasks_.empty(); });
-                    if (this->stop_.load(std::memory_order_relaxed) && this->tasks_.empty()) {
-                        return; // Exit worker thread
-                    }
-                    if (!this->tasks_.empty()) { // Check if tasks is empty before moving
-                        task = std::move(this->tasks_.front());
-                        this->tasks_.erase(this->tasks_.begin()); // Simple vector erase
-                    }
-                }
-                if(task) {
-                    try {
-                        task();
-                    } catch (const std::exception& e) {
-                        std::cerr << "ThreadPool: Exception in task: " << e.what() << std::endl;
-                    } catch (...) {
-                        std::cerr << "ThreadPool: Unknown exception in task." << std::endl;
-                    }
-                }
-            }
-        });
+        workers_.emplace_back([this, i]() { workerLoop(i); });
     }
 }
 
-SimpleThreadPool::~SimpleThreadPool() {
-    std::cout << "SimpleThreadPool: Destructor called. Stopping threads." << std::endl;
+WorkStealingThreadPool::~WorkStealingThreadPool() {
     stop();
+    for (size_t i = injection_head_; i < injection_queue_.size(); ++i) {
+        delete injection_queue_[i]; // Only tasks submitted while stopping
+    }
 }
 
-// template<class F>
-// void SimpleThreadPool::enqueue(F&& f) { // Definition moved to header
-// //    if (stop_) {
-// //        // std::cout << "SimpleThreadPool: Enqueue on stopped pool. Ignoring." << std::endl;
-// //        // Or throw: throw std::runtime_error("enqueue on stopped ThreadPool");
-// //        return;
-// //    }
-// //    {
-// //        std::unique_lock<std::mutex> lock(queue_mutex_);
-// //        tasks_.emplace_back(std::forward<F>(f));
-// //    }
-// //    condition_.notify_one();
-// }
+int WorkStealingThreadPool::currentWorkerIndex() const {
+    return tls_pool == this ? tls_worker_index : -1;
+}
 
-// Explicit instantiation for common types if needed, or keep in header for full template use.
-// For this skeleton, assuming it's used with std::function<void()> or compatible lambdas.
-// template void SimpleThreadPool::enqueue<std::function<void()>>(std::function<void()>&& );
+void WorkStealingThreadPool::schedule(Task* task) {
+    int worker = currentWorkerIndex();
+    if (worker < 0 && stop_.load(std::memory_order_acquire)) {
+        delete task; // Stopped: only work spawned by running tasks is still accepted
+        return;
+    }
+    // Count first so a stopping pool never sees 0 while this task is in flight.
+    queued_.fetch_add(1, std::memory_order_seq_cst);
+    if (worker >= 0) {
+        deques_[worker]->push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        injection_queue_.push_back(task);
+    }
+    // Pairs with the sleeper check in workerLoop(): either it sees queued_,
+    // or we see it asleep and wake it.
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
 
+WorkStealingThreadPool::Task* WorkStealingThreadPool::findTask(int worker_index, uint64_t& rng_state) {
+    if (worker_index >= 0) {
+        if (Task* task = deques_[worker_index]->pop()) {
+            return task;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        if (injection_head_ < injection_queue_.size()) {
+            Task* task = injection_queue_[injection_head_++];
+            if (injection_head_ == injection_queue_.size()) {
+                injection_queue_.clear();
+                injection_head_ = 0;
+            }
+            return task;
+        }
+    }
+    // Steal, starting at a random victim (xorshift64).
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    size_t count = deques_.size();
+    size_t start = static_cast<size_t>(rng_state % count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if (static_cast<int>(victim) == worker_index) continue;
+        if (Task* task = deques_[victim]->steal()) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingThreadPool::runTask(Task* task) {
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    try {
+        (*task)();
+    } catch (const std::exception& e) {
+        std::cerr << "ThreadPool: Exception in task: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "ThreadPool: Unknown exception in task." << std::endl;
+    }
+    delete task;
+}
+
+bool WorkStealingThreadPool::runOneTask() {
+    thread_local uint64_t rng_state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&rng_state);
+    Task* task = findTask(currentWorkerIndex(), rng_state);
+    if (!task) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+void WorkStealingThreadPool::workerLoop(size_t index) {
+    tls_pool = this;
+    tls_worker_index = static_cast<int>(index);
+    uint64_t rng_state = 0x9E3779B97F4A7C15ULL * (index + 1);
+    while (true) {
+        if (Task* task = findTask(static_cast<int>(index), rng_state)) {
+            runTask(task);
+            continue;
+        }
+        // A task counted in queued_ may not be visible yet; only sleep when
+        // nothing is queued at all.
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        sleep_cv_.wait(lock, [this]() {
+            return queued_.load(std::memory_order_seq_cst) > 0 || stop_.load(std::memory_order_relaxed);
+        });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        if (stop_.load(std::memory_order_relaxed) && queued_.load(std::memory_order_seq_cst) == 0) {
+            return; // Drained
+        }
+    }
+}
+
+void WorkStealingThreadPool::parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body,
+                                         size_t grain) {
+    if (begin >= end) return;
+    size_t count = end - begin;
+    if (grain == 0) {
+        grain = std::max<size_t>(1, count / (getThreadCount() * 8));
+    }
+
+    struct State {
+        const std::function<void(size_t)>& body;
+        size_t grain;
+        std::atomic<size_t> remaining;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        WorkStealingThreadPool* pool;
+
+        void run(size_t lo, size_t hi) {
+            // Hand the upper halves to thieves, keep splitting the lower one.
+            while (hi - lo > grain) {
+                size_t mid = lo + (hi - lo) / 2;
+                pool->enqueue([this, mid, hi]() { run(mid, hi); });
+                hi = mid;
+            }
+            for (size_t i = lo; i < hi; ++i) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+            remaining.fetch_sub(hi - lo, std::memory_order_acq_rel); // Last touch of *this
+        }
+    };
+    State state{body, grain, {count}, {}, nullptr, this};
 
-void SimpleThreadPool::stop() {
-    if(stop_.load(std::memory_order_relaxed)) return; // Already stopping/stopped
+    if (currentWorkerIndex() < 0 && stop_.load(std::memory_order_acquire)) {
+        // No workers left to help: run inline.
+        for (size_t i = begin; i < end; ++i) body(i);
+        return;
+    }
+    state.run(begin, end);
+    // Help with queued work (ours or anyone's) until every index is done.
+    while (state.remaining.load(std::memory_order_acquire) != 0) {
+        if (!runOneTask()) {
+            std::this_thread::yield();
+        }
+    }
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
 
-    std::cout << "SimpleThreadPool: Stopping threads..." << std::endl;
+void WorkStealingThreadPool::stop() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        if (stop_.load(std::memory_order_relaxed)) return; // Already stopping/stopped
         stop_.store(true, std::memory_order_release);
     }
-    condition_.notify_all();
-    for (std::thread &worker : workers_) {
+    sleep_cv_.notify_all();
+    for (std::thread& worker : workers_) {
         if (worker.joinable()) {
             worker.join();
         }
     }
-    std::cout << "SimpleThreadPool: All threads joined." << std::endl;
 }
 
 } // namespace RcuUtils
+
+
+// --- HazardPointerDomain Implementation ---
+struct alignas(64) HazardPointerDomain::ThreadRecord {
+    std::atomic<void*> hazards[kSlotsPerThread];
+    std::atomic<bool> active{true};
+    ThreadRecord* next = nullptr;
+    std::vector<RetiredNode> retired; // Only touched by the owning thread
+
+    ThreadRecord() {
+        for (auto& hazard : hazards) {
+            hazard.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace {
+
+// Domains that are still alive, so a thread exiting after a domain was
+// destroyed does not touch its records. Leaked for the same reason as the
+// RCU registry.
+struct LiveDomains {
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, HazardPointerDomain*>> domains;
+};
+
+LiveDomains& liveDomains() {
+    static LiveDomains* instance = new LiveDomains();
+    return *instance;
+}
+
+std::atomic<uint64_t> next_domain_id(1);
+
+} // namespace
+
+// The calling thread's record in each domain it has used, released at exit.
+struct HazardRecordCache {
+    std::vector<std::pair<uint64_t, HazardPointerDomain::ThreadRecord*>> entries;
+
+    ~HazardRecordCache() {
+        LiveDomains& live = liveDomains();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        for (const auto& entry : entries) {
+            for (const auto& domain : live.domains) {
+                if (domain.first == entry.first) {
+                    domain.second->releaseRecord(entry.second);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+namespace {
+thread_local HazardRecordCache hazard_record_cache;
+}
+
+HazardPointerDomain::HazardPointerDomain()
+    : id_(next_domain_id.fetch_add(1, std::memory_order_relaxed)), records_(nullptr), record_count_(0),
+      retired_count_(0) {
+    LiveDomains& live = liveDomains();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    live.domains.emplace_back(id_, this);
+}
+
+HazardPointerDomain::~HazardPointerDomain() {
+    {
+        LiveDomains& live = liveDomains();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        for (auto it = live.domains.begin(); it != live.domains.end(); ++it) {
+            if (it->first == id_) {
+                live.domains.erase(it);
+                break;
+            }
+        }
+    }
+    // Nothing can be protected any more: reclaim everything and free the records.
+    ThreadRecord* record = records_.load(std::memory_order_acquire);
+    while (record) {
+        for (const RetiredNode& node : record->retired) {
+            node.reclaim(node.object, node.context);
+        }
+        ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+    for (const RetiredNode& node : orphans_) {
+        node.reclaim(node.object, node.context);
+    }
+}
+
+HazardPointerDomain& HazardPointerDomain::defaultDomain() {
+    static HazardPointerDomain instance;
+    return instance;
+}
+
+HazardPointerDomain::ThreadRecord* HazardPointerDomain::localRecord() {
+    auto& entries = hazard_record_cache.entries;
+    for (const auto& entry : entries) {
+        if (entry.first == id_) {
+            return entry.second;
+        }
+    }
+
+    // Reuse a record released by an exited thread, or push a new one.
+    ThreadRecord* record = nullptr;
+    for (ThreadRecord* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+        bool inactive = false;
+        if (r->active.compare_exchange_strong(inactive, true, std::memory_order_acq_rel)) {
+            record = r;
+            break;
+        }
+    }
+    if (!record) {
+        record = new ThreadRecord();
+        ThreadRecord* head = records_.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        record_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    entries.emplace_back(id_, record);
+    return record;
+}
+
+std::atomic<void*>& HazardPointerDomain::hazardSlot(size_t index) {
+    return localRecord()->hazards[index % kSlotsPerThread];
+}
+
+void HazardPointerDomain::clearAll() {
+    for (auto& hazard : localRecord()->hazards) {
+        hazard.store(nullptr, std::memory_order_release);
+    }
+}
+
+void HazardPointerDomain::retire(void* object, ReclaimFn reclaim, void* context) {
+    if (!object) return;
+    ThreadRecord* record = localRecord();
+    record->retired.push_back(RetiredNode{object, reclaim, context});
+    retired_count_.fetch_add(1, std::memory_order_relaxed);
+    size_t threshold = std::max(kMinScanThreshold, 2 * kSlotsPerThread * record_count_.load(std::memory_order_relaxed));
+    if (record->retired.size() >= threshold) {
+        scan();
+    }
+}
+
+size_t HazardPointerDomain::scan() {
+    ThreadRecord* record = localRecord();
+    {
+        std::lock_guard<std::mutex> lock(orphan_mutex_);
+        if (!orphans_.empty()) {
+            record->retired.insert(record->retired.end(), orphans_.begin(), orphans_.end());
+            orphans_.clear();
+        }
+    }
+    if (record->retired.empty()) {
+        return 0;
+    }
+
+    // Pairs with protect(): a reader whose hazard we miss here re-reads its
+    // source after publishing and sees the node already unlinked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<void*> protected_nodes;
+    protected_nodes.reserve(kSlotsPerThread * record_count_.load(std::memory_order_relaxed));
+    for (ThreadRecord* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+        for (const auto& hazard : r->hazards) {
+            void* ptr = hazard.load(std::memory_order_acquire);
+            if (ptr) {
+                protected_nodes.push_back(ptr);
+            }
+        }
+    }
+    std::sort(protected_nodes.begin(), protected_nodes.end());
+
+    // Work on a detached list: a reclaim function may itself retire nodes.
+    std::vector<RetiredNode> candidates;
+    candidates.swap(record->retired);
+    size_t reclaimed = 0;
+    for (const RetiredNode& node : candidates) {
+        if (std::binary_search(protected_nodes.begin(), protected_nodes.end(), node.object)) {
+            record->retired.push_back(node);
+        } else {
+            node.reclaim(node.object, node.context);
+            ++reclaimed;
+        }
+    }
+    retired_count_.fetch_sub(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+}
+
+void HazardPointerDomain::releaseRecord(ThreadRecord* record) {
+    for (auto& hazard : record->hazards) {
+        hazard.store(nullptr, std::memory_order_release);
+    }
+    if (!record->retired.empty()) {
+        std::lock_guard<std::mutex> lock(orphan_mutex_);
+        orphans_.insert(orphans_.end(), record->retired.begin(), record->retired.end());
+        record->retired.clear();
+    }
+    record->active.store(false, std::memory_order_release);
+}
+
+size_t HazardPointerDomain::getRetiredCount() const {
+    return retired_count_.load(std::memory_order_relaxed);
+}
+
+size_t HazardPointerDomain::getThreadRecordCount() const {
+    return record_count_.load(std::memory_order_relaxed);
+}
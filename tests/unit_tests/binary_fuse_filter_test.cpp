@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "data_structures/binary_fuse_filter.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> sequentialKeys(uint64_t first, size_t count) {
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(first + i * 7919);
+    }
+    return keys;
+}
+
+} // anonymous namespace
+
+TEST(BinaryFuseFilterTest, EmptyContainsNothing) {
+    BinaryFuseFilter filter;
+    EXPECT_EQ(filter.size(), 0u);
+    EXPECT_EQ(filter.getArrayLength(), 0u);
+    EXPECT_FALSE(filter.possiblyContains(uint64_t{0}));
+    EXPECT_FALSE(filter.possiblyContains("anything"));
+
+    ASSERT_TRUE(filter.build({}));
+    EXPECT_FALSE(filter.possiblyContains(uint64_t{42}));
+}
+
+TEST(BinaryFuseFilterTest, NoFalseNegatives) {
+    for (size_t count : {1u, 2u, 3u, 10u, 100u, 1000u, 100000u}) {
+        std::vector<uint64_t> keys = sequentialKeys(12345, count);
+        BinaryFuseFilter filter;
+        ASSERT_TRUE(filter.build(keys)) << count << " keys";
+        EXPECT_EQ(filter.size(), count);
+        for (uint64_t key : keys) {
+            ASSERT_TRUE(filter.possiblyContains(key)) << "key " << key << " of " << count;
+        }
+    }
+}
+
+TEST(BinaryFuseFilterTest, DuplicatesAreIgnored) {
+    std::vector<uint64_t> keys = {5, 9, 5, 5, 9, 11};
+    BinaryFuseFilter filter(keys);
+    EXPECT_EQ(filter.size(), 3u);
+    EXPECT_TRUE(filter.possiblyContains(uint64_t{5}));
+    EXPECT_TRUE(filter.possiblyContains(uint64_t{9}));
+    EXPECT_TRUE(filter.possiblyContains(uint64_t{11}));
+}
+
+TEST(BinaryFuseFilterTest, FalsePositiveRateAndSize) {
+    const size_t count = 100000;
+    BinaryFuseFilter filter(sequentialKeys(1, count));
+    ASSERT_EQ(filter.size(), count);
+
+    // 1.175 cells per key at this size (1.125 from ~10^6 keys up).
+    EXPECT_LT(filter.getBitsPerKey(), 10.0);
+    EXPECT_EQ(filter.getMemoryUsage(), filter.getArrayLength());
+
+    // 8-bit fingerprints: about 1/256 of absent keys pass.
+    size_t false_positives = 0;
+    const size_t probes = 200000;
+    for (size_t i = 0; i < probes; ++i) {
+        if (filter.possiblyContains(uint64_t{1} << 40 | i)) {
+            ++false_positives;
+        }
+    }
+    double rate = static_cast<double>(false_positives) / probes;
+    EXPECT_LT(rate, 2.0 * BinaryFuseFilter::getFalsePositiveProbability());
+    EXPECT_GT(rate, 0.5 * BinaryFuseFilter::getFalsePositiveProbability());
+}
+
+TEST(BinaryFuseFilterTest, StringKeysAndRebuild) {
+    std::vector<uint64_t> keys;
+    for (const char* item : {"tcp/443", "tcp/80", "udp/53"}) {
+        keys.push_back(BinaryFuseFilter::keyOf(item));
+    }
+    BinaryFuseFilter filter(keys);
+    EXPECT_TRUE(filter.possiblyContains("tcp/443"));
+    EXPECT_TRUE(filter.possiblyContains("udp/53"));
+
+    // Rebuilding replaces the whole set.
+    ASSERT_TRUE(filter.build({BinaryFuseFilter::keyOf("tcp/22")}));
+    EXPECT_EQ(filter.size(), 1u);
+    EXPECT_TRUE(filter.possiblyContains("tcp/22"));
+}
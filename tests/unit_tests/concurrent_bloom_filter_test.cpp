@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "data_structures/concurrent_bloom_filter.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentBloomFilterTest, ConstructorParams) {
+    ConcurrentBloomFilter sized(100, 0.01); // Same sizing as BloomFilter: m = 959, k = 7
+    EXPECT_EQ(sized.getSize(), 959u);
+    EXPECT_EQ(sized.getNumHashFunctions(), 7);
+    EXPECT_EQ(sized.getBlockCount(), 2u);
+
+    ConcurrentBloomFilter manual(0, 0); // Invalid parameters fall back to defaults
+    EXPECT_EQ(manual.getSize(), 1024u);
+    EXPECT_EQ(manual.getNumHashFunctions(), 3);
+}
+
+TEST(ConcurrentBloomFilterTest, InsertReportsNewItems) {
+    ConcurrentBloomFilter bf(1000, 0.01);
+    EXPECT_FALSE(bf.possiblyContains("flow_a"));
+    EXPECT_TRUE(bf.insert("flow_a"));
+    EXPECT_FALSE(bf.insert("flow_a")); // Already present: nothing new set
+    EXPECT_TRUE(bf.possiblyContains("flow_a"));
+    EXPECT_EQ(bf.getApproximateCount(), 1u);
+
+    bf.clear();
+    EXPECT_FALSE(bf.possiblyContains("flow_a"));
+    EXPECT_EQ(bf.getApproximateCount(), 0u);
+
+    ConcurrentBloomFilter tiny(10, 2); // Smaller than one block
+    EXPECT_TRUE(tiny.insert("x"));
+    EXPECT_TRUE(tiny.possiblyContains("x"));
+}
+
+TEST(ConcurrentBloomFilterTest, ConcurrentInsertsLoseNothing) {
+    const int kThreads = 8;
+    const int kPerThread = 20000;
+    ConcurrentBloomFilter bf(kThreads * kPerThread, 0.01);
+
+    // Every thread inserts its own items plus a shared set, so threads race on
+    // the same words and on the same items.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&bf, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                bf.insert("flow_" + std::to_string(t) + "_" + std::to_string(i));
+                bf.insert("shared_" + std::to_string(i % 1000));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < kThreads; ++t) {
+        for (int i = 0; i < kPerThread; ++i) {
+            ASSERT_TRUE(bf.possiblyContains("flow_" + std::to_string(t) + "_" + std::to_string(i)));
+        }
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(bf.possiblyContains("shared_" + std::to_string(i)));
+    }
+
+    // Distinct items: 160000 + 1000. False positives undercount slightly;
+    // racing inserts of a shared item may overcount it.
+    double distinct = kThreads * kPerThread + 1000.0;
+    EXPECT_NEAR(static_cast<double>(bf.getApproximateCount()), distinct, distinct * 0.02);
+    EXPECT_LT(bf.getEffectiveFalsePositiveProbability(), 0.02);
+}
+
+TEST(ConcurrentBloomFilterTest, ReadersSeeCompletedInserts) {
+    ConcurrentBloomFilter bf(100000, 0.01);
+    std::atomic<int> published{0};
+    std::atomic<bool> failed{false};
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 50000; ++i) {
+            bf.insert("item_" + std::to_string(i));
+            published.store(i + 1, std::memory_order_release);
+        }
+    });
+    std::thread reader([&]() {
+        int checked = 0;
+        while (checked < 50000) {
+            int visible = published.load(std::memory_order_acquire);
+            for (; checked < visible; ++checked) {
+                if (!bf.possiblyContains("item_" + std::to_string(checked))) {
+                    failed.store(true);
+                }
+            }
+        }
+    });
+    writer.join();
+    reader.join();
+    EXPECT_FALSE(failed.load());
+}
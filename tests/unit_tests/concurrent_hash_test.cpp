@@ -3,30 +3,36 @@
 #include <string>
 #include <vector>
 #include <thread> // For potential future concurrency tests, not used for now
-
-// Note: The ConcurrentHashTable implementation is currently a placeholder.
-// Concurrency mechanisms (RCU, full Robin Hood hashing) are not fully implemented.
-// These tests focus on the current behavior: a hash table using std::atomic for
-// slot status ('in_use') and basic linear probing.
-// True multi-threaded concurrency testing is not performed here.
+#include <algorithm> // For std::equal
+#include <iterator> // For std::begin, std::end
+#include <cstdint>
+#include <unordered_map>
+#include <random>
+#include <memory>
+
+// Note: ConcurrentHashTable uses Robin Hood hashing with backward-shift deletion.
+// Writers are serialised; lookups on trivially-copyable keys are lock-free and
+// validated with a SeqLock. The table grows online past 90% load, migrating
+// entries incrementally and reclaiming old arrays through RCU.
+// ConcurrentHashTable<> is the default std::string -> int instantiation.
 
 class ConcurrentHashTableTest : public ::testing::Test {
 protected:
     // Helper to get value from lookup, returns true if found, false otherwise
-    bool getValue(const ConcurrentHashTable& table, const std::string& key, int& value) {
+    bool getValue(const ConcurrentHashTable<>& table, const std::string& key, int& value) {
         return table.lookup(key, value);
     }
 };
 
 TEST_F(ConcurrentHashTableTest, ConstructorAndEmptyTable) {
-    ConcurrentHashTable table(16); // Small capacity for easier testing
+    ConcurrentHashTable<> table(16); // Small capacity for easier testing
     int value;
     EXPECT_FALSE(getValue(table, "any_key", value));
     EXPECT_FALSE(getValue(table, "", value)); // Empty key
 }
 
 TEST_F(ConcurrentHashTableTest, BasicInsertAndLookup) {
-    ConcurrentHashTable table(16);
+    ConcurrentHashTable<> table(16);
     table.insert("key1", 10);
     table.insert("key2", 20);
     table.insert("another_key", 30);
@@ -46,7 +52,7 @@ TEST_F(ConcurrentHashTableTest, BasicInsertAndLookup) {
 }
 
 TEST_F(ConcurrentHashTableTest, InsertUpdatesExistingKey) {
-    ConcurrentHashTable table(16);
+    ConcurrentHashTable<> table(16);
     table.insert("key1", 100);
     int value;
     ASSERT_TRUE(getValue(table, "key1", value));
@@ -58,7 +64,7 @@ TEST_F(ConcurrentHashTableTest, InsertUpdatesExistingKey) {
 }
 
 TEST_F(ConcurrentHashTableTest, BasicRemove) {
-    ConcurrentHashTable table(16);
+    ConcurrentHashTable<> table(16);
     table.insert("key_to_remove", 55);
     table.insert("key_to_keep", 66);
 
@@ -75,7 +81,7 @@ TEST_F(ConcurrentHashTableTest, BasicRemove) {
 }
 
 TEST_F(ConcurrentHashTableTest, RemoveNonExistentKey) {
-    ConcurrentHashTable table(16);
+    ConcurrentHashTable<> table(16);
     table.insert("key1", 1);
     EXPECT_FALSE(table.remove("non_existent_key"));
     
@@ -85,7 +91,7 @@ TEST_F(ConcurrentHashTableTest, RemoveNonExistentKey) {
 }
 
 TEST_F(ConcurrentHashTableTest, InsertEmptyStringKey) {
-    ConcurrentHashTable table(16);
+    ConcurrentHashTable<> table(16);
     table.insert("", 12345);
     int value;
     ASSERT_TRUE(getValue(table, "", value));
@@ -108,7 +114,7 @@ TEST_F(ConcurrentHashTableTest, CollisionHandlingWithLinearProbing) {
     // Using a very small table to force collisions more easily.
     // Let's assume capacity is 2 for this test. The constructor might default to a minimum.
     // The current constructor defaults to 1024 if 0 is passed, but accepts small sizes.
-    ConcurrentHashTable table(2); // Forcing high collision rate
+    ConcurrentHashTable<> table(2); // Forcing high collision rate
                                    // The actual capacity might be adjusted by implementation.
                                    // Let's assume it respects small sizes for testing.
 
@@ -118,22 +124,17 @@ TEST_F(ConcurrentHashTableTest, CollisionHandlingWithLinearProbing) {
     table.insert("key_B", 102); // hash("key_B") % 2 = index_B
     table.insert("key_C", 103); // hash("key_C") % 2 = index_C
 
-    // The placeholder insert prints "Error: Table is full" if it can't find a slot.
-    // We are testing if items can be retrieved, assuming they were inserted.
-    // If capacity is 2, only two items can be inserted if no resize happens.
-    // The current insert doesn't resize on full, but prints error.
+    // Inserting past the maximum load factor grows the table instead of
+    // rejecting the key, so all three keys must be retrievable.
 
     int val_A, val_B, val_C;
     bool found_A = getValue(table, "key_A", val_A);
     bool found_B = getValue(table, "key_B", val_B);
     bool found_C = getValue(table, "key_C", val_C);
 
-    // With capacity 2, at most two of these can be inserted.
-    // Check that those inserted can be retrieved.
-    // This test is more about whether linear probing works for what *was* inserted.
     int items_inserted = (found_A ? 1:0) + (found_B ? 1:0) + (found_C ? 1:0);
-    EXPECT_GE(items_inserted, 0); // At least 0 inserted
-    EXPECT_LE(items_inserted, 2); // At most 2 inserted for capacity 2
+    EXPECT_EQ(items_inserted, 3);
+    EXPECT_GE(table.getCapacity(), 3u);
 
     if (found_A) EXPECT_EQ(val_A, 101);
     if (found_B) EXPECT_EQ(val_B, 102);
@@ -152,7 +153,7 @@ TEST_F(ConcurrentHashTableTest, CollisionHandlingWithLinearProbing) {
 
 TEST_F(ConcurrentHashTableTest, FillTableNearCapacity) {
     const int test_capacity = 5; // Small, but not extremely small
-    ConcurrentHashTable table(test_capacity);
+    ConcurrentHashTable<> table(test_capacity);
     std::vector<std::string> keys;
     for (int i = 0; i < test_capacity; ++i) {
         std::string key = "fill_key_" + std::to_string(i);
@@ -167,15 +168,11 @@ TEST_F(ConcurrentHashTableTest, FillTableNearCapacity) {
         EXPECT_EQ(value, i * 10);
     }
 
-    // Try inserting one more - current placeholder should print "Table is full"
-    // and not insert it, or if it did, previous values should still be correct.
-    // The `insert` function in the placeholder doesn't throw but prints to cerr.
+    // Inserting one more grows the table; previous values must be unaffected.
     table.insert("overflow_key", 999);
     int value_overflow;
-    // It's possible the "overflow_key" overwrote something if hashing is unlucky
-    // or if the table wasn't actually full due to hash collisions allowing some empty slots.
-    // The current `insert` simply iterates until full or slot found.
-    // This test mostly checks that operations on a full/nearly full table don't corrupt it.
+    ASSERT_TRUE(getValue(table, "overflow_key", value_overflow));
+    EXPECT_EQ(value_overflow, 999);
 
     // Re-verify all original keys are still found and correct
     for (int i = 0; i < test_capacity; ++i) {
@@ -183,28 +180,23 @@ TEST_F(ConcurrentHashTableTest, FillTableNearCapacity) {
         ASSERT_TRUE(getValue(table, keys[i], value)) << "Failed for key after overflow attempt: " << keys[i];
         EXPECT_EQ(value, i * 10);
     }
-    // Check if overflow_key was inserted (it shouldn't if table was truly full by count)
-    // The placeholder insert will return if probe_distance >= capacity.
-    // If all slots were filled, it won't be inserted.
 }
 
 
-// Placeholder for resize tests - current resize is not RCU-safe and basic.
 TEST_F(ConcurrentHashTableTest, ResizeOperation) {
-    ConcurrentHashTable table(3); // Start small
+    ConcurrentHashTable<> table(3); // Start small
     table.insert("a", 1);
     table.insert("b", 2);
-    table.insert("c", 3); // Table should be full or near full based on load factor for resize.
+    table.insert("c", 3); // Crosses the load factor and starts growing
 
     int value;
     ASSERT_TRUE(getValue(table, "a", value)); EXPECT_EQ(value, 1);
     ASSERT_TRUE(getValue(table, "b", value)); EXPECT_EQ(value, 2);
     ASSERT_TRUE(getValue(table, "c", value)); EXPECT_EQ(value, 3);
 
-    // The provided `resize` is manual and not RCU-safe.
-    // It's also not automatically called by `insert` in the placeholder.
-    // We call it manually here.
+    // An explicit resize finishes the running migration and starts another.
     table.resize(10);
+    EXPECT_EQ(table.getCapacity(), 10u);
 
     // Check existing keys
     ASSERT_TRUE(getValue(table, "a", value)); EXPECT_EQ(value, 1);
@@ -226,7 +218,415 @@ TEST_F(ConcurrentHashTableTest, ResizeOperation) {
 }
 
 
+// --- Fixed-size binary keys ---
+// Packed layouts have no padding, so they can be hashed over their raw bytes.
+#pragma pack(push, 1)
+struct TestFiveTuple {
+    uint32_t source_ip;
+    uint32_t dest_ip;
+    uint16_t source_port;
+    uint16_t dest_port;
+    uint8_t protocol;
+
+    bool operator==(const TestFiveTuple& other) const {
+        return source_ip == other.source_ip && dest_ip == other.dest_ip &&
+               source_port == other.source_port && dest_port == other.dest_port &&
+               protocol == other.protocol;
+    }
+};
+#pragma pack(pop)
+static_assert(sizeof(TestFiveTuple) == 13, "5-tuple key must be 13 bytes");
+
+struct TestMacKey {
+    uint8_t bytes[6];
+    bool operator==(const TestMacKey& other) const {
+        return std::equal(std::begin(bytes), std::end(bytes), std::begin(other.bytes));
+    }
+};
+
+TEST(ConcurrentHashTableBinaryKeyTest, FiveTupleKeys) {
+    ConcurrentHashTable<TestFiveTuple, uint32_t> table(256);
+    for (uint32_t i = 0; i < 100; ++i) {
+        TestFiveTuple key{0x0A000000u + i, 0xC0A80001u, static_cast<uint16_t>(1024 + i), 80, 6};
+        table.insert(key, i * 3);
+    }
+    EXPECT_EQ(table.size(), 100u);
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        TestFiveTuple key{0x0A000000u + i, 0xC0A80001u, static_cast<uint16_t>(1024 + i), 80, 6};
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(key, value)) << "Missing flow " << i;
+        EXPECT_EQ(value, i * 3);
+    }
+
+    // Same addresses/ports, different protocol is a different key.
+    TestFiveTuple udp_key{0x0A000000u, 0xC0A80001u, 1024, 80, 17};
+    uint32_t value = 0;
+    EXPECT_FALSE(table.lookup(udp_key, value));
+
+    TestFiveTuple first{0x0A000000u, 0xC0A80001u, 1024, 80, 6};
+    EXPECT_TRUE(table.remove(first));
+    EXPECT_FALSE(table.lookup(first, value));
+    EXPECT_EQ(table.size(), 99u);
+}
+
+TEST(ConcurrentHashTableBinaryKeyTest, MacKeysAndUpdate) {
+    ConcurrentHashTable<TestMacKey, int> table(64);
+    TestMacKey mac_a{{0x00, 0x11, 0x22, 0x33, 0x44, 0x55}};
+    TestMacKey mac_b{{0x00, 0x11, 0x22, 0x33, 0x44, 0x56}};
+
+    table.insert(mac_a, 1);
+    table.insert(mac_b, 2);
+    table.insert(mac_a, 10); // Update in place
+
+    int port = -1;
+    ASSERT_TRUE(table.lookup(mac_a, port));
+    EXPECT_EQ(port, 10);
+    ASSERT_TRUE(table.lookup(mac_b, port));
+    EXPECT_EQ(port, 2);
+    EXPECT_EQ(table.size(), 2u);
+}
+
+TEST(ConcurrentHashTableBinaryKeyTest, IntegralKeysUseStdHash) {
+    ConcurrentHashTable<uint64_t, uint64_t> table(32);
+    for (uint64_t i = 0; i < 20; ++i) {
+        table.insert(i << 32, i);
+    }
+    for (uint64_t i = 0; i < 20; ++i) {
+        uint64_t value = 0;
+        ASSERT_TRUE(table.lookup(i << 32, value));
+        EXPECT_EQ(value, i);
+    }
+}
+
+
+// --- Robin Hood behaviour ---
+TEST(ConcurrentHashTableRobinHoodTest, HighLoadFactorKeepsProbesShort) {
+    const size_t capacity = 10000;
+    ConcurrentHashTable<uint64_t, uint64_t> table(capacity);
+    const size_t count = static_cast<size_t>(capacity * 0.9);
+
+    std::mt19937_64 rng(1234);
+    std::vector<uint64_t> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(rng());
+        table.insert(keys.back(), i);
+    }
+    EXPECT_EQ(table.size(), count);
+    EXPECT_NEAR(table.getLoadFactor(), 0.9, 0.001);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value = 0;
+        ASSERT_TRUE(table.lookup(keys[i], value));
+        EXPECT_EQ(value, i);
+    }
+    // Robin Hood keeps the longest probe sequence small at 90% load.
+    EXPECT_LT(table.getMaxProbeDistance(), 64u);
+}
+
+TEST(ConcurrentHashTableRobinHoodTest, RemovalKeepsProbeChainsIntact) {
+    // Small table + many collisions: removing from the middle of a cluster must
+    // not hide keys stored further along it.
+    ConcurrentHashTable<uint32_t, uint32_t> table(64);
+    for (uint32_t i = 0; i < 57; ++i) {
+        table.insert(i, i + 100);
+    }
+    for (uint32_t i = 0; i < 57; i += 2) {
+        ASSERT_TRUE(table.remove(i));
+    }
+    for (uint32_t i = 0; i < 57; ++i) {
+        uint32_t value = 0;
+        if (i % 2 == 0) {
+            EXPECT_FALSE(table.lookup(i, value)) << "Removed key " << i << " still present";
+        } else {
+            ASSERT_TRUE(table.lookup(i, value)) << "Key " << i << " lost after neighbour removal";
+            EXPECT_EQ(value, i + 100);
+        }
+    }
+    EXPECT_EQ(table.size(), 28u);
+}
+
+TEST(ConcurrentHashTableRobinHoodTest, RandomOperationsMatchReferenceMap) {
+    ConcurrentHashTable<uint32_t, uint32_t> table(512);
+    std::unordered_map<uint32_t, uint32_t> reference;
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<uint32_t> key_dist(0, 600);
+
+    for (int op = 0; op < 20000; ++op) {
+        uint32_t key = key_dist(rng);
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(table.remove(key), reference.erase(key) > 0);
+        } else if (reference.size() < 460 || reference.count(key)) { // Stay below 90% load
+            table.insert(key, static_cast<uint32_t>(op));
+            reference[key] = static_cast<uint32_t>(op);
+        }
+    }
+    ASSERT_EQ(table.size(), reference.size());
+    for (uint32_t key = 0; key <= 600; ++key) {
+        uint32_t value = 0;
+        auto it = reference.find(key);
+        ASSERT_EQ(table.lookup(key, value), it != reference.end()) << "Key " << key;
+        if (it != reference.end()) {
+            EXPECT_EQ(value, it->second);
+        }
+    }
+}
+
+TEST(ConcurrentHashTableRobinHoodTest, ConcurrentReadersAlwaysSeeStableKeys) {
+    ConcurrentHashTable<uint64_t, uint64_t> table(4096);
+    const uint64_t stable_keys = 1000;
+    for (uint64_t i = 0; i < stable_keys; ++i) {
+        table.insert(i, i * 7);
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> misses(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (uint64_t i = 0; i < stable_keys; ++i) {
+                    uint64_t value = 0;
+                    if (!table.lookup(i, value) || value != i * 7) {
+                        misses.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    // Churn other keys so stable ones get displaced and shifted back repeatedly.
+    for (int round = 0; round < 20; ++round) {
+        for (uint64_t i = 0; i < 2000; ++i) {
+            table.insert(1000000 + i, i);
+        }
+        for (uint64_t i = 0; i < 2000; ++i) {
+            table.remove(1000000 + i);
+        }
+    }
+    stop.store(true);
+    for (auto& t : readers) t.join();
+    EXPECT_EQ(misses.load(), 0u);
+    EXPECT_EQ(table.size(), stable_keys);
+}
+
+
 // int main(int argc, char **argv) {
 //     ::testing::InitGoogleTest(&argc, argv);
 //     return RUN_ALL_TESTS();
 // }
+
+
+// --- Online resize ---
+TEST(ConcurrentHashTableResizeTest, GrowthIsIncremental) {
+    ConcurrentHashTable<uint32_t, uint32_t> table(100);
+    for (uint32_t i = 0; i < 90; ++i) {
+        table.insert(i, i);
+    }
+    EXPECT_EQ(table.getCapacity(), 100u);
+    EXPECT_FALSE(table.isResizing());
+
+    table.insert(90, 90); // Crosses 90% load
+    EXPECT_EQ(table.getCapacity(), 200u);
+    EXPECT_TRUE(table.isResizing()); // Only a small batch migrated so far
+
+    // Every key is visible mid-migration, whichever table it lives in.
+    for (uint32_t i = 0; i <= 90; ++i) {
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(i, value)) << "Key " << i << " lost during migration";
+        EXPECT_EQ(value, i);
+    }
+
+    // Further writes drain the old table.
+    for (uint32_t i = 91; i < 110; ++i) {
+        table.insert(i, i);
+    }
+    EXPECT_FALSE(table.isResizing());
+    EXPECT_EQ(table.size(), 110u);
+    for (uint32_t i = 0; i < 110; ++i) {
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(i, value));
+        EXPECT_EQ(value, i);
+    }
+    RcuUtils::processRcuCallbacks(); // Reclaim the drained array
+}
+
+TEST(ConcurrentHashTableResizeTest, UpdatesAndRemovesDuringMigration) {
+    ConcurrentHashTable<uint32_t, uint32_t> table(1000);
+    for (uint32_t i = 0; i < 901; ++i) {
+        table.insert(i, i);
+    }
+    ASSERT_TRUE(table.isResizing());
+
+    // Keys still in the old table are moved by an update and hidden by a remove.
+    for (uint32_t i = 0; i < 901; i += 3) {
+        table.insert(i, i + 5000);
+    }
+    for (uint32_t i = 1; i < 901; i += 3) {
+        EXPECT_TRUE(table.remove(i));
+        EXPECT_FALSE(table.remove(i));
+    }
+    EXPECT_EQ(table.size(), 901u - 300u);
+
+    for (uint32_t i = 0; i < 901; ++i) {
+        uint32_t value = 0;
+        bool found = table.lookup(i, value);
+        if (i % 3 == 1) {
+            EXPECT_FALSE(found) << "Removed key " << i << " resurrected from old table";
+        } else {
+            ASSERT_TRUE(found) << "Key " << i;
+            EXPECT_EQ(value, i % 3 == 0 ? i + 5000 : i);
+        }
+    }
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(ConcurrentHashTableResizeTest, GrowsFromThousandsToMillionsScale) {
+    ConcurrentHashTable<uint64_t, uint64_t> table(1024);
+    const uint64_t count = 200000;
+    for (uint64_t i = 0; i < count; ++i) {
+        table.insert(i * 2654435761ULL, i);
+    }
+    EXPECT_EQ(table.size(), count);
+    EXPECT_LE(table.getLoadFactor(), (ConcurrentHashTable<uint64_t, uint64_t>::kMaxLoadFactor));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t value = 0;
+        ASSERT_TRUE(table.lookup(i * 2654435761ULL, value));
+        ASSERT_EQ(value, i);
+    }
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(ConcurrentHashTableResizeTest, StringKeysSurviveMigration) {
+    ConcurrentHashTable<> table(8);
+    for (int i = 0; i < 500; ++i) {
+        table.insert("flow_" + std::to_string(i), i);
+    }
+    table.remove("flow_7");
+    for (int i = 0; i < 500; ++i) {
+        int value = -1;
+        if (i == 7) {
+            EXPECT_FALSE(table.lookup("flow_7", value));
+            continue;
+        }
+        ASSERT_TRUE(table.lookup("flow_" + std::to_string(i), value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(table.size(), 499u);
+}
+
+TEST(ConcurrentHashTableResizeTest, ConcurrentReadersDuringGrowth) {
+    ConcurrentHashTable<uint64_t, uint64_t> table(64);
+    const uint64_t stable_keys = 40;
+    for (uint64_t i = 0; i < stable_keys; ++i) {
+        table.insert(i, i + 1);
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> misses(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (uint64_t i = 0; i < stable_keys; ++i) {
+                    uint64_t value = 0;
+                    if (!table.lookup(i, value) || value != i + 1) {
+                        misses.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    // Grows through many generations while readers run.
+    for (uint64_t i = 0; i < 100000; ++i) {
+        table.insert(1000000 + i, i);
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(misses.load(), 0u);
+    EXPECT_EQ(table.size(), stable_keys + 100000);
+    RcuUtils::processRcuCallbacks();
+}
+
+// --- Bulk operations ---
+TEST(ConcurrentHashTableBatchTest, InsertAndRemoveBatch) {
+    ConcurrentHashTable<uint32_t, uint32_t> table(16);
+    std::vector<uint32_t> keys = {1, 2, 3, 4, 5, 3};
+    std::vector<uint32_t> values = {10, 20, 30, 40, 50, 33};
+    table.insertBatch(keys.data(), values.data(), keys.size());
+    EXPECT_EQ(table.size(), 5u);
+
+    uint32_t value = 0;
+    ASSERT_TRUE(table.lookup(3, value));
+    EXPECT_EQ(value, 33u); // Later duplicate wins
+
+    std::vector<uint32_t> to_remove = {1, 3, 99};
+    EXPECT_EQ(table.removeBatch(to_remove.data(), to_remove.size()), 2u);
+    EXPECT_EQ(table.size(), 3u);
+    EXPECT_FALSE(table.lookup(1, value));
+    EXPECT_TRUE(table.lookup(2, value));
+}
+
+TEST(ConcurrentHashTableBatchTest, LookupBatchMatchesSingleLookups) {
+    ConcurrentHashTable<uint64_t, uint64_t> table(1024);
+    for (uint64_t i = 0; i < 500; ++i) {
+        table.insert(i * 3, i);
+    }
+
+    // 150 keys: spans more than two chunks, with hits and misses interleaved.
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 150; ++i) {
+        keys.push_back(i * 2);
+    }
+    std::vector<uint64_t> out(keys.size(), 0);
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    table.lookupBatch(keys.data(), out.data(), found.get(), keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        uint64_t expected = 0;
+        bool expected_found = table.lookup(keys[i], expected);
+        ASSERT_EQ(found[i], expected_found) << "Key " << keys[i];
+        if (expected_found) {
+            EXPECT_EQ(out[i], expected);
+        }
+    }
+}
+
+TEST(ConcurrentHashTableBatchTest, LookupBatchDuringMigrationAndWithStrings) {
+    ConcurrentHashTable<uint32_t, uint32_t> table(100);
+    for (uint32_t i = 0; i < 91; ++i) {
+        table.insert(i, i + 1);
+    }
+    ASSERT_TRUE(table.isResizing());
+    std::vector<uint32_t> keys;
+    for (uint32_t i = 0; i < 100; ++i) {
+        keys.push_back(i);
+    }
+    std::vector<uint32_t> out(keys.size());
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    table.lookupBatch(keys.data(), out.data(), found.get(), keys.size());
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(found[i], i < 91);
+        if (i < 91) {
+            EXPECT_EQ(out[i], i + 1);
+        }
+    }
+
+    ConcurrentHashTable<> strings(16);
+    strings.insert("alpha", 1);
+    strings.insert("beta", 2);
+    std::string string_keys[] = {"alpha", "gamma", "beta"};
+    int string_out[3] = {0, 0, 0};
+    bool string_found[3];
+    strings.lookupBatch(string_keys, string_out, string_found, 3);
+    EXPECT_TRUE(string_found[0]);
+    EXPECT_EQ(string_out[0], 1);
+    EXPECT_FALSE(string_found[1]);
+    EXPECT_TRUE(string_found[2]);
+    EXPECT_EQ(string_out[2], 2);
+    RcuUtils::processRcuCallbacks();
+}
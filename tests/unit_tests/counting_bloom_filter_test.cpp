@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "data_structures/counting_bloom_filter.h"
+#include <string>
+#include <vector>
+
+TEST(CountingBloomFilterTest, ConstructorParams) {
+    CountingBloomFilter sized(100, 0.01); // Same sizing as BloomFilter: m = 959, k = 7
+    EXPECT_EQ(sized.getSize(), 959u);
+    EXPECT_EQ(sized.getNumHashFunctions(), 7);
+    EXPECT_EQ(sized.getBlockCount(), 8u); // 128 counters per 64-byte block
+
+    CountingBloomFilter manual(0, 0);
+    EXPECT_EQ(manual.getSize(), 1024u);
+    EXPECT_EQ(manual.getNumHashFunctions(), 3);
+}
+
+TEST(CountingBloomFilterTest, InsertRemoveContains) {
+    CountingBloomFilter cbf(1000, 0.01);
+    cbf.insert("rule_a");
+    cbf.insert("rule_b");
+    EXPECT_TRUE(cbf.possiblyContains("rule_a"));
+    EXPECT_TRUE(cbf.possiblyContains("rule_b"));
+    EXPECT_FALSE(cbf.possiblyContains("rule_c")); // Likely
+    EXPECT_EQ(cbf.getCount(), 2u);
+
+    EXPECT_TRUE(cbf.remove("rule_a"));
+    EXPECT_FALSE(cbf.possiblyContains("rule_a"));
+    EXPECT_TRUE(cbf.possiblyContains("rule_b"));
+    EXPECT_FALSE(cbf.remove("rule_c")); // Not present: no change
+    EXPECT_EQ(cbf.getCount(), 1u);
+
+    // Duplicates are counted.
+    cbf.insert("rule_b");
+    EXPECT_TRUE(cbf.remove("rule_b"));
+    EXPECT_TRUE(cbf.possiblyContains("rule_b"));
+    EXPECT_TRUE(cbf.remove("rule_b"));
+    EXPECT_FALSE(cbf.possiblyContains("rule_b"));
+    EXPECT_EQ(cbf.getCount(), 0u);
+}
+
+TEST(CountingBloomFilterTest, ChurnDoesNotAccumulate) {
+    // A day of rule churn: many generations of items, each fully removed
+    // before the next. A plain Bloom filter would saturate.
+    CountingBloomFilter cbf(1000, 0.01);
+    for (int generation = 0; generation < 50; ++generation) {
+        for (int i = 0; i < 1000; ++i) {
+            cbf.insert("gen" + std::to_string(generation) + "_" + std::to_string(i));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            ASSERT_TRUE(cbf.remove("gen" + std::to_string(generation) + "_" + std::to_string(i)));
+        }
+    }
+    EXPECT_EQ(cbf.getCount(), 0u);
+    EXPECT_EQ(cbf.getSaturatedCounterCount(), 0u);
+
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        if (cbf.possiblyContains("probe_" + std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+    EXPECT_EQ(false_positives, 0); // Every counter is back to zero
+}
+
+TEST(CountingBloomFilterTest, FalsePositiveRateAtCapacity) {
+    const int kItems = 5000;
+    CountingBloomFilter cbf(kItems, 0.01);
+    for (int i = 0; i < kItems; ++i) {
+        cbf.insert("item_" + std::to_string(i));
+    }
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_TRUE(cbf.possiblyContains("item_" + std::to_string(i)));
+    }
+    int false_positives = 0;
+    const int kProbes = 50000;
+    for (int i = 0; i < kProbes; ++i) {
+        if (cbf.possiblyContains("other_" + std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+    double measured = static_cast<double>(false_positives) / kProbes;
+    std::cout << "Counting Bloom FP rate: measured " << measured << ", predicted "
+              << cbf.getEffectiveFalsePositiveProbability() << std::endl;
+    EXPECT_LT(measured, 0.03);
+}
+
+TEST(CountingBloomFilterTest, SaturatedCountersNeverCauseFalseNegatives) {
+    CountingBloomFilter cbf(64, 2); // Tiny: one block of 64 counters
+    for (int i = 0; i < 40; ++i) {
+        cbf.insert("same");
+    }
+    EXPECT_GT(cbf.getSaturatedCounterCount(), 0u);
+    cbf.insert("other");
+    for (int i = 0; i < 40; ++i) {
+        cbf.remove("same");
+    }
+    // Saturated counters stay set, so "same" still looks present, and
+    // "other" (which may share a counter) is never lost.
+    EXPECT_TRUE(cbf.possiblyContains("other"));
+    EXPECT_TRUE(cbf.possiblyContains("same"));
+
+    cbf.clear();
+    EXPECT_FALSE(cbf.possiblyContains("same"));
+    EXPECT_EQ(cbf.getSaturatedCounterCount(), 0u);
+}
@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "data_structures/cuckoo_filter.h"
+#include "data_structures/bloom_filter.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+TEST(CuckooFilterTest, SizingRoundsUpToPowerOfTwoBuckets) {
+    CuckooFilter<> filter(1000);
+    EXPECT_EQ(filter.getBucketCount(), 512u); // 1000 / (4 * 0.95) = 264 -> 512
+    EXPECT_EQ(filter.getCapacity(), 2048u);
+    EXPECT_EQ(filter.size(), 0u);
+
+    CuckooFilter<> tiny(0);
+    EXPECT_GE(tiny.getBucketCount(), 2u);
+}
+
+TEST(CuckooFilterTest, InsertContainsRemove) {
+    CuckooFilter<> filter(1000);
+    ASSERT_TRUE(filter.insert("10.0.0.1"));
+    ASSERT_TRUE(filter.insert("10.0.0.2"));
+    EXPECT_TRUE(filter.possiblyContains("10.0.0.1"));
+    EXPECT_TRUE(filter.possiblyContains("10.0.0.2"));
+    EXPECT_FALSE(filter.possiblyContains("10.0.0.3")); // Likely
+    EXPECT_EQ(filter.size(), 2u);
+
+    EXPECT_TRUE(filter.remove("10.0.0.1"));
+    EXPECT_FALSE(filter.possiblyContains("10.0.0.1"));
+    EXPECT_TRUE(filter.possiblyContains("10.0.0.2"));
+    EXPECT_FALSE(filter.remove("10.0.0.1"));
+    EXPECT_EQ(filter.size(), 1u);
+
+    // Duplicates are stored separately.
+    ASSERT_TRUE(filter.insert("10.0.0.2"));
+    EXPECT_TRUE(filter.remove("10.0.0.2"));
+    EXPECT_TRUE(filter.possiblyContains("10.0.0.2"));
+    EXPECT_TRUE(filter.remove("10.0.0.2"));
+    EXPECT_FALSE(filter.possiblyContains("10.0.0.2"));
+}
+
+TEST(CuckooFilterTest, ByteInterface) {
+    CuckooFilter<uint8_t> filter(100);
+    unsigned char mac[] = {0x00, 0x1B, 0x44, 0x11, 0x3A, 0xB7};
+    ASSERT_TRUE(filter.insert(mac, sizeof(mac)));
+    EXPECT_TRUE(filter.possiblyContains(mac, sizeof(mac)));
+    EXPECT_TRUE(filter.remove(mac, sizeof(mac)));
+    EXPECT_FALSE(filter.possiblyContains(mac, sizeof(mac)));
+}
+
+template <typename Fingerprint>
+static void fillAndMeasure(double max_fp_rate) {
+    const int kItems = 20000;
+    CuckooFilter<Fingerprint> filter(kItems);
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_TRUE(filter.insert("item_" + std::to_string(i))) << "insert " << i;
+    }
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_TRUE(filter.possiblyContains("item_" + std::to_string(i)));
+    }
+    const int kProbes = 100000;
+    int false_positives = 0;
+    for (int i = 0; i < kProbes; ++i) {
+        if (filter.possiblyContains("other_" + std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+    double measured = static_cast<double>(false_positives) / kProbes;
+    std::cout << sizeof(Fingerprint) * 8 << "-bit cuckoo filter: load " << filter.getLoadFactor()
+              << ", FP rate measured " << measured << ", predicted "
+              << filter.getEffectiveFalsePositiveProbability() << std::endl;
+    EXPECT_LT(measured, max_fp_rate);
+
+    // Deleting everything leaves the filter empty.
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_TRUE(filter.remove("item_" + std::to_string(i)));
+    }
+    EXPECT_EQ(filter.size(), 0u);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_FALSE(filter.possiblyContains("item_" + std::to_string(i)));
+    }
+}
+
+TEST(CuckooFilterTest, EightBitFingerprints) { fillAndMeasure<uint8_t>(0.03); }
+TEST(CuckooFilterTest, SixteenBitFingerprints) { fillAndMeasure<uint16_t>(0.0005); }
+
+TEST(CuckooFilterTest, HighLoadThenFull) {
+    CuckooFilter<> filter(1000); // 2048 slots
+    size_t inserted = 0;
+    while (filter.insert("load_" + std::to_string(inserted))) {
+        ++inserted;
+        ASSERT_LT(inserted, 4096u);
+    }
+    // 4-way buckets reach ~95% occupancy before the first failure.
+    EXPECT_GE(filter.getLoadFactor(), 0.9);
+    // Every item that was accepted is still found, including the parked victim.
+    for (size_t i = 0; i < inserted; ++i) {
+        ASSERT_TRUE(filter.possiblyContains("load_" + std::to_string(i)));
+    }
+    // Removing items makes room again.
+    size_t removed = 0;
+    while (!filter.insert("after_full")) {
+        ASSERT_TRUE(filter.remove("load_" + std::to_string(removed)));
+        ++removed;
+        ASSERT_LT(removed, 64u);
+    }
+    EXPECT_TRUE(filter.possiblyContains("after_full"));
+    for (size_t i = removed; i < inserted; ++i) {
+        ASSERT_TRUE(filter.possiblyContains("load_" + std::to_string(i)));
+    }
+}
+
+TEST(CuckooFilterTest, ChurnKeepsFalsePositivesFlat) {
+    CuckooFilter<> filter(5000);
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 4000; ++i) {
+            ASSERT_TRUE(filter.insert("r" + std::to_string(round) + "_" + std::to_string(i)));
+        }
+        for (int i = 0; i < 4000; ++i) {
+            ASSERT_TRUE(filter.remove("r" + std::to_string(round) + "_" + std::to_string(i)));
+        }
+    }
+    EXPECT_EQ(filter.size(), 0u);
+    EXPECT_DOUBLE_EQ(filter.getEffectiveFalsePositiveProbability(), 0.0);
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "data_structures/cuckoo_hash.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <random>
+
+// CuckooHashTable<> is the default std::string -> int instantiation.
+
+TEST(CuckooHashTableTest, BasicInsertLookupRemove) {
+    CuckooHashTable<> table(16);
+    int value;
+    EXPECT_FALSE(table.lookup("missing", value));
+
+    table.insert("key1", 10);
+    table.insert("key2", 20);
+    ASSERT_TRUE(table.lookup("key1", value));
+    EXPECT_EQ(value, 10);
+    ASSERT_TRUE(table.lookup("key2", value));
+    EXPECT_EQ(value, 20);
+
+    table.insert("key1", 11); // Update in place
+    ASSERT_TRUE(table.lookup("key1", value));
+    EXPECT_EQ(value, 11);
+    EXPECT_EQ(table.size(), 2u);
+
+    EXPECT_TRUE(table.remove("key1"));
+    EXPECT_FALSE(table.remove("key1"));
+    EXPECT_FALSE(table.lookup("key1", value));
+    ASSERT_TRUE(table.lookup("key2", value));
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(CuckooHashTableTest, CapacityRoundsUpToBuckets) {
+    CuckooHashTable<> tiny(1);
+    EXPECT_EQ(tiny.getBucketCount(), 2u);
+    EXPECT_EQ(tiny.getCapacity(), 2 * CuckooHashTable<>::kSlotsPerBucket);
+    CuckooHashTable<> table(1000);
+    EXPECT_EQ(table.getBucketCount(), 256u);
+}
+
+TEST(CuckooHashTableTest, ReachesHighOccupancyBeforeGrowing) {
+    CuckooHashTable<uint64_t, uint64_t> table(1 << 16);
+    const size_t capacity = table.getCapacity();
+    const size_t target = static_cast<size_t>(capacity * 0.95);
+
+    std::mt19937_64 rng(77);
+    std::vector<uint64_t> keys;
+    keys.reserve(target);
+    for (size_t i = 0; i < target; ++i) {
+        keys.push_back(rng());
+        table.insert(keys.back(), i);
+    }
+    // Cuckoo paths absorb collisions up to 95% load without resizing.
+    EXPECT_EQ(table.getCapacity(), capacity);
+    EXPECT_GE(table.getLoadFactor(), 0.949);
+    for (size_t i = 0; i < target; ++i) {
+        uint64_t value = 0;
+        ASSERT_TRUE(table.lookup(keys[i], value));
+        ASSERT_EQ(value, i);
+    }
+}
+
+TEST(CuckooHashTableTest, GrowsWhenNoCuckooPathExists) {
+    CuckooHashTable<uint32_t, uint32_t> table(8);
+    for (uint32_t i = 0; i < 10000; ++i) {
+        table.insert(i, i ^ 0xABCD);
+    }
+    EXPECT_EQ(table.size(), 10000u);
+    EXPECT_GE(table.getCapacity(), 10000u);
+    for (uint32_t i = 0; i < 10000; ++i) {
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(i, value)) << i;
+        EXPECT_EQ(value, i ^ 0xABCD);
+    }
+    RcuUtils::processRcuCallbacks(); // Reclaim bucket arrays replaced while growing
+}
+
+TEST(CuckooHashTableTest, StringKeysSurviveDisplacementAndGrowth) {
+    CuckooHashTable<> table(8);
+    for (int i = 0; i < 2000; ++i) {
+        table.insert("host-" + std::to_string(i), i);
+    }
+    for (int i = 0; i < 2000; i += 2) {
+        EXPECT_TRUE(table.remove("host-" + std::to_string(i)));
+    }
+    for (int i = 0; i < 2000; ++i) {
+        int value = -1;
+        bool found = table.lookup("host-" + std::to_string(i), value);
+        EXPECT_EQ(found, i % 2 == 1) << i;
+        if (found) {
+            EXPECT_EQ(value, i);
+        }
+    }
+    EXPECT_EQ(table.size(), 1000u);
+}
+
+TEST(CuckooHashTableTest, RandomOperationsMatchReference) {
+    CuckooHashTable<uint64_t, uint64_t> table(64);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64 rng(31337);
+    std::uniform_int_distribution<uint64_t> key_dist(0, 3000);
+
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t key = key_dist(rng);
+        switch (rng() % 3) {
+        case 0:
+            table.insert(key, static_cast<uint64_t>(i));
+            reference[key] = static_cast<uint64_t>(i);
+            break;
+        case 1:
+            EXPECT_EQ(table.remove(key), reference.erase(key) == 1);
+            break;
+        default: {
+            uint64_t value = 0;
+            auto it = reference.find(key);
+            ASSERT_EQ(table.lookup(key, value), it != reference.end());
+            if (it != reference.end()) {
+                EXPECT_EQ(value, it->second);
+            }
+        }
+        }
+    }
+    EXPECT_EQ(table.size(), reference.size());
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(CuckooHashTableTest, ConcurrentReadersDuringDisplacement) {
+    // Start close to full so writer inserts trigger long cuckoo paths and grows.
+    CuckooHashTable<uint64_t, uint64_t> table(256);
+    const uint64_t stable_keys = 200;
+    for (uint64_t i = 0; i < stable_keys; ++i) {
+        table.insert(i, i * 11);
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> misses(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (uint64_t i = 0; i < stable_keys; ++i) {
+                    uint64_t value = 0;
+                    if (!table.lookup(i, value) || value != i * 11) {
+                        misses.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < 20000; ++i) {
+        table.insert(1000000 + i, i);
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(misses.load(), 0u);
+    RcuUtils::processRcuCallbacks();
+}
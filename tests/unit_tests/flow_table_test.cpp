@@ -0,0 +1,504 @@
+#include "gtest/gtest.h"
+#include "data_structures/flow_table.h"
+#include "packet_classifier.h"
+#include <vector>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+
+namespace {
+FlowTable::Config testConfig(uint64_t idle_ms, uint64_t hard_ms = 0) {
+    FlowTable::Config config;
+    config.idle_timeout_ms = idle_ms;
+    config.hard_timeout_ms = hard_ms;
+    config.tick_ms = 10;
+    config.initial_capacity = 64;
+    return config;
+}
+
+const FlowKey kFlowA(0x0A000001, 0x0A000002, 1234, 80, 6);
+const FlowKey kFlowB(0x0A000003, 0x0A000004, 5555, 53, 17);
+} // namespace
+
+TEST(FlowTableTest, TracksCountersAndTimestamps) {
+    FlowTable table(testConfig(1000));
+    EXPECT_TRUE(table.update(kFlowA, 100, 5000));
+    EXPECT_FALSE(table.update(kFlowA, 200, 5100));
+    EXPECT_TRUE(table.update(kFlowB, 60, 5200));
+
+    FlowEntry entry;
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.packets, 2u);
+    EXPECT_EQ(entry.bytes, 300u);
+    EXPECT_EQ(entry.first_seen, 5000u);
+    EXPECT_EQ(entry.last_seen, 5100u);
+    EXPECT_EQ(entry.idle_timeout, 1000u);
+    EXPECT_EQ(table.size(), 2u);
+
+    EXPECT_TRUE(table.remove(kFlowB));
+    EXPECT_FALSE(table.lookup(kFlowB, entry));
+    EXPECT_FALSE(table.remove(kFlowB));
+}
+
+TEST(FlowTableTest, IdleTimeoutExpiresQuietFlows) {
+    FlowTable table(testConfig(1000));
+    table.update(kFlowA, 100, 0);
+    table.update(kFlowB, 100, 0);
+
+    EXPECT_EQ(table.expire(999), 0u);
+    EXPECT_EQ(table.size(), 2u);
+
+    std::vector<FlowTable::ExpiredFlow> expired;
+    EXPECT_EQ(table.expire(1000, &expired), 2u);
+    EXPECT_EQ(table.size(), 0u);
+    ASSERT_EQ(expired.size(), 2u);
+    EXPECT_EQ(expired[0].second.packets, 1u);
+}
+
+TEST(FlowTableTest, ActivityPostponesIdleExpiry) {
+    FlowTable table(testConfig(1000));
+    table.update(kFlowA, 100, 0);
+    table.update(kFlowB, 100, 0);
+    table.update(kFlowA, 100, 800); // A's deadline moves to 1800
+
+    EXPECT_EQ(table.expire(1000), 1u); // Only B
+    FlowEntry entry;
+    EXPECT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_FALSE(table.lookup(kFlowB, entry));
+    EXPECT_EQ(table.pendingTimers(), 1u); // A's timer was re-armed, not duplicated
+
+    EXPECT_EQ(table.expire(1799), 0u);
+    EXPECT_EQ(table.expire(1800), 1u);
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(FlowTableTest, HardTimeoutIgnoresActivity) {
+    FlowTable table(testConfig(1000, 2500));
+    table.update(kFlowA, 100, 0);
+    for (uint64_t t = 500; t < 2500; t += 500) {
+        table.update(kFlowA, 100, t);
+        EXPECT_EQ(table.expire(t), 0u);
+    }
+    EXPECT_EQ(table.expire(2499), 0u);
+    EXPECT_EQ(table.expire(2500), 1u);
+}
+
+TEST(FlowTableTest, ZeroTimeoutsNeverExpire) {
+    FlowTable table(testConfig(0, 0));
+    table.update(kFlowA, 100, 0);
+    EXPECT_EQ(table.pendingTimers(), 0u);
+    EXPECT_EQ(table.expire(uint64_t{1} << 40), 0u);
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(FlowTableTest, SetTimeoutsCanShortenDeadline) {
+    FlowTable table(testConfig(60000));
+    table.update(kFlowA, 100, 0);
+    ASSERT_TRUE(table.setTimeouts(kFlowA, 100, 0));
+    EXPECT_FALSE(table.setTimeouts(kFlowB, 100, 0));
+    EXPECT_EQ(table.expire(100), 1u);
+    EXPECT_EQ(table.size(), 0u);
+    // The superseded 60 s timer fires later and is ignored.
+    EXPECT_EQ(table.expire(60000), 0u);
+    EXPECT_EQ(table.pendingTimers(), 0u);
+}
+
+TEST(FlowTableTest, DeadlinesRoundUpToTick) {
+    FlowTable table(testConfig(1000)); // 10 ms ticks
+    table.update(kFlowA, 100, 5);      // Deadline 1005, fires with tick 101
+    EXPECT_EQ(table.expire(1009), 0u);
+    EXPECT_EQ(table.expire(1010), 1u);
+}
+
+TEST(FlowTableTest, LargeClockValuesDoNotTickFromZero) {
+    FlowTable table(testConfig(1000));
+    uint64_t now = uint64_t{10} << 36; // e.g. a steady clock that has run for years
+    table.update(kFlowA, 100, now);
+    EXPECT_EQ(table.expire(now + 999), 0u);
+    EXPECT_EQ(table.expire(now + 1000), 1u);
+}
+
+TEST(FlowTableTest, RecreatedFlowIsNotExpiredByStaleTimer) {
+    FlowTable table(testConfig(1000));
+    table.update(kFlowA, 100, 0);
+    table.remove(kFlowA);
+    table.update(kFlowA, 100, 500); // New flow, deadline 1500
+    EXPECT_EQ(table.expire(1000), 0u);
+    FlowEntry entry;
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.first_seen, 500u);
+    EXPECT_EQ(table.expire(1500), 1u);
+}
+
+TEST(FlowTableTest, ManyFlowsExpireInOrder) {
+    FlowTable::Config config = testConfig(1000);
+    config.tick_ms = 1; // Millisecond-exact expiry
+    FlowTable table(config);
+    const uint32_t kFlows = 5000;
+    for (uint32_t i = 0; i < kFlows; ++i) {
+        table.update(FlowKey(i, 1, 1, 1, 6), 64, i); // Flow i idles out at 1000 + i
+    }
+    EXPECT_EQ(table.size(), kFlows);
+    EXPECT_EQ(table.expire(1000), 1u);
+    EXPECT_EQ(table.expire(1999), 999u);
+    EXPECT_EQ(table.expire(1000 + kFlows), kFlows - 1000u);
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(FlowTableTest, ConcurrentUpdatesAndExpiryKeepCounts) {
+    FlowTable table(testConfig(1000000));
+    const int kThreads = 4;
+    const int kFlowsPerThread = 200;
+    const int kRounds = 50;
+    std::atomic<bool> stop(false);
+    // Expiry runs alongside; nothing is due, but it races the shard locks.
+    std::thread expirer([&]() {
+        while (!stop) {
+            table.expire(5000);
+        }
+    });
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int round = 0; round < kRounds; ++round) {
+                for (int f = 0; f < kFlowsPerThread; ++f) {
+                    table.update(FlowKey(0x0A000000 + t, 0x0B000000 + f, 1000, 80, 6), 10, 5000 + round);
+                }
+                // Every thread also hits one shared flow.
+                table.update(kFlowA, 1, 5000 + round);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    stop = true;
+    expirer.join();
+
+    EXPECT_EQ(table.size(), static_cast<size_t>(kThreads * kFlowsPerThread + 1));
+    FlowEntry entry;
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.packets, static_cast<uint64_t>(kThreads * kRounds));
+    ASSERT_TRUE(table.lookup(FlowKey(0x0A000003, 0x0B000007, 1000, 80, 6), entry));
+    EXPECT_EQ(entry.packets, static_cast<uint64_t>(kRounds));
+    EXPECT_EQ(entry.bytes, static_cast<uint64_t>(kRounds * 10));
+    EXPECT_EQ(entry.last_seen, static_cast<uint64_t>(5000 + kRounds - 1));
+}
+
+TEST(FlowTableTest, RuleCacheFollowsGeneration) {
+    FlowTable table(testConfig(1000));
+    int rule_id = 0;
+    EXPECT_FALSE(table.getCachedRule(kFlowA, rule_id)); // Unknown flow
+    EXPECT_FALSE(table.setCachedRule(kFlowA, 7, table.getGeneration()));
+
+    table.update(kFlowA, 100, 0);
+    EXPECT_FALSE(table.getCachedRule(kFlowA, rule_id)); // Nothing cached yet
+
+    uint32_t generation = table.getGeneration();
+    ASSERT_TRUE(table.setCachedRule(kFlowA, 7, generation));
+    ASSERT_TRUE(table.getCachedRule(kFlowA, rule_id));
+    EXPECT_EQ(rule_id, 7);
+
+    // Counter updates keep the cached rule.
+    table.update(kFlowA, 100, 10);
+    ASSERT_TRUE(table.getCachedRule(kFlowA, rule_id));
+    EXPECT_EQ(rule_id, 7);
+
+    table.invalidateCachedRules();
+    EXPECT_FALSE(table.getCachedRule(kFlowA, rule_id));
+
+    // A result computed under an old generation is never served.
+    table.setCachedRule(kFlowA, 9, generation);
+    EXPECT_FALSE(table.getCachedRule(kFlowA, rule_id));
+
+    // No-match results are cached too.
+    table.setCachedRule(kFlowA, -1, table.getGeneration());
+    ASSERT_TRUE(table.getCachedRule(kFlowA, rule_id));
+    EXPECT_EQ(rule_id, -1);
+}
+
+TEST(FlowTableTest, TrackReportsCachedRule) {
+    FlowTable table(testConfig(1000));
+    FlowTable::TrackResult first = table.track(kFlowA, 100, 0);
+    EXPECT_EQ(first.cache_generation, 0u); // Nothing cached yet
+
+    uint32_t generation = table.getGeneration();
+    ASSERT_TRUE(table.setCachedRule(kFlowA, 7, generation));
+    FlowTable::TrackResult second = table.track(kFlowA, 100, 10);
+    EXPECT_EQ(second.cache_generation, generation);
+    EXPECT_EQ(second.cached_rule_id, 7);
+
+    table.invalidateCachedRules();
+    EXPECT_NE(table.track(kFlowA, 100, 20).cache_generation, table.getGeneration());
+}
+
+// --- PacketClassifier integration ---
+
+TEST(FlowTableTest, ClassifierCachesMatchedRulePerFlow) {
+    PacketClassifier classifier(false);
+    classifier.enableFlowCache(testConfig(60000));
+    ASSERT_TRUE(classifier.isFlowCacheEnabled());
+
+    PacketFilter web;
+    web.dest_port_low = 80;
+    web.dest_port_high = 80;
+    web.protocol = 6;
+    ActionList forward;
+    forward.primary_action = ActionList::ActionType::FORWARD;
+    forward.next_hop_id = 3;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, web, forward)));
+
+    PacketHeader packet(0x0A000001, 0x0A000002, 1234, 80, 6, 1500);
+    for (int i = 0; i < 3; ++i) {
+        ClassificationResult result = classifier.classify(packet);
+        ASSERT_TRUE(result.matched);
+        EXPECT_EQ(result.matched_rule_id, 1);
+        EXPECT_EQ(result.actions.next_hop_id, 3);
+    }
+    EXPECT_EQ(classifier.getRuleStatistics(1), 3u); // Cache hits still count
+
+    FlowEntry entry;
+    ASSERT_TRUE(classifier.getFlowTable()->lookup(kFlowA, entry));
+    EXPECT_EQ(entry.packets, 3u);
+    EXPECT_EQ(entry.bytes, 4500u);
+    EXPECT_EQ(entry.cached_rule_id, 1);
+
+    // A higher-priority rule added later must win for the existing flow.
+    ActionList drop;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 20, web, drop)));
+    EXPECT_EQ(classifier.classify(packet).matched_rule_id, 2);
+
+    // Deleting it falls back to rule 1, and deleting that to no match.
+    ASSERT_TRUE(classifier.deleteRule(2));
+    EXPECT_EQ(classifier.classify(packet).matched_rule_id, 1);
+    ASSERT_TRUE(classifier.deleteRule(1));
+    EXPECT_FALSE(classifier.classify(packet).matched);
+    EXPECT_FALSE(classifier.classify(packet).matched); // Cached no-match
+}
+
+TEST(FlowTableTest, ClassifierExpiresFlows) {
+    PacketClassifier classifier(false);
+    EXPECT_EQ(classifier.expireFlows(), 0u); // Disabled: no-op
+    classifier.enableFlowCache(testConfig(1000));
+
+    classifier.classify(PacketHeader(1, 2, 3, 4, 17));
+    classifier.classify(PacketHeader(5, 6, 7, 8, 17));
+    EXPECT_EQ(classifier.getFlowTable()->size(), 2u);
+
+    std::vector<FlowTable::ExpiredFlow> expired;
+    // Deadlines are rounded up to the 10 ms tick, so allow one extra tick.
+    EXPECT_EQ(classifier.expireFlows(PacketClassifier::flowClockMs() + 1010, &expired), 2u);
+    EXPECT_EQ(expired.size(), 2u);
+    EXPECT_EQ(classifier.getFlowTable()->size(), 0u);
+}
+
+// --- Connection tracking ---
+
+namespace {
+FlowTable::Config conntrackConfig() {
+    FlowTable::Config config = testConfig(60000);
+    config.conntrack = true;
+    config.tcp_closing_timeout_ms = 1000;
+    return config;
+}
+
+FlowKey reverse(const FlowKey& key) {
+    return FlowKey(key.dest_ip, key.source_ip, key.dest_port, key.source_port, key.protocol);
+}
+
+constexpr uint8_t kSynAck = TcpFlags::SYN | TcpFlags::ACK;
+} // namespace
+
+TEST(ConnTrackTest, CanonicalKeyIsDirectionIndependent) {
+    bool forward_reversed, reply_reversed;
+    FlowKey forward = canonicalFlowKey(kFlowB, forward_reversed);
+    FlowKey reply = canonicalFlowKey(reverse(kFlowB), reply_reversed);
+    EXPECT_TRUE(forward == reply);
+    EXPECT_NE(forward_reversed, reply_reversed);
+
+    // Same address on both ends: ports decide.
+    FlowKey loopback(1, 1, 9000, 80, 6);
+    bool reversed;
+    EXPECT_TRUE(canonicalFlowKey(loopback, reversed) == canonicalFlowKey(reverse(loopback), reversed));
+}
+
+TEST(ConnTrackTest, TcpHandshakeSharesOneEntry) {
+    FlowTable table(conntrackConfig());
+    FlowTable::TrackResult syn = table.track(kFlowA, 60, 0, TcpFlags::SYN);
+    EXPECT_TRUE(syn.created);
+    EXPECT_FALSE(syn.reply);
+    EXPECT_EQ(syn.state, ConnState::NEW);
+
+    FlowTable::TrackResult syn_ack = table.track(reverse(kFlowA), 60, 1, kSynAck);
+    EXPECT_FALSE(syn_ack.created);
+    EXPECT_TRUE(syn_ack.reply);
+    EXPECT_EQ(syn_ack.state, ConnState::ESTABLISHED);
+
+    EXPECT_EQ(table.track(kFlowA, 52, 2, TcpFlags::ACK).state, ConnState::ESTABLISHED);
+    EXPECT_EQ(table.track(reverse(kFlowA), 1500, 3, TcpFlags::ACK | TcpFlags::PSH).state, ConnState::ESTABLISHED);
+    EXPECT_EQ(table.size(), 1u);
+
+    FlowEntry forward, reply;
+    ASSERT_TRUE(table.lookup(kFlowA, forward));
+    ASSERT_TRUE(table.lookup(reverse(kFlowA), reply));
+    EXPECT_EQ(forward.tcp_state, TcpState::ESTABLISHED);
+    EXPECT_EQ(forward.packets, 4u);
+    EXPECT_EQ(forward.bytes, 1672u);
+    EXPECT_EQ(forward.reply_packets, 2u);
+    EXPECT_EQ(forward.reply_bytes, 1560u);
+    EXPECT_EQ(reply.packets, forward.packets);
+}
+
+TEST(ConnTrackTest, OutOfStateTcpPacketsAreInvalid) {
+    FlowTable table(conntrackConfig());
+    // Mid-stream packet with no connection: not tracked.
+    FlowTable::TrackResult stray = table.track(kFlowA, 60, 0, TcpFlags::ACK);
+    EXPECT_EQ(stray.state, ConnState::INVALID);
+    EXPECT_FALSE(stray.created);
+    EXPECT_EQ(table.size(), 0u);
+
+    table.track(kFlowA, 60, 0, TcpFlags::SYN);
+    EXPECT_EQ(table.track(reverse(kFlowA), 60, 1, TcpFlags::ACK).state, ConnState::INVALID); // No SYN+ACK
+    table.track(reverse(kFlowA), 60, 1, kSynAck);
+    table.track(kFlowA, 60, 2, TcpFlags::ACK);
+    EXPECT_EQ(table.track(reverse(kFlowA), 60, 3, TcpFlags::SYN).state, ConnState::INVALID);
+
+    FlowEntry entry;
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.tcp_state, TcpState::ESTABLISHED);
+}
+
+TEST(ConnTrackTest, FinAndResetShortenTimeout) {
+    FlowTable table(conntrackConfig());
+    table.track(kFlowA, 60, 0, TcpFlags::SYN);
+    table.track(reverse(kFlowA), 60, 0, kSynAck);
+    table.track(kFlowA, 60, 0, TcpFlags::ACK);
+    table.track(kFlowA, 60, 100, TcpFlags::FIN | TcpFlags::ACK);
+
+    FlowEntry entry;
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.tcp_state, TcpState::FIN_WAIT);
+    EXPECT_EQ(entry.idle_timeout, 60000u);
+
+    table.track(reverse(kFlowA), 60, 200, TcpFlags::FIN | TcpFlags::ACK);
+    ASSERT_TRUE(table.lookup(kFlowA, entry));
+    EXPECT_EQ(entry.tcp_state, TcpState::TIME_WAIT);
+    EXPECT_EQ(entry.idle_timeout, 1000u);
+    EXPECT_EQ(table.expire(1199), 0u);
+    EXPECT_EQ(table.expire(1200), 1u);
+
+    // Reset: later segments are invalid until a new SYN reuses the ports.
+    FlowKey tcp_b(kFlowB.source_ip, kFlowB.dest_ip, kFlowB.source_port, kFlowB.dest_port, 6);
+    table.track(tcp_b, 60, 2000, TcpFlags::SYN);
+    table.track(reverse(tcp_b), 60, 2000, TcpFlags::RST | TcpFlags::ACK);
+    ASSERT_TRUE(table.lookup(tcp_b, entry));
+    EXPECT_EQ(entry.tcp_state, TcpState::CLOSED);
+    EXPECT_EQ(table.track(tcp_b, 60, 2001, TcpFlags::ACK).state, ConnState::INVALID);
+    EXPECT_EQ(table.track(tcp_b, 60, 2002, TcpFlags::SYN).state, ConnState::NEW);
+    ASSERT_TRUE(table.lookup(tcp_b, entry));
+    EXPECT_EQ(entry.tcp_state, TcpState::SYN_SENT);
+    EXPECT_EQ(entry.idle_timeout, 60000u);
+}
+
+TEST(ConnTrackTest, UdpBecomesEstablishedOnReply) {
+    FlowTable table(conntrackConfig());
+    EXPECT_EQ(table.track(kFlowB, 60, 0).state, ConnState::NEW);
+    EXPECT_EQ(table.track(kFlowB, 60, 1).state, ConnState::NEW);
+    FlowTable::TrackResult reply = table.track(reverse(kFlowB), 60, 2);
+    EXPECT_TRUE(reply.reply);
+    EXPECT_EQ(reply.state, ConnState::ESTABLISHED);
+    EXPECT_EQ(table.track(kFlowB, 60, 3).state, ConnState::ESTABLISHED);
+}
+
+TEST(ConnTrackTest, ExpectedFlowsAreRelated) {
+    FlowTable plain(testConfig(1000));
+    EXPECT_FALSE(plain.expectRelated(kFlowB, 0));
+
+    FlowTable table(conntrackConfig());
+    ASSERT_TRUE(table.expectRelated(kFlowB, 0));
+    EXPECT_FALSE(table.expectRelated(reverse(kFlowB), 0)); // Same connection
+
+    // Whoever sends first is the originator, even if it is the "reverse" side.
+    FlowTable::TrackResult first = table.track(reverse(kFlowB), 60, 10);
+    EXPECT_FALSE(first.created);
+    EXPECT_FALSE(first.reply);
+    EXPECT_EQ(first.state, ConnState::RELATED);
+    EXPECT_EQ(table.track(kFlowB, 60, 20).state, ConnState::ESTABLISHED);
+}
+
+TEST(ConnTrackTest, RuleCacheIsPerDirectionAndState) {
+    FlowTable table(conntrackConfig());
+    table.track(kFlowB, 60, 0);
+    uint32_t generation = table.getGeneration();
+    ASSERT_TRUE(table.setCachedRule(kFlowB, 1, generation, ConnState::NEW));
+
+    int rule_id = 0;
+    ASSERT_TRUE(table.getCachedRule(kFlowB, rule_id, ConnState::NEW));
+    EXPECT_EQ(rule_id, 1);
+    EXPECT_FALSE(table.getCachedRule(kFlowB, rule_id, ConnState::ESTABLISHED));
+    EXPECT_FALSE(table.getCachedRule(reverse(kFlowB), rule_id, ConnState::NEW));
+
+    ASSERT_TRUE(table.setCachedRule(reverse(kFlowB), 2, generation, ConnState::ESTABLISHED));
+    ASSERT_TRUE(table.getCachedRule(reverse(kFlowB), rule_id, ConnState::ESTABLISHED));
+    EXPECT_EQ(rule_id, 2);
+    ASSERT_TRUE(table.getCachedRule(kFlowB, rule_id, ConnState::NEW));
+    EXPECT_EQ(rule_id, 1);
+}
+
+TEST(ConnTrackTest, TrackReportsCachedRuleForDirectionAndState) {
+    FlowTable table(conntrackConfig());
+    table.track(kFlowB, 60, 0);
+    uint32_t generation = table.getGeneration();
+    ASSERT_TRUE(table.setCachedRule(kFlowB, 1, generation, ConnState::NEW));
+    FlowTable::TrackResult again = table.track(kFlowB, 60, 1);
+    EXPECT_EQ(again.state, ConnState::NEW);
+    EXPECT_EQ(again.cache_generation, generation);
+    EXPECT_EQ(again.cached_rule_id, 1);
+
+    // The reply is ESTABLISHED, in the other direction: nothing cached for it.
+    FlowTable::TrackResult reply = table.track(reverse(kFlowB), 60, 2);
+    EXPECT_EQ(reply.state, ConnState::ESTABLISHED);
+    EXPECT_EQ(reply.cache_generation, 0u);
+}
+
+TEST(ConnTrackTest, ClassifierStatefulAcl) {
+    PacketClassifier classifier(false);
+    FlowTable::Config config = conntrackConfig();
+    classifier.enableFlowCache(config);
+
+    ActionList accept;
+    accept.primary_action = ActionList::ActionType::FORWARD;
+    ActionList drop;
+
+    PacketFilter established;
+    established.conn_state_mask = ConnStateMask::ESTABLISHED | ConnStateMask::RELATED;
+    PacketFilter new_web;
+    new_web.dest_port_low = 80;
+    new_web.dest_port_high = 80;
+    new_web.protocol = 6;
+    new_web.conn_state_mask = ConnStateMask::NEW;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 30, established, accept)));
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 20, new_web, accept)));
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(3, 1, PacketFilter(), drop)));
+
+    PacketHeader syn(0x0A000001, 0x0A000002, 1234, 80, 6, 60, TcpFlags::SYN);
+    PacketHeader syn_ack(0x0A000002, 0x0A000001, 80, 1234, 6, 60, kSynAck);
+    PacketHeader ack(0x0A000001, 0x0A000002, 1234, 80, 6, 52, TcpFlags::ACK);
+    EXPECT_EQ(classifier.classify(syn).matched_rule_id, 2);
+    EXPECT_EQ(classifier.classify(syn_ack).matched_rule_id, 1);
+    EXPECT_EQ(classifier.classify(ack).matched_rule_id, 1);
+    PacketHeader data_reply(0x0A000002, 0x0A000001, 80, 1234, 6, 1500, TcpFlags::ACK | TcpFlags::PSH);
+    EXPECT_EQ(classifier.classify(data_reply).matched_rule_id, 1);
+    EXPECT_EQ(classifier.classify(data_reply).matched_rule_id, 1); // Cached reply direction
+    EXPECT_EQ(classifier.classify(syn_ack).matched_rule_id, 3);    // SYN+ACK after the handshake is INVALID
+    EXPECT_EQ(classifier.getFlowTable()->size(), 1u);
+
+    // Unsolicited inbound connection and stray segments fall through to drop.
+    EXPECT_EQ(classifier.classify(PacketHeader(0x0B000001, 0x0A000001, 4444, 22, 6, 60, TcpFlags::SYN)).matched_rule_id, 3);
+    EXPECT_EQ(classifier.classify(PacketHeader(0x0B000001, 0x0A000001, 5555, 80, 6, 60, TcpFlags::ACK)).matched_rule_id, 3);
+
+    // Without connection tracking, state-qualified rules never match.
+    PacketClassifier stateless(false);
+    ASSERT_TRUE(stateless.addRule(ClassificationRule(1, 30, established, accept)));
+    EXPECT_FALSE(stateless.classify(syn_ack).matched);
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "utils/hashing.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <cstdint>
+
+using namespace HashUtils;
+
+static uint32_t ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(c) << 8) | d;
+}
+
+TEST(HashingTest, Crc32cKnownVectors) {
+    const std::string check = "123456789";
+    EXPECT_EQ(crc32c(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(crc32cSoftware(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(crc32c(nullptr, 0), 0u);
+
+    // Chaining over split input equals one pass.
+    uint32_t partial = crc32c(check.data(), 4);
+    EXPECT_EQ(crc32c(check.data() + 4, check.size() - 4, partial), 0xE3069283u);
+}
+
+TEST(HashingTest, Crc32cHardwareMatchesSoftware) {
+    std::mt19937 rng(5);
+    std::vector<uint8_t> buffer(300);
+    for (auto& b : buffer) b = static_cast<uint8_t>(rng());
+    for (size_t len = 0; len <= buffer.size(); len += 7) {
+        EXPECT_EQ(crc32c(buffer.data(), len, 0x1234u), crc32cSoftware(buffer.data(), len, 0x1234u)) << len;
+    }
+}
+
+TEST(HashingTest, ToeplitzMatchesRssSpecification) {
+    // Verification suite from the Microsoft RSS specification (default key).
+    ToeplitzHasher rss;
+    EXPECT_EQ(rss.hashIPv4Tuple(ipv4(66, 9, 149, 187), ipv4(161, 142, 100, 80), 2794, 1766), 0x51ccc178u);
+    EXPECT_EQ(rss.hashIPv4(ipv4(66, 9, 149, 187), ipv4(161, 142, 100, 80)), 0x323e8fc2u);
+    EXPECT_EQ(rss.hashIPv4Tuple(ipv4(199, 92, 111, 2), ipv4(65, 69, 140, 83), 14230, 4739), 0xc626b0eau);
+    EXPECT_EQ(rss.hashIPv4(ipv4(199, 92, 111, 2), ipv4(65, 69, 140, 83)), 0xd718262au);
+    EXPECT_EQ(rss.getMaxInputLength(), 36u);
+}
+
+TEST(HashingTest, ToeplitzTableMatchesBitSerial) {
+    ToeplitzHasher rss;
+    std::mt19937 rng(11);
+    uint8_t input[36];
+    for (int round = 0; round < 50; ++round) {
+        for (auto& b : input) b = static_cast<uint8_t>(rng());
+        size_t len = round % 37;
+        EXPECT_EQ(rss.hash(input, len), toeplitz(input, len));
+    }
+}
+
+TEST(HashingTest, Murmur3KnownVectors) {
+    EXPECT_EQ(murmur3("", 0, 0), 0u);
+    EXPECT_EQ(murmur3("", 0, 1), 0x514E28B7u);
+    EXPECT_EQ(murmur3("hello", 5, 0), 0x248BFA47u);
+    const std::string fox = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(murmur3(fox.data(), fox.size(), 0), 0x2E4FF723u);
+}
+
+TEST(HashingTest, BatchHashesMatchScalar) {
+    std::mt19937 rng(3);
+    // 21 keys: two full AVX2 batches plus a scalar remainder.
+    const size_t n = 21;
+    std::vector<uint8_t> tuples(n * kFiveTupleKeySize);
+    std::vector<uint8_t> macs(n * kMacKeySize);
+    for (auto& b : tuples) b = static_cast<uint8_t>(rng());
+    for (auto& b : macs) b = static_cast<uint8_t>(rng());
+
+    std::vector<uint32_t> out(n);
+    murmur3FiveTupleBatch(tuples.data(), n, out.data(), 42);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i], murmur3(tuples.data() + i * kFiveTupleKeySize, kFiveTupleKeySize, 42)) << i;
+    }
+    murmur3MacBatch(macs.data(), n, out.data(), 7);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(out[i], murmur3(macs.data() + i * kMacKeySize, kMacKeySize, 7)) << i;
+    }
+}
+
+TEST(HashingTest, WyhashIsSeededAndWellSpread) {
+    const std::string text = "10.0.0.1:443->192.168.1.7:51000/tcp";
+    EXPECT_EQ(wyhash(text.data(), text.size()), wyhash(text.data(), text.size()));
+    EXPECT_NE(wyhash(text.data(), text.size(), 1), wyhash(text.data(), text.size(), 2));
+
+    // Every length path (0, 1-3, 4-16, 17-48, >48) and no collisions on prefixes.
+    std::vector<uint8_t> buffer(200);
+    for (size_t i = 0; i < buffer.size(); ++i) buffer[i] = static_cast<uint8_t>(i * 31 + 7);
+    std::set<uint64_t> seen;
+    for (size_t len = 0; len <= buffer.size(); ++len) {
+        seen.insert(wyhash(buffer.data(), len));
+    }
+    EXPECT_EQ(seen.size(), buffer.size() + 1);
+
+    // Flipping one input bit flips about half of the output bits.
+    uint8_t key[kFiveTupleKeySize] = {10, 0, 0, 1, 192, 168, 1, 7, 1, 187, 199, 56, 6};
+    uint64_t base = hashFiveTuple(key);
+    EXPECT_EQ(base, wyhash(key, sizeof(key)));
+    int total_flipped = 0;
+    for (size_t bit = 0; bit < sizeof(key) * 8; ++bit) {
+        key[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+        total_flipped += __builtin_popcountll(base ^ hashFiveTuple(key));
+        key[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+    }
+    double average = static_cast<double>(total_flipped) / (sizeof(key) * 8);
+    EXPECT_GT(average, 28.0);
+    EXPECT_LT(average, 36.0);
+
+    uint8_t mac[kMacKeySize] = {0x00, 0x50, 0x56, 0xAB, 0xCD, 0xEF};
+    EXPECT_EQ(hashMac(mac), wyhash(mac, sizeof(mac)));
+}
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "utils/ip_utils.h"
+#include <string>
+
+TEST(IpUtilsTest, ParsesAddresses) {
+    uint32_t address = 0;
+    ASSERT_TRUE(IpUtils::parseIPv4Address("192.168.1.1", address));
+    EXPECT_EQ(address, 0xC0A80101u);
+    ASSERT_TRUE(IpUtils::parseIPv4Address("0.0.0.0", address));
+    EXPECT_EQ(address, 0u);
+    ASSERT_TRUE(IpUtils::parseIPv4Address("255.255.255.255", address));
+    EXPECT_EQ(address, 0xFFFFFFFFu);
+
+    EXPECT_FALSE(IpUtils::parseIPv4Address("", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("1.2.3", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("1.2.3.4.5", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("256.1.1.1", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("1..2.3", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("1.2.3.4 ", address));
+    EXPECT_FALSE(IpUtils::parseIPv4Address("0001.2.3.4", address));
+}
+
+TEST(IpUtilsTest, ParsesPrefixes) {
+    uint32_t network = 0;
+    uint8_t length = 0;
+    ASSERT_TRUE(IpUtils::parseIPv4Prefix("10.1.2.3/8", network, length));
+    EXPECT_EQ(network, 0x0A000000u); // Host bits cleared
+    EXPECT_EQ(length, 8);
+    ASSERT_TRUE(IpUtils::parseIPv4Prefix("10.1.2.3", network, length));
+    EXPECT_EQ(network, 0x0A010203u);
+    EXPECT_EQ(length, 32);
+    ASSERT_TRUE(IpUtils::parseIPv4Prefix("1.2.3.4/0", network, length));
+    EXPECT_EQ(network, 0u);
+    EXPECT_EQ(length, 0);
+
+    EXPECT_FALSE(IpUtils::parseIPv4Prefix("10.0.0.0/33", network, length));
+    EXPECT_FALSE(IpUtils::parseIPv4Prefix("10.0.0.0/", network, length));
+    EXPECT_FALSE(IpUtils::parseIPv4Prefix("10.0.0.0/x", network, length));
+    EXPECT_FALSE(IpUtils::parseIPv4Prefix("any", network, length));
+}
+
+TEST(IpUtilsTest, PrefixMaskAndContains) {
+    EXPECT_EQ(IpUtils::prefixMask(0), 0u);
+    EXPECT_EQ(IpUtils::prefixMask(8), 0xFF000000u);
+    EXPECT_EQ(IpUtils::prefixMask(31), 0xFFFFFFFEu);
+    EXPECT_EQ(IpUtils::prefixMask(32), 0xFFFFFFFFu);
+
+    EXPECT_TRUE(IpUtils::prefixContains(0xC0A80100u, 24, 0xC0A801FEu));
+    EXPECT_FALSE(IpUtils::prefixContains(0xC0A80100u, 24, 0xC0A80201u));
+
+    EXPECT_TRUE(IpUtils::matchesPrefixText("192.168.1.0/24", 0xC0A80163u));
+    EXPECT_FALSE(IpUtils::matchesPrefixText("192.168.1.0/24", 0xC0A80263u));
+    EXPECT_TRUE(IpUtils::matchesPrefixText("", 0x01020304u));
+    EXPECT_TRUE(IpUtils::matchesPrefixText("not-an-ip", 0x01020304u)); // No restriction
+}
+
+TEST(IpUtilsTest, FormatsAddresses) {
+    EXPECT_EQ(IpUtils::formatIPv4(0xC0A80101u), "192.168.1.1");
+    EXPECT_EQ(IpUtils::formatIPv4(0u), "0.0.0.0");
+}
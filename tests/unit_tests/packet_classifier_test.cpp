@@ -0,0 +1,300 @@
+#include "gtest/gtest.h"
+#include "packet_classifier.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+PacketFilter portFilter(uint16_t dport, uint8_t proto = 6) {
+    PacketFilter filter;
+    filter.dest_port_low = dport;
+    filter.dest_port_high = dport;
+    filter.protocol = proto;
+    return filter;
+}
+
+PacketHeader packetTo(uint16_t dport, uint8_t proto = 6) {
+    return PacketHeader(0x0A000001, 0x0A000002, 40000, dport, proto);
+}
+
+} // anonymous namespace
+
+TEST(PacketClassifierTest, RuleSetVersionAdvancesOnlyOnSuccessfulChanges) {
+    PacketClassifier classifier;
+    ActionList drop;
+    uint64_t version = classifier.getRuleSetVersion();
+
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop)));
+    EXPECT_EQ(classifier.getRuleSetVersion(), version + 1);
+    EXPECT_FALSE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop))); // Duplicate ID
+    EXPECT_EQ(classifier.getRuleSetVersion(), version + 1);
+
+    ASSERT_TRUE(classifier.modifyRule(1, ClassificationRule(1, 10, portFilter(443), drop)));
+    EXPECT_EQ(classifier.getRuleSetVersion(), version + 2);
+    EXPECT_FALSE(classifier.deleteRule(42));
+    ASSERT_TRUE(classifier.deleteRule(1));
+    EXPECT_EQ(classifier.getRuleSetVersion(), version + 3);
+}
+
+TEST(PacketClassifierTest, HighestPriorityEnabledRuleWins) {
+    PacketClassifier classifier;
+    ActionList drop;
+    ActionList forward;
+    forward.primary_action = ActionList::ActionType::FORWARD;
+    forward.next_hop_id = 7;
+
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop)));
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 20, portFilter(80), forward)));
+    ClassificationResult result = classifier.classify(packetTo(80));
+    EXPECT_EQ(result.matched_rule_id, 2);
+    EXPECT_EQ(result.actions.next_hop_id, 7);
+
+    // Disabling the winner exposes the lower-priority rule.
+    ClassificationRule disabled(2, 20, portFilter(80), forward);
+    disabled.enabled = false;
+    ASSERT_TRUE(classifier.modifyRule(2, disabled));
+    EXPECT_EQ(classifier.classify(packetTo(80)).matched_rule_id, 1);
+
+    // Raising the other rule's priority is picked up by the next snapshot.
+    ASSERT_TRUE(classifier.modifyRule(2, ClassificationRule(2, 5, portFilter(80), forward)));
+    EXPECT_EQ(classifier.classify(packetTo(80)).matched_rule_id, 1);
+    ASSERT_TRUE(classifier.modifyRule(1, ClassificationRule(1, 1, portFilter(80), drop)));
+    EXPECT_EQ(classifier.classify(packetTo(80)).matched_rule_id, 2);
+}
+
+TEST(PacketClassifierTest, RejectsRulesWithInvalidPrefixes) {
+    PacketClassifier classifier;
+    ActionList drop;
+    PacketFilter filter = portFilter(80);
+    filter.source_ip_prefix = "10.0.0.0/33";
+    EXPECT_FALSE(classifier.addRule(ClassificationRule(1, 10, filter, drop)));
+    EXPECT_FALSE(classifier.classify(packetTo(80)).matched);
+
+    filter.source_ip_prefix = "10.0.0.0/8";
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, filter, drop)));
+    uint64_t version = classifier.getRuleSetVersion();
+    filter.source_ip_prefix = "10.0.0/8";
+    EXPECT_FALSE(classifier.modifyRule(1, ClassificationRule(1, 10, filter, drop)));
+    EXPECT_EQ(classifier.getRuleSetVersion(), version);
+    // Still restricted to 10.0.0.0/8.
+    PacketHeader outside(0x0B000001, 0x0A000002, 40000, 80, 6);
+    EXPECT_FALSE(classifier.classify(outside).matched);
+    EXPECT_EQ(classifier.classify(packetTo(80)).matched_rule_id, 1);
+}
+
+TEST(PacketClassifierTest, AddRulesPublishesOnce) {
+    PacketClassifier classifier;
+    ActionList drop;
+    std::vector<ClassificationRule> rules;
+    for (int id = 1; id <= 200; ++id) {
+        PacketFilter filter = portFilter(static_cast<uint16_t>(1000 + id));
+        filter.dest_ip_prefix = "10.0.0.0/24";
+        rules.emplace_back(id, id, filter, drop);
+    }
+    PacketFilter invalid = portFilter(80);
+    invalid.source_ip_prefix = "10.0.0/8";
+    rules.emplace_back(500, 1, invalid, drop);
+    rules.emplace_back(7, 1, portFilter(80), drop); // Duplicate ID
+
+    uint64_t version = classifier.getRuleSetVersion();
+    EXPECT_EQ(classifier.addRules(rules), 200u);
+    EXPECT_EQ(classifier.getRuleSetVersion(), version + 1);
+    EXPECT_EQ(classifier.getRulePrefilter()->getRuleCount(), 200u);
+    EXPECT_EQ(classifier.classify(packetTo(1001)).matched_rule_id, 1);
+    EXPECT_EQ(classifier.classify(packetTo(1200)).matched_rule_id, 200);
+    EXPECT_FALSE(classifier.classify(packetTo(80)).matched);
+    PacketHeader other_net(0x0A000001, 0x0A000102, 40000, 1100, 6);
+    EXPECT_FALSE(classifier.classify(other_net).matched);
+
+    // Bulk-loaded rules behave like individually added ones.
+    ASSERT_TRUE(classifier.deleteRule(1));
+    EXPECT_FALSE(classifier.classify(packetTo(1001)).matched);
+    EXPECT_EQ(classifier.addRules({}), 0u);
+}
+
+TEST(PacketClassifierTest, StatisticsSurviveRuleSetRecompilation) {
+    PacketClassifier classifier;
+    ActionList drop;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop)));
+    classifier.classify(packetTo(80));
+    classifier.classify(packetTo(80));
+
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 5, portFilter(53, 17), drop)));
+    ASSERT_TRUE(classifier.modifyRule(1, ClassificationRule(1, 15, portFilter(80), drop)));
+    classifier.classify(packetTo(80));
+    classifier.classify(packetTo(53, 17));
+
+    std::map<int, uint64_t> stats = classifier.getStatistics();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[1], 3u);
+    EXPECT_EQ(stats[2], 1u);
+
+    classifier.resetRuleStatistics(1);
+    EXPECT_EQ(classifier.getRuleStatistics(1), 0u);
+    EXPECT_EQ(classifier.getRuleStatistics(2), 1u);
+
+    // A deleted and re-added rule starts counting from zero.
+    ASSERT_TRUE(classifier.deleteRule(2));
+    EXPECT_EQ(classifier.getRuleStatistics(2), 0u);
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 5, portFilter(53, 17), drop)));
+    EXPECT_EQ(classifier.getRuleStatistics(2), 0u);
+    classifier.resetStatistics();
+    EXPECT_EQ(classifier.getStatistics()[1], 0u);
+}
+
+TEST(PacketClassifierTest, ClassifyRunsConcurrentlyWithRuleChanges) {
+    PacketClassifier classifier;
+    ActionList drop;
+    // Rule 1 is permanent; rule 2 (same packet, higher priority) keeps being
+    // added, modified and deleted underneath the readers.
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop)));
+
+    std::atomic<bool> stop(false);
+    std::atomic<bool> bad_result(false);
+    std::atomic<uint64_t> classified(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                ClassificationResult result = classifier.classify(packetTo(80));
+                if (!result.matched || (result.matched_rule_id != 1 && result.matched_rule_id != 2)) {
+                    bad_result.store(true);
+                }
+                classified.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 20, portFilter(80), drop)));
+        ASSERT_TRUE(classifier.modifyRule(2, ClassificationRule(2, 30, portFilter(80), drop)));
+        ASSERT_TRUE(classifier.deleteRule(2));
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_FALSE(bad_result.load());
+    EXPECT_GT(classified.load(), 0u);
+    EXPECT_EQ(classifier.classify(packetTo(80)).matched_rule_id, 1);
+}
+
+namespace {
+
+// Readers keep classifying a flow no rule matches while rule 3, which
+// matches it, is added and deleted. Once addRule() has returned, neither cache
+// may keep serving the old no-match. Returns the number of stale results.
+int staleResultsAfterAddRule(PacketClassifier& classifier) {
+    ActionList drop;
+    PacketFilter partner; // Lets port 1500 past the pre-filter without matching it
+    partner.dest_port_low = 1000;
+    partner.dest_port_high = 2000;
+    partner.source_ip_prefix = "192.168.0.0/16";
+    EXPECT_TRUE(classifier.addRule(ClassificationRule(1, 5, partner, drop)));
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                classifier.classify(packetTo(1500));
+            }
+        });
+    }
+    int stale = 0;
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE(classifier.addRule(ClassificationRule(3, 10, portFilter(1500), drop)));
+        for (int j = 0; j < 20; ++j) {
+            if (classifier.classify(packetTo(1500)).matched_rule_id != 3) {
+                ++stale;
+            }
+        }
+        EXPECT_TRUE(classifier.deleteRule(3));
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    return stale;
+}
+
+} // anonymous namespace
+
+TEST(PacketClassifierTest, FlowCacheNeverServesResultsOfReplacedRules) {
+    PacketClassifier classifier;
+    classifier.enableFlowCache();
+    EXPECT_EQ(staleResultsAfterAddRule(classifier), 0);
+}
+
+TEST(PacketClassifierTest, MissCacheNeverServesResultsOfReplacedRules) {
+    PacketClassifier classifier;
+    RotatingBloomFilter::Config config;
+    config.slice_ms = 60000; // No rotation during the test
+    classifier.enableMissCache(config);
+    EXPECT_EQ(staleResultsAfterAddRule(classifier), 0);
+}
+
+TEST(PacketClassifierTest, MissCacheUnderConcurrentReaders) {
+    PacketClassifier classifier;
+    RotatingBloomFilter::Config config;
+    config.slice_ms = 60000; // No rotation during the test
+    classifier.enableMissCache(config);
+    ActionList drop;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, portFilter(80), drop)));
+    // Lets the miss ports below past the pre-filter, but never matches them
+    // (wrong source), so they reach the rule loop and get cached.
+    PacketFilter partner;
+    partner.dest_port_low = 1000;
+    partner.dest_port_high = 2000;
+    partner.source_ip_prefix = "192.168.0.0/16";
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 5, partner, drop)));
+
+    std::atomic<int> wrong(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            for (int i = 0; i < 2000; ++i) {
+                // Misses on a few hundred distinct ports fill the cache (far
+                // below its capacity, so port 80 is practically never a Bloom
+                // false positive); port 80 must keep matching.
+                if (classifier.classify(packetTo(static_cast<uint16_t>(1000 + t * 200 + i % 200))).matched) wrong++;
+                if (classifier.classify(packetTo(80)).matched_rule_id != 1) wrong++;
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(wrong.load(), 0);
+    EXPECT_GT(classifier.getMissCache()->getInsertCount(), 0u);
+}
+
+TEST(PacketClassifierTest, ParallelBatchMatchesSerialOrder) {
+    PacketClassifier classifier;
+    ActionList drop;
+    for (int r = 0; r < 8; ++r) {
+        ASSERT_TRUE(classifier.addRule(ClassificationRule(r + 1, 10, portFilter(static_cast<uint16_t>(100 + r)), drop)));
+    }
+    std::vector<PacketHeader> batch;
+    for (int i = 0; i < 5000; ++i) {
+        batch.push_back(packetTo(static_cast<uint16_t>(100 + i % 10))); // Ports 108, 109 miss
+    }
+    std::vector<ClassificationResult> serial = classifier.classifyBatch(batch);
+
+    classifier.enableParallelBatch(4);
+    ASSERT_TRUE(classifier.isParallelBatchEnabled());
+    std::vector<ClassificationResult> parallel = classifier.classifyBatch(batch);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ASSERT_EQ(parallel[i].matched, serial[i].matched) << "packet " << i;
+        ASSERT_EQ(parallel[i].matched_rule_id, serial[i].matched_rule_id) << "packet " << i;
+    }
+    // Every packet was counted exactly once per batch.
+    EXPECT_EQ(classifier.getRuleStatistics(1), 1000u);
+
+    // Small batches stay on the calling thread.
+    std::vector<PacketHeader> small(batch.begin(), batch.begin() + 10);
+    EXPECT_EQ(classifier.classifyBatch(small)[3].matched_rule_id, 4);
+}
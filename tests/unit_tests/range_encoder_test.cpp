@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "utils/range_encoder.h"
+#include "packet_classifier.h" // For PacketFilter
+#include <vector>
+#include <utility>
+#include <random>
+
+// Exhaustively checks that 'entries' cover exactly [low, high] in the key domain of 'encoding'.
+static void expectExactCover(const std::vector<TernaryPortEntry>& entries, uint16_t low, uint16_t high,
+                             PortEncoding encoding) {
+    for (uint32_t port = 0; port <= 0xFFFF; ++port) {
+        uint16_t key = RangeEncoder::encodeKey(static_cast<uint16_t>(port), encoding);
+        bool covered = false;
+        for (const auto& e : entries) {
+            if (e.matches(key)) { covered = true; break; }
+        }
+        bool in_range = port >= low && port <= high;
+        ASSERT_EQ(covered, in_range) << "Range [" << low << ", " << high << "] port " << port;
+    }
+}
+
+TEST(RangeEncoderTest, SinglePortAndFullRange) {
+    auto single = RangeEncoder::rangeToPrefixes(80, 80);
+    ASSERT_EQ(single.size(), 1u);
+    EXPECT_EQ(single[0].prefixLength(), 16);
+    EXPECT_EQ(single[0].value, 80);
+
+    auto full = RangeEncoder::rangeToPrefixes(0, 65535);
+    ASSERT_EQ(full.size(), 1u);
+    EXPECT_EQ(full[0].mask, 0);
+    EXPECT_EQ(full[0].toString(), "****************");
+
+    auto full_srge = RangeEncoder::rangeToSrge(0, 65535);
+    ASSERT_EQ(full_srge.size(), 1u);
+    EXPECT_EQ(full_srge[0].mask, 0);
+}
+
+TEST(RangeEncoderTest, KnownPrefixExpansions) {
+    // Ephemeral ports: 1024-65535 = 6 prefixes (/6 /5 /4 /3 /2 /1).
+    auto ephemeral = RangeEncoder::rangeToPrefixes(1024, 65535);
+    EXPECT_EQ(ephemeral.size(), 6u);
+    for (const auto& e : ephemeral) {
+        EXPECT_TRUE(e.isPrefix());
+    }
+    expectExactCover(ephemeral, 1024, 65535, PortEncoding::PREFIX);
+
+    // Worst case for prefix expansion on W=16 bits is 2W-2.
+    auto worst = RangeEncoder::rangeToPrefixes(1, 65534);
+    EXPECT_EQ(worst.size(), 30u);
+    expectExactCover(worst, 1, 65534, PortEncoding::PREFIX);
+}
+
+TEST(RangeEncoderTest, SrgeReducesWorstCase) {
+    auto worst = RangeEncoder::rangeToSrge(1, 65534);
+    EXPECT_LE(worst.size(), 28u); // 2W-4
+    expectExactCover(worst, 1, 65534, PortEncoding::SRGE);
+
+    // Symmetric range around a block boundary collapses into a single entry per block pair.
+    auto symmetric = RangeEncoder::rangeToSrge(3, 12);
+    EXPECT_EQ(symmetric.size(), 2u);
+    expectExactCover(symmetric, 3, 12, PortEncoding::SRGE);
+}
+
+TEST(RangeEncoderTest, SrgeNeverWorseThanPrefixAndAlwaysExact) {
+    std::vector<std::pair<uint16_t, uint16_t>> ranges = {
+        {0, 0}, {0, 1}, {1, 1}, {2, 12}, {1023, 1025}, {5000, 5999}, {32767, 32768},
+        {0, 65534}, {1, 65535}, {49152, 65535}, {6000, 6063}, {100, 200}
+    };
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> dist(0, 65535);
+    for (int i = 0; i < 20; ++i) {
+        uint16_t a = static_cast<uint16_t>(dist(rng));
+        uint16_t b = static_cast<uint16_t>(dist(rng));
+        ranges.emplace_back(std::min(a, b), std::max(a, b));
+    }
+
+    for (const auto& r : ranges) {
+        auto prefixes = RangeEncoder::rangeToPrefixes(r.first, r.second);
+        auto srge = RangeEncoder::rangeToSrge(r.first, r.second);
+        EXPECT_LE(srge.size(), prefixes.size()) << "[" << r.first << ", " << r.second << "]";
+        expectExactCover(prefixes, r.first, r.second, PortEncoding::PREFIX);
+        expectExactCover(srge, r.first, r.second, PortEncoding::SRGE);
+    }
+}
+
+TEST(RangeEncoderTest, InvertedRangeMatchesNothing) {
+    EXPECT_TRUE(RangeEncoder::rangeToPrefixes(10, 5).empty());
+    EXPECT_TRUE(RangeEncoder::rangeToSrge(10, 5).empty());
+}
+
+TEST(RangeEncoderTest, EncodeFilterReportsExpansionFactor) {
+    PacketFilter filter;
+    filter.source_port_low = 1024;
+    filter.source_port_high = 65535;
+    filter.dest_port_low = 80;
+    filter.dest_port_high = 80;
+
+    RangeEncoder prefix_encoder(PortEncoding::PREFIX);
+    EncodedPortFilter encoded = prefix_encoder.encode(filter);
+    EXPECT_EQ(encoded.source_ports.size(), 6u);
+    EXPECT_EQ(encoded.dest_ports.size(), 1u);
+    EXPECT_EQ(encoded.expansionFactor(), 6u);
+
+    // "Any" port ranges (0-0) encode to a single wildcard.
+    PacketFilter any_filter;
+    EncodedPortFilter any_encoded = prefix_encoder.encode(any_filter);
+    EXPECT_EQ(any_encoded.expansionFactor(), 1u);
+    EXPECT_EQ(any_encoded.source_ports[0].mask, 0);
+
+    RangeEncoder srge_encoder(PortEncoding::SRGE);
+    EncodedPortFilter srge_encoded = srge_encoder.encode(filter);
+    EXPECT_LE(srge_encoded.expansionFactor(), encoded.expansionFactor());
+}
+
+TEST(RangeEncoderTest, EncodedFilterAgreesWithPacketFilterMatches) {
+    PacketFilter filter;
+    filter.source_port_low = 1000;
+    filter.source_port_high = 2000;
+    filter.dest_port_low = 443;
+    filter.dest_port_high = 8443;
+
+    RangeEncoder encoder(PortEncoding::SRGE);
+    EncodedPortFilter encoded = encoder.encode(filter);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> dist(0, 65535);
+    for (int i = 0; i < 5000; ++i) {
+        uint16_t sport = static_cast<uint16_t>(dist(rng));
+        uint16_t dport = static_cast<uint16_t>(dist(rng));
+        PacketHeader header(1, 2, sport, dport, 6);
+        EXPECT_EQ(encoded.matches(sport, dport), filter.matches(header));
+    }
+}
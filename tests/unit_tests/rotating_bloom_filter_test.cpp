@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "data_structures/rotating_bloom_filter.h"
+#include "packet_classifier.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RotatingBloomFilter::Config smallConfig() {
+    RotatingBloomFilter::Config config;
+    config.generations = 3;
+    config.slice_ms = 100;
+    config.initial_capacity = 1000;
+    config.min_capacity = 100;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(RotatingBloomFilterTest, ItemsExpireAfterAllGenerations) {
+    RotatingBloomFilter filter(smallConfig(), 0);
+    filter.insert("flow_a");
+    EXPECT_TRUE(filter.possiblyContains("flow_a"));
+    EXPECT_FALSE(filter.possiblyContains("flow_b"));
+
+    EXPECT_FALSE(filter.isRotationDue(99));
+    EXPECT_EQ(filter.advance(99), 0u);
+    EXPECT_EQ(filter.advance(100), 1u);
+    filter.insert("flow_b");
+    EXPECT_EQ(filter.advance(250), 1u);
+    EXPECT_TRUE(filter.possiblyContains("flow_a")); // Still in the oldest live generation
+    EXPECT_TRUE(filter.possiblyContains("flow_b"));
+
+    EXPECT_EQ(filter.advance(300), 1u); // flow_a's generation is retired
+    EXPECT_FALSE(filter.possiblyContains("flow_a"));
+    EXPECT_TRUE(filter.possiblyContains("flow_b"));
+
+    // A long gap clears every generation at once.
+    EXPECT_EQ(filter.advance(10000), 3u);
+    EXPECT_FALSE(filter.possiblyContains("flow_b"));
+    EXPECT_EQ(filter.getInsertCount(), 0u);
+    EXPECT_EQ(filter.getStageCount(), 0u); // Idle generations hold no memory
+}
+
+TEST(RotatingBloomFilterTest, SizesNextGenerationFromObservedInserts) {
+    RotatingBloomFilter filter(smallConfig(), 0);
+    EXPECT_EQ(filter.getCurrentCapacity(), 1000u);
+
+    for (int i = 0; i < 4000; ++i) {
+        filter.insert("flow_" + std::to_string(i));
+    }
+    filter.advance(100);
+    // ~4000 distinct items observed, times 1.5 headroom.
+    EXPECT_NEAR(static_cast<double>(filter.getCurrentCapacity()), 6000.0, 600.0);
+
+    filter.advance(200); // An idle slice shrinks the next one to the minimum
+    EXPECT_EQ(filter.getCurrentCapacity(), 100u);
+}
+
+TEST(RotatingBloomFilterTest, BurstsGrowStagesWithoutSaturating) {
+    RotatingBloomFilter filter(smallConfig(), 0);
+    const int kItems = 20000; // 20x what the first generation was sized for
+    for (int i = 0; i < kItems; ++i) {
+        filter.insert("flow_" + std::to_string(i));
+    }
+    EXPECT_GT(filter.getStageCount(), 1u);
+    EXPECT_GE(filter.getCurrentCapacity(), static_cast<uint64_t>(kItems));
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_TRUE(filter.possiblyContains("flow_" + std::to_string(i)));
+    }
+
+    int false_positives = 0;
+    for (int i = 0; i < 20000; ++i) {
+        if (filter.possiblyContains("other_" + std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+    // Stage targets tighten geometrically, so the total stays near the 1% target.
+    EXPECT_LT(false_positives, 400);
+    EXPECT_LT(filter.getEffectiveFalsePositiveProbability(), 0.02);
+}
+
+TEST(RotatingBloomFilterTest, ConcurrentInsertsGrowStagesWithoutLosingItems) {
+    RotatingBloomFilter filter(smallConfig(), 0);
+    const int kThreads = 4;
+    const int kPerThread = 5000; // 20x the first generation's capacity in total
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&filter, t]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                std::string item = "flow_" + std::to_string(t) + "_" + std::to_string(i);
+                filter.insert(item);
+                ASSERT_TRUE(filter.possiblyContains(item)); // Own inserts are visible at once
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_GT(filter.getStageCount(), 1u);
+    for (int t = 0; t < kThreads; ++t) {
+        for (int i = 0; i < kPerThread; ++i) {
+            ASSERT_TRUE(filter.possiblyContains("flow_" + std::to_string(t) + "_" + std::to_string(i)));
+        }
+    }
+    EXPECT_LT(filter.getEffectiveFalsePositiveProbability(), 0.05);
+}
+
+TEST(RotatingBloomFilterTest, ClearForgetsEverything) {
+    RotatingBloomFilter filter(smallConfig(), 0);
+    filter.insert("flow_a");
+    filter.advance(100);
+    filter.insert("flow_b");
+    filter.clear(150);
+    EXPECT_FALSE(filter.possiblyContains("flow_a"));
+    EXPECT_FALSE(filter.possiblyContains("flow_b"));
+    EXPECT_FALSE(filter.isRotationDue(249));
+    EXPECT_TRUE(filter.isRotationDue(250));
+}
+
+TEST(RotatingBloomFilterTest, ClassifierCachesMissesUntilRulesChange) {
+    PacketClassifier classifier(true);
+    RotatingBloomFilter::Config config = smallConfig();
+    config.slice_ms = 60000; // The classifier runs on the real clock: no rotation mid-test
+    classifier.enableMissCache(config);
+    ASSERT_TRUE(classifier.isMissCacheEnabled());
+
+    // SSH only from 10/8, web only from 1.2.3.0/24: a packet from 1.2.3.4 to
+    // port 22 passes every per-field pre-filter but matches no rule.
+    PacketFilter ssh;
+    ssh.dest_port_low = 22;
+    ssh.dest_port_high = 22;
+    ssh.source_ip_prefix = "10.0.0.0/8";
+    PacketFilter web;
+    web.dest_port_low = 80;
+    web.dest_port_high = 80;
+    web.source_ip_prefix = "1.2.3.0/24";
+    ActionList drop;
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, ssh, drop)));
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(3, 10, web, drop)));
+
+    PacketHeader scan(0x01020304, 0x0A000001, 40000, 22, 6);
+    EXPECT_FALSE(classifier.classify(scan).matched);
+    EXPECT_EQ(classifier.getMissCache()->getInsertCount(), 1u);
+    EXPECT_FALSE(classifier.classify(scan).matched); // Served from the miss cache
+    EXPECT_EQ(classifier.getMissCache()->getInsertCount(), 1u);
+
+    // Matches are never cached.
+    PacketHeader login(0x0A000005, 0x0A000001, 40001, 22, 6);
+    EXPECT_EQ(classifier.classify(login).matched_rule_id, 1);
+    EXPECT_EQ(classifier.getMissCache()->getInsertCount(), 1u);
+
+    // Neither are misses the pre-filter already rejected (no rule uses port 23).
+    PacketHeader telnet_scan(0x01020304, 0x0A000001, 40002, 23, 6);
+    EXPECT_FALSE(classifier.classify(telnet_scan).matched);
+    EXPECT_EQ(classifier.getMissCache()->getInsertCount(), 1u);
+
+    // A new rule that matches the cached flow clears the cache.
+    PacketFilter ssh_partner = ssh;
+    ssh_partner.source_ip_prefix = "1.2.3.0/24";
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(2, 10, ssh_partner, drop)));
+    EXPECT_EQ(classifier.getMissCache()->getInsertCount(), 0u);
+    EXPECT_EQ(classifier.classify(scan).matched_rule_id, 2);
+}
@@ -106,6 +106,22 @@ TEST_F(RuleManagerTest, AddDuplicateRuleID) {
     EXPECT_EQ(retrieved_rule->priority, 100); // Original rule should remain
 }
 
+TEST_F(RuleManagerTest, RejectsUnparseablePrefixes) {
+    // A typo must not silently turn into "any address".
+    EXPECT_FALSE(rm.addRule(createTestRule(1, 100, "10.0.0.0/33")));
+    EXPECT_FALSE(rm.addRule(createTestRule(2, 100, "", "10.0.0/8")));
+    EXPECT_FALSE(rm.addRule(createTestRule(3, 100, "not-an-ip")));
+    EXPECT_EQ(rm.getRule(1), nullptr);
+    EXPECT_EQ(rm.getRule(2), nullptr);
+    EXPECT_TRUE(rm.getAllRules().empty());
+
+    ASSERT_TRUE(rm.addRule(createTestRule(4, 100, "10.0.0.0/8", "10.1.2.3")));
+    EXPECT_FALSE(rm.modifyRule(4, createTestRule(4, 100, "10.0.0.0/8", "10.1.2.300/32")));
+    const ClassificationRule* retrieved_rule = rm.getRule(4);
+    ASSERT_NE(retrieved_rule, nullptr);
+    EXPECT_EQ(retrieved_rule->filter.dest_ip_prefix, "10.1.2.3"); // Unchanged
+}
+
 TEST_F(RuleManagerTest, GetNonExistentRule) {
     EXPECT_EQ(rm.getRule(999), nullptr);
 }
@@ -0,0 +1,206 @@
+#include "gtest/gtest.h"
+#include "data_structures/rule_prefilter.h"
+#include "packet_classifier.h"
+#include <string>
+
+namespace {
+
+PacketFilter makeFilter(const std::string& dst_prefix, uint16_t dport_low, uint16_t dport_high, uint8_t proto) {
+    PacketFilter filter;
+    filter.dest_ip_prefix = dst_prefix;
+    filter.dest_port_low = dport_low;
+    filter.dest_port_high = dport_high;
+    filter.protocol = proto;
+    return filter;
+}
+
+const uint32_t kWebServer = 0x0A000005; // 10.0.0.5
+
+} // anonymous namespace
+
+TEST(RulePrefilterTest, EmptyRejectsEverything) {
+    RulePrefilter prefilter;
+    EXPECT_EQ(prefilter.getRuleCount(), 0u);
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 2, 3, 4, 6)));
+}
+
+TEST(RulePrefilterTest, RejectsOnEachField) {
+    RulePrefilter prefilter;
+    prefilter.addRule(makeFilter("10.0.0.0/24", 443, 443, 6));
+
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(0x01020304, kWebServer, 50000, 443, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(0x01020304, 0x0A000105, 50000, 443, 6))); // Outside the /24
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(0x01020304, kWebServer, 50000, 80, 6)));   // Port
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(0x01020304, kWebServer, 50000, 443, 17)));  // Protocol
+}
+
+TEST(RulePrefilterTest, WildcardFieldsAcceptAnything) {
+    RulePrefilter prefilter;
+    prefilter.addRule(makeFilter("10.0.0.0/8", 22, 22, 6));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 0xC0A80001, 1, 22, 6)));
+
+    // A rule with no destination prefix (or "/0", or text that is not a
+    // prefix) makes the destination field unconstrained.
+    prefilter.addRule(makeFilter("0.0.0.0/0", 22, 22, 6));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0xC0A80001, 1, 22, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 0xC0A80001, 1, 23, 6)));
+
+    prefilter.addRule(makeFilter("", 0, 0, 0)); // Match-all rule
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0xC0A80001, 1, 23, 17)));
+}
+
+TEST(RulePrefilterTest, PortRanges) {
+    RulePrefilter prefilter;
+    prefilter.addRule(makeFilter("", 8000, 8010, 6));  // Narrow: expanded into the port filter
+    prefilter.addRule(makeFilter("", 20000, 30000, 6)); // Wide: checked as a range
+
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 2, 3, 8000, 6)));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 2, 3, 8010, 6)));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 2, 3, 25000, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 2, 3, 8011, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 2, 3, 30001, 6)));
+
+    ASSERT_TRUE(prefilter.removeRule(makeFilter("", 20000, 30000, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 2, 3, 25000, 6)));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 2, 3, 8005, 6)));
+}
+
+TEST(RulePrefilterTest, SeveralPrefixLengths) {
+    RulePrefilter prefilter;
+    prefilter.addRule(makeFilter("10.0.0.0/8", 0, 0, 0));
+    prefilter.addRule(makeFilter("192.168.1.0/24", 0, 0, 0));
+    prefilter.addRule(makeFilter("172.16.0.1", 0, 0, 0)); // /32
+
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0x0AFFFFFF, 1, 1, 6)));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0xC0A80180, 1, 1, 6)));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0xAC100001, 1, 1, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 0xAC100002, 1, 1, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, 0x08080808, 1, 1, 6)));
+}
+
+TEST(RulePrefilterTest, RemoveIsReferenceCounted) {
+    RulePrefilter prefilter;
+    PacketFilter web = makeFilter("10.0.0.0/24", 80, 80, 6);
+    prefilter.addRule(web);
+    prefilter.addRule(web);
+
+    ASSERT_TRUE(prefilter.removeRule(web));
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 80, 6)));
+    ASSERT_TRUE(prefilter.removeRule(web));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 80, 6)));
+    EXPECT_EQ(prefilter.getRuleCount(), 0u);
+
+    // Removing something never added changes nothing.
+    prefilter.addRule(makeFilter("10.0.0.0/24", 53, 53, 17));
+    EXPECT_FALSE(prefilter.removeRule(web));
+    EXPECT_EQ(prefilter.getRuleCount(), 1u);
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 53, 17)));
+}
+
+TEST(RulePrefilterTest, SnapshotIsUnaffectedByLaterChanges) {
+    RulePrefilter prefilter;
+    prefilter.addRule(makeFilter("10.0.0.0/24", 80, 80, 6));
+    std::shared_ptr<const CompiledPrefilter> before = prefilter.snapshot();
+
+    prefilter.addRule(makeFilter("192.168.0.0/16", 443, 443, 6));
+    ASSERT_TRUE(prefilter.removeRule(makeFilter("10.0.0.0/24", 80, 80, 6)));
+    EXPECT_TRUE(before->mayMatch(PacketHeader(1, kWebServer, 1, 80, 6)));
+    EXPECT_FALSE(before->mayMatch(PacketHeader(1, 0xC0A80001, 1, 443, 6)));
+    EXPECT_TRUE(prefilter.snapshot()->mayMatch(PacketHeader(1, 0xC0A80001, 1, 443, 6)));
+    EXPECT_FALSE(prefilter.snapshot()->mayMatch(PacketHeader(1, kWebServer, 1, 80, 6)));
+}
+
+TEST(RulePrefilterTest, BatchDefersPublishing) {
+    RulePrefilter prefilter;
+    prefilter.beginBatch();
+    for (uint16_t port = 1000; port < 1100; ++port) {
+        prefilter.addRule(makeFilter("10.0.0.0/24", port, port, 6));
+    }
+    EXPECT_EQ(prefilter.getRuleCount(), 100u);
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 1050, 6))); // Not published yet
+
+    prefilter.beginBatch(); // Nested
+    prefilter.addRule(makeFilter("", 22, 22, 6));
+    prefilter.endBatch();
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 22, 6)));
+
+    prefilter.endBatch();
+    for (uint16_t port = 1000; port < 1100; ++port) {
+        EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, port, 6)));
+    }
+    EXPECT_TRUE(prefilter.mayMatch(PacketHeader(1, 0xC0A80001, 1, 22, 6)));
+    EXPECT_FALSE(prefilter.mayMatch(PacketHeader(1, kWebServer, 1, 1050, 17)));
+}
+
+TEST(RulePrefilterTest, ClassifierKeepsPrefilterInSyncWithRules) {
+    PacketClassifier classifier(true);
+    const RulePrefilter* prefilter = classifier.getRulePrefilter();
+    ASSERT_NE(prefilter, nullptr);
+
+    PacketFilter web = makeFilter("10.0.0.0/24", 80, 80, 6);
+    PacketFilter dns = makeFilter("10.0.0.0/24", 53, 53, 17);
+    ActionList drop;
+    PacketHeader web_packet(0x01020304, kWebServer, 40000, 80, 6);
+    PacketHeader dns_packet(0x01020304, kWebServer, 40000, 53, 17);
+
+    ASSERT_TRUE(classifier.addRule(ClassificationRule(1, 10, web, drop)));
+    EXPECT_EQ(prefilter->getRuleCount(), 1u);
+    EXPECT_TRUE(prefilter->mayMatch(web_packet));
+    EXPECT_EQ(classifier.classify(web_packet).matched_rule_id, 1);
+
+    // Modify: the old filter goes out, the new one comes in.
+    ASSERT_TRUE(classifier.modifyRule(1, ClassificationRule(1, 10, dns, drop)));
+    EXPECT_EQ(prefilter->getRuleCount(), 1u);
+    EXPECT_FALSE(prefilter->mayMatch(web_packet));
+    EXPECT_TRUE(prefilter->mayMatch(dns_packet));
+    EXPECT_FALSE(classifier.classify(web_packet).matched);
+    EXPECT_EQ(classifier.classify(dns_packet).matched_rule_id, 1);
+
+    ASSERT_TRUE(classifier.deleteRule(1));
+    EXPECT_EQ(prefilter->getRuleCount(), 0u);
+    EXPECT_FALSE(classifier.classify(dns_packet).matched);
+
+    // Disabled rules are never added, so deleting one removes nothing.
+    ClassificationRule disabled(2, 5, web, drop);
+    disabled.enabled = false;
+    ASSERT_TRUE(classifier.addRule(disabled));
+    EXPECT_EQ(prefilter->getRuleCount(), 0u);
+    ASSERT_TRUE(classifier.deleteRule(2));
+    EXPECT_EQ(prefilter->getRuleCount(), 0u);
+}
+
+TEST(RulePrefilterTest, ClassifierResultsMatchWithAndWithoutPrefilter) {
+    PacketClassifier with_prefilter(true);
+    PacketClassifier without_prefilter(false);
+    EXPECT_EQ(without_prefilter.getRulePrefilter(), nullptr);
+
+    ActionList drop;
+    ClassificationRule rules[] = {
+        ClassificationRule(1, 30, makeFilter("10.0.0.0/24", 443, 443, 6), drop),
+        ClassificationRule(2, 20, makeFilter("192.168.0.0/16", 1000, 2000, 17), drop),
+        ClassificationRule(3, 10, makeFilter("172.16.0.9", 0, 0, 0), drop),
+    };
+    for (const ClassificationRule& rule : rules) {
+        ASSERT_TRUE(with_prefilter.addRule(rule));
+        ASSERT_TRUE(without_prefilter.addRule(rule));
+    }
+
+    const PacketHeader packets[] = {
+        PacketHeader(1, kWebServer, 5, 443, 6),   // Rule 1
+        PacketHeader(1, kWebServer, 5, 444, 6),   // Port misses
+        PacketHeader(1, 0xC0A80A0A, 5, 1500, 17), // Rule 2
+        PacketHeader(1, 0xC0A80A0A, 5, 1500, 6),  // Protocol misses
+        PacketHeader(1, 0xAC100009, 5, 9, 1),     // Rule 3
+        PacketHeader(1, 0x08080808, 5, 443, 6),   // Address misses every rule
+    };
+    for (const PacketHeader& packet : packets) {
+        ClassificationResult a = with_prefilter.classify(packet);
+        ClassificationResult b = without_prefilter.classify(packet);
+        EXPECT_EQ(a.matched, b.matched) << packet.toString();
+        EXPECT_EQ(a.matched_rule_id, b.matched_rule_id) << packet.toString();
+    }
+    EXPECT_EQ(with_prefilter.classify(packets[0]).matched_rule_id, 1);
+    EXPECT_EQ(with_prefilter.classify(packets[2]).matched_rule_id, 2);
+    EXPECT_EQ(with_prefilter.classify(packets[4]).matched_rule_id, 3);
+    EXPECT_FALSE(with_prefilter.classify(packets[5]).matched);
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "data_structures/sharded_hash.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// ShardedHashTable<> is the default std::string -> int instantiation.
+
+TEST(ShardedHashTableTest, ShardCountRoundsUpToPowerOfTwo) {
+    ShardedHashTable<> one(1024, 1);
+    EXPECT_EQ(one.getShardCount(), 1u);
+    ShardedHashTable<> table(1024, 10);
+    EXPECT_EQ(table.getShardCount(), 16u);
+    EXPECT_GE(table.getCapacity(), 1024u);
+}
+
+TEST(ShardedHashTableTest, BasicInsertLookupRemove) {
+    ShardedHashTable<> table(256, 4);
+    table.insert("10.0.0.1", 1);
+    table.insert("10.0.0.2", 2);
+    table.insert("10.0.0.1", 3); // Update
+
+    int value;
+    ASSERT_TRUE(table.lookup("10.0.0.1", value));
+    EXPECT_EQ(value, 3);
+    ASSERT_TRUE(table.lookup("10.0.0.2", value));
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(table.size(), 2u);
+
+    EXPECT_TRUE(table.remove("10.0.0.1"));
+    EXPECT_FALSE(table.lookup("10.0.0.1", value));
+    EXPECT_FALSE(table.remove("10.0.0.1"));
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(ShardedHashTableTest, KeysSpreadAcrossShards) {
+    // Integer keys hash to themselves; the shard selector must still spread them.
+    ShardedHashTable<uint64_t, uint64_t> table(4096, 8);
+    for (uint64_t i = 0; i < 8000; ++i) {
+        table.insert(i, i);
+    }
+    for (size_t s = 0; s < table.getShardCount(); ++s) {
+        EXPECT_GT(table.getShard(s).size(), 700u) << "Shard " << s << " underused";
+        EXPECT_LT(table.getShard(s).size(), 1300u) << "Shard " << s << " overused";
+        // Within a shard keys must still spread over the slot array.
+        EXPECT_LT(table.getShard(s).getMaxProbeDistance(), 64u);
+    }
+}
+
+TEST(ShardedHashTableTest, BatchInsertAndRemove) {
+    ShardedHashTable<uint32_t, uint32_t> table(64, 4);
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> values;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        keys.push_back(i * 7919);
+        values.push_back(i);
+    }
+    // Duplicate key later in the batch wins, as with sequential inserts.
+    keys.push_back(0);
+    values.push_back(4242);
+
+    table.insertBatch(keys.data(), values.data(), keys.size());
+    EXPECT_EQ(table.size(), 1000u);
+    uint32_t value = 0;
+    ASSERT_TRUE(table.lookup(0, value));
+    EXPECT_EQ(value, 4242u);
+    for (uint32_t i = 1; i < 1000; ++i) {
+        ASSERT_TRUE(table.lookup(i * 7919, value));
+        EXPECT_EQ(value, i);
+    }
+
+    std::vector<uint32_t> to_remove;
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        to_remove.push_back(i * 7919);
+    }
+    to_remove.push_back(123456789); // Absent
+    EXPECT_EQ(table.removeBatch(to_remove.data(), to_remove.size()), 500u);
+    EXPECT_EQ(table.size(), 500u);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(table.lookup(i * 7919, value), i % 2 == 1);
+    }
+    RcuUtils::processRcuCallbacks(); // Reclaim arrays replaced while shards grew
+}
+
+TEST(ShardedHashTableTest, ConcurrentWritersOnDisjointKeys) {
+    ShardedHashTable<uint64_t, uint64_t> table(1024, 16);
+    const int writers = 4;
+    const uint64_t per_writer = 20000;
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&table, w, per_writer]() {
+            std::vector<uint64_t> keys;
+            std::vector<uint64_t> values;
+            for (uint64_t i = 0; i < per_writer; ++i) {
+                keys.push_back((static_cast<uint64_t>(w) << 40) | i);
+                values.push_back(i);
+                if (keys.size() == 64) { // Data-plane style bursts
+                    table.insertBatch(keys.data(), values.data(), keys.size());
+                    keys.clear();
+                    values.clear();
+                }
+            }
+            table.insertBatch(keys.data(), values.data(), keys.size());
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(table.size(), writers * per_writer);
+    for (int w = 0; w < writers; ++w) {
+        for (uint64_t i = 0; i < per_writer; ++i) {
+            uint64_t value = 0;
+            ASSERT_TRUE(table.lookup((static_cast<uint64_t>(w) << 40) | i, value));
+            ASSERT_EQ(value, i);
+        }
+    }
+    RcuUtils::processRcuCallbacks();
+}
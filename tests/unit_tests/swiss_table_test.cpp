@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+#include "data_structures/swiss_table.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <random>
+
+// SwissHashTable<> is the default std::string -> int instantiation.
+
+struct __attribute__((packed)) SwissMacKey {
+    uint8_t bytes[6];
+    bool operator==(const SwissMacKey& other) const {
+        for (int i = 0; i < 6; ++i) {
+            if (bytes[i] != other.bytes[i]) return false;
+        }
+        return true;
+    }
+};
+
+static SwissMacKey makeMac(uint64_t n) {
+    SwissMacKey mac{};
+    for (int i = 0; i < 6; ++i) {
+        mac.bytes[i] = static_cast<uint8_t>(n >> (8 * i));
+    }
+    return mac;
+}
+
+TEST(SwissControlTest, GroupMatchMasks) {
+    alignas(16) int8_t ctrl[SwissControl::kGroupWidth];
+    for (size_t i = 0; i < SwissControl::kGroupWidth; ++i) {
+        ctrl[i] = SwissControl::kEmpty;
+    }
+    ctrl[0] = 5;
+    ctrl[3] = 5;
+    ctrl[7] = SwissControl::kDeleted;
+    ctrl[15] = 127;
+
+    EXPECT_EQ(SwissControl::matchTag(ctrl, 5), (1u << 0) | (1u << 3));
+    EXPECT_EQ(SwissControl::matchTag(ctrl, 127), 1u << 15);
+    EXPECT_EQ(SwissControl::matchTag(ctrl, 6), 0u);
+    EXPECT_EQ(SwissControl::matchEmpty(ctrl) & ((1u << 0) | (1u << 3) | (1u << 7) | (1u << 15)), 0u);
+    EXPECT_EQ(SwissControl::matchEmptyOrDeleted(ctrl), 0xFFFFu & ~((1u << 0) | (1u << 3) | (1u << 15)));
+}
+
+TEST(SwissHashTableTest, BasicInsertLookupRemove) {
+    SwissHashTable<> table(16);
+    int value;
+    EXPECT_FALSE(table.lookup("missing", value));
+
+    table.insert("key1", 10);
+    table.insert("key2", 20);
+    ASSERT_TRUE(table.lookup("key1", value));
+    EXPECT_EQ(value, 10);
+    ASSERT_TRUE(table.lookup("key2", value));
+    EXPECT_EQ(value, 20);
+    EXPECT_EQ(table.size(), 2u);
+
+    table.insert("key1", 11); // Update in place
+    ASSERT_TRUE(table.lookup("key1", value));
+    EXPECT_EQ(value, 11);
+    EXPECT_EQ(table.size(), 2u);
+
+    EXPECT_TRUE(table.remove("key1"));
+    EXPECT_FALSE(table.remove("key1"));
+    EXPECT_FALSE(table.lookup("key1", value));
+    ASSERT_TRUE(table.lookup("key2", value));
+    EXPECT_EQ(value, 20);
+    EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(SwissHashTableTest, CapacityRoundsUpToGroups) {
+    SwissHashTable<> tiny(1);
+    EXPECT_EQ(tiny.getCapacity(), SwissControl::kGroupWidth);
+    SwissHashTable<> odd(100);
+    EXPECT_EQ(odd.getCapacity(), 128u);
+}
+
+TEST(SwissHashTableTest, GrowsPastMaxLoadFactor) {
+    SwissHashTable<uint32_t, uint32_t> table(16);
+    for (uint32_t i = 0; i < 5000; ++i) {
+        table.insert(i, i * 3);
+    }
+    EXPECT_EQ(table.size(), 5000u);
+    EXPECT_LE(table.getLoadFactor(), (SwissHashTable<uint32_t, uint32_t>::kMaxLoadFactor));
+    for (uint32_t i = 0; i < 5000; ++i) {
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(i, value)) << i;
+        EXPECT_EQ(value, i * 3);
+    }
+    RcuUtils::processRcuCallbacks(); // Reclaim the storage replaced while growing
+}
+
+TEST(SwissHashTableTest, TombstonesDoNotGrowTable) {
+    SwissHashTable<uint32_t, uint32_t> table(64);
+    // Churn far more keys than the capacity through a small live set.
+    for (uint32_t i = 0; i < 10000; ++i) {
+        table.insert(i, i);
+        if (i >= 8) {
+            ASSERT_TRUE(table.remove(i - 8));
+        }
+    }
+    EXPECT_EQ(table.size(), 8u);
+    EXPECT_EQ(table.getCapacity(), 64u);
+    for (uint32_t i = 10000 - 8; i < 10000; ++i) {
+        uint32_t value = 0;
+        ASSERT_TRUE(table.lookup(i, value));
+        EXPECT_EQ(value, i);
+    }
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(SwissHashTableTest, MacKeysWithFnvHash) {
+    SwissHashTable<SwissMacKey, uint16_t> table(256);
+    for (uint64_t i = 0; i < 200; ++i) {
+        table.insert(makeMac(0x0050560000ULL + i), static_cast<uint16_t>(i));
+    }
+    for (uint64_t i = 0; i < 200; ++i) {
+        uint16_t port = 0;
+        ASSERT_TRUE(table.lookup(makeMac(0x0050560000ULL + i), port));
+        EXPECT_EQ(port, i);
+    }
+    uint16_t port = 0;
+    EXPECT_FALSE(table.lookup(makeMac(0xFFFFFFFFFFFFULL), port));
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(SwissHashTableTest, RandomOperationsMatchReference) {
+    SwissHashTable<uint64_t, uint64_t> table(32);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64 rng(2024);
+    std::uniform_int_distribution<uint64_t> key_dist(0, 2000);
+
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t key = key_dist(rng);
+        switch (rng() % 3) {
+        case 0:
+            table.insert(key, static_cast<uint64_t>(i));
+            reference[key] = static_cast<uint64_t>(i);
+            break;
+        case 1:
+            EXPECT_EQ(table.remove(key), reference.erase(key) == 1);
+            break;
+        default: {
+            uint64_t value = 0;
+            auto it = reference.find(key);
+            ASSERT_EQ(table.lookup(key, value), it != reference.end());
+            if (it != reference.end()) {
+                EXPECT_EQ(value, it->second);
+            }
+        }
+        }
+    }
+    EXPECT_EQ(table.size(), reference.size());
+    RcuUtils::processRcuCallbacks();
+}
+
+TEST(SwissHashTableTest, ConcurrentReadersSeeStableKeys) {
+    SwissHashTable<uint32_t, uint32_t> table(64);
+    const uint32_t kStable = 32;
+    for (uint32_t i = 0; i < kStable; ++i) {
+        table.insert(i, i + 1000);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (uint32_t i = 0; i < kStable; ++i) {
+                    uint32_t value = 0;
+                    if (!table.lookup(i, value) || value != i + 1000) {
+                        failures.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    // Writer churns other keys, forcing tombstones and growth under the readers.
+    for (uint32_t i = 0; i < 20000; ++i) {
+        table.insert(100000 + i, i);
+        if (i % 2 == 0) {
+            table.remove(100000 + i);
+        }
+    }
+    stop.store(true);
+    for (auto& t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(failures.load(), 0);
+    RcuUtils::processRcuCallbacks();
+}
@@ -6,6 +6,9 @@
 #include <chrono>
 #include <functional> // For std::bind
 #include <set> // For checking unique thread IDs
+#include <algorithm> // For std::max
+#include <future>
+#include <stdexcept>
 
 // --- ReadWriteLock Tests ---
 TEST(ReadWriteLockTest, SingleThreadWriteLock) {
@@ -225,10 +228,224 @@ TEST(SimpleThreadPoolTest, StopPool) {
 }
 
 
-// --- RCU Utils (Simplified) Tests ---
+// --- WorkStealingThreadPool Tests ---
+TEST(WorkStealingThreadPoolTest, SubmitReturnsFutureValue) {
+    RcuUtils::WorkStealingThreadPool pool(2);
+    std::future<int> result = pool.submit([]() { return 6 * 7; });
+    EXPECT_EQ(result.get(), 42);
+}
+
+TEST(WorkStealingThreadPoolTest, SubmitPropagatesException) {
+    RcuUtils::WorkStealingThreadPool pool(2);
+    std::future<int> result = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(WorkStealingThreadPoolTest, SubmitAfterStopBreaksPromise) {
+    RcuUtils::WorkStealingThreadPool pool(1);
+    pool.stop();
+    std::future<int> result = pool.submit([]() { return 1; });
+    EXPECT_THROW(result.get(), std::future_error);
+}
+
+TEST(WorkStealingThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+    RcuUtils::WorkStealingThreadPool pool(4);
+    const size_t count = 100000;
+    std::vector<std::atomic<int>> hits(count);
+    pool.parallelFor(0, count, [&](size_t i) { hits[i].fetch_add(1, std::memory_order_relaxed); });
+    size_t wrong = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (hits[i].load() != 1) wrong++;
+    }
+    EXPECT_EQ(wrong, 0u);
+
+    pool.parallelFor(5, 5, [&](size_t) { FAIL() << "Empty range must not run the body"; });
+}
+
+TEST(WorkStealingThreadPoolTest, ParallelForRethrowsBodyException) {
+    RcuUtils::WorkStealingThreadPool pool(3);
+    std::atomic<int> ran(0);
+    EXPECT_THROW(pool.parallelFor(0, 1000, [&](size_t i) {
+                     ran++;
+                     if (i == 500) throw std::runtime_error("bad index");
+                 }, 16),
+                 std::runtime_error);
+    EXPECT_EQ(ran.load(), 1000); // The remaining indices still ran
+}
+
+TEST(WorkStealingThreadPoolTest, NestedParallelForInsideTasks) {
+    // Tasks that fan out again must not deadlock, even with more outer tasks
+    // than workers: a waiting worker helps run queued work.
+    RcuUtils::WorkStealingThreadPool pool(2);
+    std::atomic<size_t> total(0);
+    std::vector<std::future<void>> outer;
+    for (int t = 0; t < 8; ++t) {
+        outer.push_back(pool.submit([&]() {
+            EXPECT_GE(pool.currentWorkerIndex(), 0);
+            pool.parallelFor(0, 1000, [&](size_t) { total.fetch_add(1, std::memory_order_relaxed); }, 10);
+        }));
+    }
+    for (auto& f : outer) f.get();
+    EXPECT_EQ(total.load(), 8000u);
+    EXPECT_EQ(pool.currentWorkerIndex(), -1); // Not a worker of this pool
+}
+
+TEST(WorkStealingThreadPoolTest, WorkSpawnedByOneWorkerIsStolen) {
+    const size_t num_threads = 4;
+    RcuUtils::WorkStealingThreadPool pool(num_threads);
+    std::mutex id_mutex;
+    std::set<std::thread::id> thread_ids;
+    // A single task pushes all children onto its own deque; other workers can
+    // only get them by stealing.
+    pool.submit([&]() {
+            std::vector<std::future<void>> children;
+            for (int i = 0; i < 32; ++i) {
+                children.push_back(pool.submit([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    std::lock_guard<std::mutex> lock(id_mutex);
+                    thread_ids.insert(std::this_thread::get_id());
+                }));
+            }
+            for (auto& child : children) {
+                child.wait();
+            }
+        }).get();
+    EXPECT_GT(thread_ids.size(), 1u);
+    EXPECT_LE(thread_ids.size(), num_threads);
+}
+
+TEST(WorkStealingThreadPoolTest, StopDrainsManyTasks) {
+    RcuUtils::WorkStealingThreadPool pool(4);
+    std::atomic<int> counter(0);
+    for (int i = 0; i < 5000; ++i) {
+        pool.enqueue([&, i]() {
+            counter++;
+            // Half the tasks spawn a follow-up, which must also run before stop() returns.
+            if (i % 2 == 0) {
+                pool.enqueue([&]() { counter++; });
+            }
+        });
+    }
+    pool.stop();
+    EXPECT_EQ(counter.load(), 7500);
+}
+
+// --- SeqLock Tests ---
+TEST(SeqLockTest, SequenceIsEvenOutsideWrites) {
+    SeqLock seq;
+    uint64_t start = seq.readBegin();
+    EXPECT_EQ(start % 2, 0u);
+    EXPECT_FALSE(seq.readRetry(start));
+    {
+        SeqLockWriteGuard guard(seq);
+        EXPECT_EQ(seq.getSequence() % 2, 1u);
+    }
+    EXPECT_TRUE(seq.readRetry(start)); // A write happened since readBegin
+    EXPECT_EQ(seq.getSequence(), start + 2);
+}
+
+TEST(SeqLockTest, ReadersNeverObserveTornPairs) {
+    SeqLock seq;
+    uint64_t a = 0, b = 0; // Invariant: a == b outside writes
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0);
+
+    std::thread reader([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            uint64_t ra, rb, start;
+            do {
+                start = seq.readBegin();
+                ra = *static_cast<volatile uint64_t*>(&a);
+                rb = *static_cast<volatile uint64_t*>(&b);
+            } while (seq.readRetry(start));
+            if (ra != rb) torn++;
+        }
+    });
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        SeqLockWriteGuard guard(seq);
+        *static_cast<volatile uint64_t*>(&a) = i;
+        *static_cast<volatile uint64_t*>(&b) = i;
+    }
+    stop = true;
+    reader.join();
+    EXPECT_EQ(torn.load(), 0);
+}
+
+// --- BigReaderLock Tests ---
+TEST(BigReaderLockTest, SlotCountIsPowerOfTwo) {
+    EXPECT_EQ(BigReaderLock(1).getReaderSlotCount(), 1u);
+    EXPECT_EQ(BigReaderLock(6).getReaderSlotCount(), 8u);
+    EXPECT_EQ(BigReaderLock(1000).getReaderSlotCount(), BigReaderLock::kMaxReaderSlots);
+    size_t automatic = BigReaderLock().getReaderSlotCount();
+    EXPECT_GE(automatic, 1u);
+    EXPECT_EQ(automatic & (automatic - 1), 0u);
+}
+
+TEST(BigReaderLockTest, ReadersShareTheLock) {
+    BigReaderLock lock(4);
+    std::atomic<int> inside(0);
+    std::atomic<int> max_inside(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            BigReaderReadGuard guard(lock);
+            int now = ++inside;
+            int seen = max_inside.load();
+            while (now > seen && !max_inside.compare_exchange_weak(seen, now)) {
+            }
+            // Hold the lock until every reader is in, or give up after a while.
+            for (int i = 0; i < 2000 && max_inside.load() < 4; ++i) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            --inside;
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(max_inside.load(), 4);
+}
+
+TEST(BigReaderLockTest, WritersExcludeReadersAndEachOther) {
+    BigReaderLock lock(2); // Fewer slots than threads: slots are shared
+    uint64_t a = 0;
+    uint64_t b = 0;
+    std::atomic<bool> stop(false);
+    std::atomic<int> torn(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            while (!stop) {
+                BigReaderReadGuard guard(lock);
+                if (a != b) torn++;
+            }
+        });
+    }
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 5000; ++i) {
+                BigReaderWriteGuard guard(lock);
+                ++a;
+                ++b;
+            }
+        });
+    }
+    for (size_t i = 4; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    stop = true;
+    for (size_t i = 0; i < 4; ++i) {
+        threads[i].join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(a, 10000u);
+    EXPECT_EQ(b, 10000u);
+}
+
+
+// --- RCU Utils Tests ---
 TEST(RcuUtilsTest, CallRcuAndProcessCallbacks) {
     // RCU utils are global / static within namespace, so state persists.
-    // This test is very basic due to simplified RCU.
     std::atomic<int> callback_count(0);
     
     RcuUtils::callRcu([&]() {
@@ -238,7 +455,8 @@ TEST(RcuUtilsTest, CallRcuAndProcessCallbacks) {
         callback_count++;
     });
 
-    // In this simplified RCU, synchronizeRcu also processes callbacks.
+    // synchronizeRcu also runs the callbacks queued before its grace period
+    // (unless the background reclaimer got to them first).
     RcuUtils::synchronizeRcu(); 
     EXPECT_EQ(callback_count.load(), 2);
 
@@ -258,7 +476,400 @@ TEST(RcuUtilsTest, SynchronizeRcuEpochIncrement) {
     uint64_t epoch_before = RcuUtils::rcu_global_epoch.load();
     RcuUtils::synchronizeRcu();
     uint64_t epoch_after = RcuUtils::rcu_global_epoch.load();
-    EXPECT_EQ(epoch_after, epoch_before + 1);
+    // At least one grace period; the background reclaimer may have run others.
+    EXPECT_GT(epoch_after, epoch_before);
+}
+
+TEST(RcuUtilsTest, SynchronizeWaitsForPreexistingReader) {
+    std::atomic<bool> in_section(false);
+    std::atomic<bool> reader_done(false);
+    std::thread reader([&]() {
+        RcuUtils::rcuReadLock();
+        in_section = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reader_done = true;
+        RcuUtils::rcuReadUnlock();
+    });
+    while (!in_section) {
+        std::this_thread::yield();
+    }
+    RcuUtils::synchronizeRcu();
+    EXPECT_TRUE(reader_done.load());
+    reader.join();
+}
+
+TEST(RcuUtilsTest, CallbackDeferredUntilReadersLeave) {
+    std::atomic<bool> in_section(false);
+    std::atomic<bool> release_reader(false);
+    std::atomic<bool> reclaimed(false);
+    std::thread reader([&]() {
+        RcuUtils::rcuReadLock();
+        RcuUtils::rcuReadLock(); // Nested sections end with the outermost unlock
+        in_section = true;
+        RcuUtils::rcuReadUnlock();
+        while (!release_reader) {
+            std::this_thread::yield();
+        }
+        RcuUtils::rcuReadUnlock();
+    });
+    while (!in_section) {
+        std::this_thread::yield();
+    }
+    RcuUtils::callRcu([&]() { reclaimed = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30)); // Background reclaimer is waiting on the reader
+    EXPECT_FALSE(reclaimed.load());
+
+    release_reader = true;
+    RcuUtils::processRcuCallbacks();
+    EXPECT_TRUE(reclaimed.load());
+    reader.join();
+}
+
+TEST(RcuUtilsTest, BackgroundReclaimerRunsCallbacks) {
+    std::atomic<bool> reclaimed(false);
+    RcuUtils::callRcu([&]() { reclaimed = true; });
+    for (int i = 0; i < 1000 && !reclaimed; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(reclaimed.load());
+}
+
+TEST(RcuUtilsTest, ReadersRegisterOnFirstUseAndUnregisterAtExit) {
+    size_t before = RcuUtils::getRegisteredReaderCount();
+    std::atomic<bool> registered(false);
+    std::atomic<bool> finish(false);
+    std::thread reader([&]() {
+        RcuUtils::rcuReadLock();
+        RcuUtils::rcuReadUnlock();
+        registered = true;
+        while (!finish) {
+            std::this_thread::yield();
+        }
+    });
+    while (!registered) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(RcuUtils::getRegisteredReaderCount(), before + 1);
+    finish = true;
+    reader.join();
+    EXPECT_EQ(RcuUtils::getRegisteredReaderCount(), before);
+}
+
+TEST(RcuUtilsTest, ReaderNeverSeesReclaimedData) {
+    // Writers replace a published value and retire the old one with callRcu;
+    // the callback poisons it before freeing, so a reader that could observe
+    // a reclaimed object would see the poison.
+    struct Versioned {
+        std::atomic<uint64_t> value;
+        explicit Versioned(uint64_t v) : value(v) {}
+    };
+    std::atomic<Versioned*> published(new Versioned(1));
+    std::atomic<bool> stop(false);
+    std::atomic<int> poisoned_reads(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                RcuUtils::rcuReadLock();
+                Versioned* v = published.load(std::memory_order_acquire);
+                for (int i = 0; i < 10; ++i) {
+                    if (v->value.load(std::memory_order_relaxed) == 0) {
+                        poisoned_reads++;
+                    }
+                }
+                RcuUtils::rcuReadUnlock();
+            }
+        });
+    }
+    for (uint64_t i = 2; i < 2000; ++i) {
+        Versioned* old = published.exchange(new Versioned(i), std::memory_order_acq_rel);
+        RcuUtils::callRcu([old]() {
+            old->value.store(0, std::memory_order_relaxed);
+            delete old;
+        });
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    RcuUtils::processRcuCallbacks();
+    delete published.load();
+    EXPECT_EQ(poisoned_reads.load(), 0);
+}
+
+
+// --- QSBR flavour ---
+TEST(RcuQsbrTest, GracePeriodWaitsForQuiescentState) {
+    std::atomic<bool> online(false);
+    std::atomic<bool> report(false);
+    std::atomic<bool> reported(false);
+    std::thread worker([&]() {
+        RcuUtils::rcuQsbrRegisterThread();
+        online = true;
+        while (!report) {
+            std::this_thread::yield(); // "Processing a burst": no quiescent state yet
+        }
+        reported = true;
+        RcuUtils::rcuQuiescentState();
+        RcuUtils::rcuQsbrUnregisterThread();
+    });
+    while (!online) {
+        std::this_thread::yield();
+    }
+    std::thread reporter([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        report = true;
+    });
+    RcuUtils::synchronizeRcu();
+    EXPECT_TRUE(reported.load());
+    worker.join();
+    reporter.join();
+}
+
+TEST(RcuQsbrTest, OfflineThreadDoesNotBlockGracePeriods) {
+    std::atomic<bool> offline(false);
+    std::atomic<bool> finish(false);
+    std::thread worker([&]() {
+        RcuUtils::rcuQsbrRegisterThread();
+        RcuUtils::rcuThreadOffline();
+        offline = true;
+        while (!finish) {
+            std::this_thread::yield(); // Stands in for a blocking wait
+        }
+        RcuUtils::rcuThreadOnline();
+        RcuUtils::rcuQsbrUnregisterThread();
+    });
+    while (!offline) {
+        std::this_thread::yield();
+    }
+    RcuUtils::synchronizeRcu(); // Would hang if the offline thread were waited for
+    finish = true;
+    worker.join();
+}
+
+TEST(RcuQsbrTest, OnlineThreadCanSynchronizeWhileReclaimerRuns) {
+    // The background reclaimer's grace period waits for this thread while
+    // the thread waits for the reclaimer inside synchronizeRcu().
+    std::atomic<bool> stop(false);
+    std::atomic<int> rounds(0);
+    std::thread worker([&]() {
+        RcuUtils::rcuQsbrRegisterThread();
+        while (!stop) {
+            RcuUtils::rcuQuiescentState();
+            std::this_thread::sleep_for(std::chrono::microseconds(300)); // Work between quiescent states
+            RcuUtils::synchronizeRcu();
+            RcuUtils::processRcuCallbacks();
+            rounds++;
+        }
+        RcuUtils::rcuQsbrUnregisterThread();
+    });
+    std::atomic<int> reclaimed(0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < deadline) {
+        RcuUtils::callRcu([&reclaimed]() { reclaimed++; });
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    stop = true;
+    worker.join();
+    RcuUtils::processRcuCallbacks();
+    EXPECT_GT(rounds.load(), 0);
+    EXPECT_GT(reclaimed.load(), 0);
+}
+
+TEST(RcuQsbrTest, ThreadExitingOnlineDoesNotBlockGracePeriods) {
+    std::atomic<bool> online(false);
+    std::thread worker([&]() {
+        RcuUtils::rcuQsbrRegisterThread();
+        online = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        // Returns without unregistering while synchronizeRcu() waits for it.
+    });
+    while (!online) {
+        std::this_thread::yield();
+    }
+    RcuUtils::synchronizeRcu();
+    worker.join();
+}
+
+TEST(RcuQsbrTest, ReadLockIsNoOpOnQsbrThread) {
+    std::thread worker([]() {
+        RcuUtils::rcuQsbrRegisterThread();
+        RcuUtils::rcuReadLock();
+        EXPECT_EQ(RcuUtils::rcu_read_nesting, 0u);
+        RcuUtils::rcuReadUnlock();
+        // The thread stays online: its slot still holds an epoch, not 0.
+        EXPECT_NE(RcuUtils::rcu_reader_slot->epoch.load(), 0u);
+        RcuUtils::rcuQsbrUnregisterThread();
+        EXPECT_EQ(RcuUtils::rcu_reader_slot->epoch.load(), 0u);
+    });
+    worker.join();
+}
+
+TEST(RcuQsbrTest, WorkersNeverSeeReclaimedData) {
+    struct Versioned {
+        std::atomic<uint64_t> value;
+        explicit Versioned(uint64_t v) : value(v) {}
+    };
+    std::atomic<Versioned*> published(new Versioned(1));
+    std::atomic<bool> stop(false);
+    std::atomic<int> poisoned_reads(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 3; ++t) {
+        workers.emplace_back([&]() {
+            RcuUtils::rcuQsbrRegisterThread();
+            while (!stop) {
+                // One burst: several reads, then a quiescent state.
+                for (int i = 0; i < 10; ++i) {
+                    Versioned* v = published.load(std::memory_order_acquire);
+                    if (v->value.load(std::memory_order_relaxed) == 0) {
+                        poisoned_reads++;
+                    }
+                }
+                RcuUtils::rcuQuiescentState();
+            }
+            RcuUtils::rcuQsbrUnregisterThread();
+        });
+    }
+    for (uint64_t i = 2; i < 2000; ++i) {
+        Versioned* old = published.exchange(new Versioned(i), std::memory_order_acq_rel);
+        RcuUtils::callRcu([old]() {
+            old->value.store(0, std::memory_order_relaxed);
+            delete old;
+        });
+    }
+    RcuUtils::synchronizeRcu();
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    RcuUtils::processRcuCallbacks();
+    delete published.load();
+    EXPECT_EQ(poisoned_reads.load(), 0);
+}
+
+
+// --- Hazard pointers ---
+namespace {
+struct HazardNode {
+    std::atomic<uint64_t> value;
+    std::atomic<int>* destroyed;
+    HazardNode(uint64_t v, std::atomic<int>* counter) : value(v), destroyed(counter) {}
+    ~HazardNode() {
+        value.store(0, std::memory_order_relaxed); // Poison for readers that should not be here
+        if (destroyed) (*destroyed)++;
+    }
+};
+} // namespace
+
+TEST(HazardPointerTest, ProtectedNodeSurvivesScan) {
+    HazardPointerDomain domain;
+    std::atomic<int> destroyed(0);
+    std::atomic<HazardNode*> head(new HazardNode(1, &destroyed));
+
+    HazardNode* seen = domain.protect(0, head);
+    HazardNode* old = head.exchange(new HazardNode(2, &destroyed));
+    ASSERT_EQ(seen, old);
+    domain.retire(old);
+    EXPECT_EQ(domain.scan(), 0u);
+    EXPECT_EQ(seen->value.load(), 1u);
+    EXPECT_EQ(domain.getRetiredCount(), 1u);
+
+    domain.clear(0);
+    EXPECT_EQ(domain.scan(), 1u);
+    EXPECT_EQ(destroyed.load(), 1);
+    EXPECT_EQ(domain.getRetiredCount(), 0u);
+    delete head.load();
+}
+
+TEST(HazardPointerTest, RetireScansAtThreshold) {
+    HazardPointerDomain domain;
+    std::atomic<int> destroyed(0);
+    for (size_t i = 0; i + 1 < HazardPointerDomain::kMinScanThreshold; ++i) {
+        domain.retire(new HazardNode(i + 1, &destroyed));
+    }
+    EXPECT_EQ(destroyed.load(), 0); // Below the threshold nothing is scanned yet
+    domain.retire(new HazardNode(99, &destroyed));
+    EXPECT_EQ(destroyed.load(), static_cast<int>(HazardPointerDomain::kMinScanThreshold));
+    EXPECT_EQ(domain.getRetiredCount(), 0u);
+}
+
+TEST(HazardPointerTest, RetireToPoolRecyclesNodes) {
+    HazardPointerDomain domain;
+    TypedMemoryPool<HazardNode> pool(8);
+    std::atomic<int> destroyed(0);
+    HazardNode* node = new (pool.allocateTyped()) HazardNode(7, &destroyed);
+    EXPECT_EQ(pool.getUsedCount(), 1u);
+
+    domain.retireToPool(node, pool);
+    EXPECT_EQ(pool.getUsedCount(), 1u); // Deferred until a scan
+    domain.scan();
+    EXPECT_EQ(destroyed.load(), 1);
+    EXPECT_EQ(pool.getUsedCount(), 0u);
+
+    // The freed slot is handed out again.
+    HazardNode* reused = new (pool.allocateTyped()) HazardNode(8, &destroyed);
+    EXPECT_EQ(static_cast<void*>(reused), static_cast<void*>(node));
+    reused->~HazardNode();
+    pool.deallocateTyped(reused);
+}
+
+TEST(HazardPointerTest, ExitedThreadsHandOverRetiredNodes) {
+    HazardPointerDomain domain;
+    std::atomic<int> destroyed(0);
+    std::thread worker([&]() {
+        domain.retire(new HazardNode(1, &destroyed)); // Below the threshold: left behind
+    });
+    worker.join();
+    EXPECT_EQ(domain.getThreadRecordCount(), 1u);
+    EXPECT_EQ(destroyed.load(), 0);
+
+    std::thread next([&]() {
+        EXPECT_EQ(domain.scan(), 1u); // Adopts the orphan
+    });
+    next.join();
+    EXPECT_EQ(destroyed.load(), 1);
+    EXPECT_EQ(domain.getThreadRecordCount(), 1u); // The released record was reused
+}
+
+TEST(HazardPointerTest, DomainDestructorReclaimsEverything) {
+    std::atomic<int> destroyed(0);
+    {
+        HazardPointerDomain domain;
+        domain.retire(new HazardNode(1, &destroyed));
+        domain.retire(new HazardNode(2, &destroyed));
+    }
+    EXPECT_EQ(destroyed.load(), 2);
+}
+
+TEST(HazardPointerTest, ReadersNeverSeeReclaimedNodes) {
+    HazardPointerDomain domain;
+    std::atomic<HazardNode*> head(new HazardNode(1, nullptr));
+    std::atomic<bool> stop(false);
+    std::atomic<int> poisoned_reads(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                HazardNode* node = domain.protect(0, head);
+                if (node->value.load(std::memory_order_relaxed) == 0) {
+                    poisoned_reads++;
+                }
+                domain.clear(0);
+            }
+        });
+    }
+    for (uint64_t i = 2; i < 20000; ++i) {
+        domain.retire(head.exchange(new HazardNode(i, nullptr)));
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    // Bounded footprint: at most one threshold's worth is ever pending.
+    EXPECT_LE(domain.getRetiredCount(), std::max(HazardPointerDomain::kMinScanThreshold,
+                                                 2 * HazardPointerDomain::kSlotsPerThread * domain.getThreadRecordCount()));
+    EXPECT_EQ(poisoned_reads.load(), 0);
+    delete head.load();
 }
 
 
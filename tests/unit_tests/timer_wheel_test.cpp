@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "utils/timer_wheel.h"
+#include <vector>
+#include <random>
+#include <cstdint>
+
+using Wheel = TimerWheel<int>;
+
+namespace {
+// Advances one tick at a time and checks every timer fires exactly on its tick.
+void expectExactFiring(Wheel& wheel, uint64_t until) {
+    std::vector<Wheel::Timer> expired;
+    while (wheel.getCurrentTick() < until) {
+        expired.clear();
+        wheel.advance(wheel.getCurrentTick() + 1, expired);
+        for (const auto& timer : expired) {
+            EXPECT_EQ(timer.expiry_tick, wheel.getCurrentTick()) << "payload " << timer.payload;
+        }
+    }
+}
+} // namespace
+
+TEST(TimerWheelTest, FiresAtExpiryTick) {
+    Wheel wheel;
+    EXPECT_EQ(wheel.schedule(1, 5), 5u);
+    EXPECT_EQ(wheel.pending(), 1u);
+
+    std::vector<Wheel::Timer> expired;
+    wheel.advance(4, expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.advance(5, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 1);
+    EXPECT_EQ(expired[0].expiry_tick, 5u);
+    EXPECT_EQ(wheel.pending(), 0u);
+}
+
+TEST(TimerWheelTest, PastExpiryFiresOnNextTick) {
+    Wheel wheel(100);
+    EXPECT_EQ(wheel.schedule(7, 50), 101u);
+    std::vector<Wheel::Timer> expired;
+    wheel.advance(101, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 7);
+}
+
+TEST(TimerWheelTest, CascadesAcrossLevels) {
+    Wheel wheel;
+    // One timer per level: inside level 0, level 1, level 2 and level 3 spans.
+    wheel.schedule(0, 200);
+    wheel.schedule(1, 300);
+    wheel.schedule(2, 70000);
+    wheel.schedule(3, 20000000);
+    EXPECT_EQ(wheel.pending(), 4u);
+
+    std::vector<Wheel::Timer> expired;
+    wheel.advance(299, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 0);
+
+    expired.clear();
+    wheel.advance(300, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 1);
+
+    expired.clear();
+    wheel.advance(69999, expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.advance(70000, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 2);
+
+    expired.clear();
+    wheel.advance(20000000, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].payload, 3);
+    EXPECT_EQ(expired[0].expiry_tick, 20000000u);
+    EXPECT_EQ(wheel.pending(), 0u);
+}
+
+TEST(TimerWheelTest, ClampsToHorizon) {
+    Wheel wheel;
+    uint64_t horizon = (uint64_t{1} << 32) - 1;
+    EXPECT_EQ(wheel.schedule(1, uint64_t{1} << 40), horizon);
+}
+
+TEST(TimerWheelTest, SkipsAheadWhenIdle) {
+    Wheel wheel;
+    std::vector<Wheel::Timer> expired;
+    wheel.advance(uint64_t{1} << 36, expired);
+    EXPECT_EQ(wheel.getCurrentTick(), uint64_t{1} << 36);
+    EXPECT_TRUE(expired.empty());
+
+    // Scheduling relative to the new position still fires on time.
+    wheel.schedule(1, wheel.getCurrentTick() + 1000);
+    wheel.advance(wheel.getCurrentTick() + 1000, expired);
+    EXPECT_EQ(expired.size(), 1u);
+}
+
+TEST(TimerWheelTest, RandomTimersFireExactlyOnce) {
+    Wheel wheel(12345); // Unaligned start exercises partial level rotations
+    std::mt19937_64 rng(42);
+    const int kTimers = 2000;
+    for (int i = 0; i < kTimers; ++i) {
+        uint64_t delay = 1 + rng() % 100000;
+        wheel.schedule(i, wheel.getCurrentTick() + delay);
+    }
+    // Also schedule some while the wheel is moving.
+    std::vector<Wheel::Timer> expired;
+    size_t fired = 0;
+    for (int step = 0; step < 50; ++step) {
+        expired.clear();
+        wheel.advance(wheel.getCurrentTick() + 100, expired);
+        fired += expired.size();
+        wheel.schedule(kTimers + step, wheel.getCurrentTick() + 1 + rng() % 5000);
+    }
+    EXPECT_EQ(fired + wheel.pending(), static_cast<size_t>(kTimers + 50));
+    expectExactFiring(wheel, wheel.getCurrentTick() + 110000);
+    EXPECT_EQ(wheel.pending(), 0u);
+}